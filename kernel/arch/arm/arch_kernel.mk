@@ -12,6 +12,7 @@ KERNEL_SRCFILES += \
 	kernel/arch/${ARCH}/drivers/pl180.c \
 	kernel/arch/${ARCH}/drivers/lan9118.c \
 	kernel/arch/${ARCH}/drivers/gic.c \
+	kernel/arch/${ARCH}/drivers/gtimer.c \
 	kernel/arch/${ARCH}/drivers/ptimer.c \
 	kernel/arch/${ARCH}/drivers/sp804.c \
 	kernel/arch/${ARCH}/mach/realview/realview.c \
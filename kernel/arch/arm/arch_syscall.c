@@ -8,7 +8,7 @@ sys_arch_get_num(void)
 {
   struct Process *current = process_current();
 
-  int *pc = (int *) (current->thread->tf->pc - 4);
+  int *pc = (int *) (thread_current()->tf->pc - 4);
   int r;
 
   if ((r = vm_user_check_buf(current->vm->pgtab, (uintptr_t) pc, sizeof(int), VM_READ)) < 0)
@@ -17,26 +17,26 @@ sys_arch_get_num(void)
   return *pc & 0xFFFFFF;
 }
 
-// Get the n-th argument from the current process' trap frame.
+// Get the n-th argument from the current thread's trap frame.
 // Support up to 6 system call arguments
 int32_t
 sys_arch_get_arg(int n)
 {
-  struct Process *current = process_current();
+  struct Thread *current = thread_current();
 
   switch (n) {
   case 0:
-    return current->thread->tf->r0;
+    return current->tf->r0;
   case 1:
-    return current->thread->tf->r1;
+    return current->tf->r1;
   case 2:
-    return current->thread->tf->r2;
+    return current->tf->r2;
   case 3:
-    return current->thread->tf->r3;
+    return current->tf->r3;
   case 4:
-    return current->thread->tf->r4;
+    return current->tf->r4;
   case 5:
-    return current->thread->tf->r5;
+    return current->tf->r5;
   default:
     k_panic("Invalid argument number: %d", n);
     return 0;
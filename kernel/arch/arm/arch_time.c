@@ -1,5 +1,8 @@
 #include <arch/arm/mach.h>
+#include <kernel/interrupt.h>
 #include <kernel/time.h>
+#include <kernel/core/tick.h>
+#include <kernel/hrtimer.h>
 
 void
 arch_time_init(void)
@@ -12,3 +15,37 @@ arch_get_time_seconds(void)
 {
   return mach_current->rtc_get_time();
 }
+
+int
+k_arch_tick_oneshot(k_tick_t ticks)
+{
+  if (mach_current->timer_oneshot == NULL)
+    return K_ERR_INVAL;
+
+  mach_current->timer_oneshot(ticks);
+  return 0;
+}
+
+k_tick_t
+k_arch_tick_periodic(void)
+{
+  return mach_current->timer_periodic();
+}
+
+void
+k_arch_tick_kick(void)
+{
+  arch_interrupt_ipi();
+}
+
+uint64_t
+arch_hrtimer_now(void)
+{
+  return mach_current->hrtimer_now();
+}
+
+void
+arch_hrtimer_program(uint64_t expires)
+{
+  mach_current->hrtimer_program(expires);
+}
@@ -54,7 +54,7 @@ trap(struct TrapFrame *tf)
   case T_UNDEF:
     if ((tf->psr & PSR_M_MASK) == PSR_M_USR) {
       // TODO: ILL_ILLOPC
-      if (signal_generate(my_process->pid, SIGILL, 0) != 0)
+      if (signal_generate_thread(thread_current(), SIGILL, 0) != 0)
         k_panic("sending SIGILL failed");
       break;
     }
@@ -105,7 +105,7 @@ trap_handle_abort(struct TrapFrame *tf)
   k_panic("[%d %s]: user fault va %p status %#x\n", process->pid, process->name, address, status);
 
   // TODO: SEGV_MAPERR or SEGV_ACCERR
-  if (signal_generate(process->pid, SIGSEGV, 0) != 0)
+  if (signal_generate_thread(thread_current(), SIGSEGV, 0) != 0)
     k_panic("sending SIGSEGV failed");
 }
 
@@ -169,19 +169,21 @@ print_trapframe(struct TrapFrame *tf)
 int
 ipi_irq(int, void *)
 {
+  // Nothing to do: the IPI brings the CPU out of idle, and a pending reschedule
+  // request is handled by k_irq_handler_end()
   return 1;
 }
 
 int 
-arch_trap_frame_init(struct Process *process, uintptr_t entry, uintptr_t arg1,
+arch_trap_frame_init(struct Thread *thread, uintptr_t entry, uintptr_t arg1,
                      uintptr_t arg2, uintptr_t arg3, uintptr_t sp)
 {
-  process->thread->tf->r0  = arg1;              // argc
-  process->thread->tf->r1  = arg2;              // argv
-  process->thread->tf->r2  = arg3;              // environ
-  process->thread->tf->sp  = sp;                // stack pointer
-  process->thread->tf->psr = PSR_M_USR | PSR_F; // user mode, interrupts enabled
-  process->thread->tf->pc  = entry;             // process entry point
+  thread->tf->r0  = arg1;              // argc
+  thread->tf->r1  = arg2;              // argv
+  thread->tf->r2  = arg3;              // environ
+  thread->tf->sp  = sp;                // stack pointer
+  thread->tf->psr = PSR_M_USR | PSR_F; // user mode, interrupts enabled
+  thread->tf->pc  = entry;             // process entry point
   return arg1;
 }
 
@@ -1,4 +1,5 @@
 #include <kernel/core/cpu.h>
+#include <arch/arm/mach.h>
 #include <arch/arm/regs.h>
 
 // In case of four Cortex-A9 processors, the CPU IDs are 0x0, 0x1, 0x2, and
@@ -8,3 +9,15 @@ k_arch_cpu_id(void)
 {
   return cp15_mpidr_get() & CP15_MPIDR_CPU_ID;
 }
+
+void
+k_arch_cpu_relax(void)
+{
+  asm volatile("yield" : : : "memory");
+}
+
+void
+k_arch_cpu_ipi(unsigned cpu_id)
+{
+  mach_current->interrupt_ipi_cpu(cpu_id);
+}
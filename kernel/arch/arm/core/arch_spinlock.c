@@ -5,55 +5,64 @@
 
 // ARMv7-specific code to acquire a spinlock
 void
-k_arch_spinlock_acquire(volatile int *locked)
+k_arch_spinlock_acquire(volatile unsigned *locked)
 {
-  int tmp1, tmp2;
+  unsigned old_value, new_value, tmp;
+  uint16_t ticket;
 
+  // Atomically take the next ticket
   asm volatile(
-    "\tmov     %2, #1\n"        // Load the "lock acquired" value
     "\t1:\n"
-    "\tldrex   %1, [%0]\n"      // Read the lock field
-    "\tcmp     %1, #0\n"        // Is the lock free?
+    "\tldrex   %0, [%3]\n"      // Read the lock word
+    "\tadd     %1, %0, %4\n"    // Increment the next ticket field
+    "\tstrex   %2, %1, [%3]\n"  // Try and store the new value
+    "\tteq     %2, #0\n"        // Did this succeed?
     "\tbne     1b\n"            // No - try again
-    "\tstrex   %1, %2, [%0]\n"  // Try and acquire the lock
-    "\tcmp     %1, #0\n"        // Did this succeed?
-    "\tbne     1b\n"            // No - try again
-    : "+r"(locked), "=r"(tmp1), "=r"(tmp2)
-    :
+    : "=&r"(old_value), "=&r"(new_value), "=&r"(tmp)
+    : "r"(locked), "r"(1U << K_SPINLOCK_TICKET_SHIFT)
     : "memory", "cc");
+
+  ticket = old_value >> K_SPINLOCK_TICKET_SHIFT;
+
+  // Sleep until the owner releases the lock and signals an event
+  while ((*(volatile uint16_t *) locked) != ticket)
+    asm volatile("wfe" : : : "memory");
+
+  asm volatile("dmb" : : : "memory");
 }
 
 // ARMv7-specific code to release a spinlock
 void
-k_arch_spinlock_release(volatile int *locked)
+k_arch_spinlock_release(volatile unsigned *locked)
 {
-  int tmp;
+  asm volatile("dmb" : : : "memory");
+
+  // Only the lock owner modifies the lower half, so a plain store is enough
+  *(volatile uint16_t *) locked = *(volatile uint16_t *) locked + 1;
 
+  // Make the store visible before waking up the waiting CPUs
   asm volatile(
-    "\tmov     %1, #0\n"
-    "\tstr     %1, [%0]\n"
-    : "+r"(locked), "=r"(tmp)
-    :
-    : "cc", "memory"
-  );
+    "\tdsb\n"
+    "\tsev\n"
+    : : : "memory");
 }
 
 // Record the current call stack by following the frame pointer chain.
 // To properly generate stack backtrace structures, the code must be compiled
 // with the -mapcs-frame and -fno-omit-frame-pointer flags
 void
-k_arch_spinlock_save_callstack(struct KSpinLock *spin)
+k_arch_save_callstack(k_uintptr_t *pcs, int max)
 {
   k_uintptr_t *fp;
   int i;
 
   fp = (k_uintptr_t *) r11_get();
 
-  for (i = 0; (fp != NULL) && (i < K_SPINLOCK_MAX_PCS); i++) {
-    spin->pcs[i] = fp[APCS_FRAME_LINK];
+  for (i = 0; (fp != NULL) && (i < max); i++) {
+    pcs[i] = fp[APCS_FRAME_LINK];
     fp = (k_uintptr_t *) fp[APCS_FRAME_FP];
   }
 
-  for ( ; i < K_SPINLOCK_MAX_PCS; i++)
-    spin->pcs[i] = 0;
+  for ( ; i < max; i++)
+    pcs[i] = 0;
 }
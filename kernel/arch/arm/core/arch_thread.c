@@ -2,6 +2,7 @@
 #include <stdint.h>
 
 #include <arch/context.h>
+#include <kernel/core/irq.h>
 #include <kernel/core/task.h>
 
 void
@@ -19,5 +20,8 @@ arch_task_init_stack(struct KTask *task, void (*entry)(void))
 void
 arch_task_idle(void)
 {
-  asm volatile("wfi");
+  // WFI wakes up on a pending interrupt even if IRQs are masked, so unmask
+  // them afterwards to take it
+  asm volatile("wfi" : : : "memory");
+  k_arch_irq_enable();
 }
@@ -98,3 +98,9 @@ gic_sgi(struct Gic *gic, unsigned irq)
 {
   gic_icd_write(gic, ICDSGIR, (1 << 24) | (0xF << 16) | irq);
 }
+
+void
+gic_sgi_cpu(struct Gic *gic, unsigned irq, unsigned cpu)
+{
+  gic_icd_write(gic, ICDSGIR, (1 << (16 + cpu)) | irq);
+}
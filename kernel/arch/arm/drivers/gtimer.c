@@ -0,0 +1,110 @@
+// See ARM(R) Cortex(R)-A9 MPCore Technical Reference Manual
+
+#include <arch/arm/gtimer.h>
+
+// Global timer registers
+#define COUNT_LO      0x000   // Global Timer Counter Register (low word)
+#define COUNT_HI      0x004   // Global Timer Counter Register (high word)
+#define CTRL          0x008   // Global Timer Control Register
+  #define CTRL_EN       (1U << 0)   // Timer Enable
+  #define CTRL_COMP     (1U << 1)   // Comparator Enable
+  #define CTRL_IRQEN    (1U << 2)   // IRQ Enable
+#define ISR           0x00C   // Global Timer Interrupt Status Register
+#define COMP_LO       0x010   // Comparator Value Register (low word)
+#define COMP_HI       0x014   // Comparator Value Register (high word)
+
+#define PERIPHCLK     100000000U    // Peripheral clock rate, in Hz
+#define NS_PER_COUNT  (1000000000U / PERIPHCLK)
+
+// The counter is shared by all CPUs. The comparator, the interrupt enable bits
+// and the interrupt status are banked, so each CPU can program its own events.
+
+static inline uint32_t
+gtimer_read(struct GTimer *gtimer, uint32_t reg)
+{
+  return gtimer->base[reg >> 2];
+}
+
+static inline void
+gtimer_write(struct GTimer *gtimer, uint32_t reg, uint32_t data)
+{
+  gtimer->base[reg >> 2] = data;
+}
+
+static uint64_t
+gtimer_count(struct GTimer *gtimer)
+{
+  uint32_t hi, lo;
+
+  // Re-read if the low word has overflowed in the meantime
+  do {
+    hi = gtimer_read(gtimer, COUNT_HI);
+    lo = gtimer_read(gtimer, COUNT_LO);
+  } while (gtimer_read(gtimer, COUNT_HI) != hi);
+
+  return ((uint64_t) hi << 32) | lo;
+}
+
+void
+gtimer_init(struct GTimer *gtimer, void *base)
+{
+  gtimer->base = (volatile uint32_t *) base;
+
+  // No prescaler, to get the maximum resolution
+  if (!(gtimer_read(gtimer, CTRL) & CTRL_EN))
+    gtimer_write(gtimer, CTRL, CTRL_EN);
+}
+
+/**
+ * Get the current value of the global timer.
+ * 
+ * @param gtimer Pointer to the driver instance.
+ * 
+ * @return The number of nanoseconds since the timer was started.
+ */
+uint64_t
+gtimer_now(struct GTimer *gtimer)
+{
+  return gtimer_count(gtimer) * NS_PER_COUNT;
+}
+
+/**
+ * Request an interrupt on the current CPU at the given time.
+ * 
+ * @param gtimer Pointer to the driver instance.
+ * @param ns     The event time, in nanoseconds (see gtimer_now()).
+ */
+void
+gtimer_program(struct GTimer *gtimer, uint64_t ns)
+{
+  uint64_t comp = (ns + NS_PER_COUNT - 1) / NS_PER_COUNT;
+
+  gtimer_write(gtimer, CTRL, CTRL_EN);
+  gtimer_write(gtimer, ISR, 1);
+
+  // Some revisions only signal the event when the counter is equal to the
+  // comparator, so make sure the comparator is still ahead of the counter
+  for (;;) {
+    gtimer_write(gtimer, COMP_LO, (uint32_t) comp);
+    gtimer_write(gtimer, COMP_HI, (uint32_t) (comp >> 32));
+    gtimer_write(gtimer, CTRL, CTRL_IRQEN | CTRL_COMP | CTRL_EN);
+
+    if (gtimer_count(gtimer) < comp)
+      break;
+
+    if (gtimer_read(gtimer, ISR) & 1)
+      break;
+
+    comp = gtimer_count(gtimer) + 1;
+  }
+}
+
+/**
+ * Clear the global timer pending interrupt of the current CPU.
+ */
+void
+gtimer_eoi(struct GTimer *gtimer)
+{
+  gtimer_write(gtimer, CTRL, CTRL_EN);
+  gtimer_write(gtimer, ISR, 1);
+}
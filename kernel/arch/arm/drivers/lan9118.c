@@ -251,12 +251,14 @@ eth_rx(struct Lan9118 *lan9118)
 
   while(rx_used > 0) {
     uint32_t rx_status, packet_len;
+    struct Page *p = NULL;
 
     rx_status = lan9118->base[RX_STATUS_FIFO_PORT];
     packet_len = (rx_status >> 16) & 0x3FFF;
 
-    if (rx_status & (1 << 15)) {
-      // Packet has error: discard and update status
+    // Packet has error or no memory to store it: discard and update status
+    if ((rx_status & (1 << 15)) ||
+        ((p = page_alloc_one(PAGE_ALLOC_ZERO, PAGE_TAG_ETH_RX)) == NULL)) {
       uint32_t i, tmp;
 
       for (i = ROUND_UP(packet_len, sizeof(uint32_t)); i > 0; i -= sizeof(uint32_t))
@@ -264,11 +266,9 @@ eth_rx(struct Lan9118 *lan9118)
       (void) tmp;
     } else {
       uint32_t i;
-      struct Page *p;
       uint32_t *data;
       uint8_t *packet;
-  
-      p = page_alloc_one(PAGE_ALLOC_ZERO, PAGE_TAG_ETH_RX);
+
       packet = (uint8_t *) page2kva(p);
       data = (uint32_t *) page2kva(p);
 
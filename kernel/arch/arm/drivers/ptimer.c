@@ -14,6 +14,12 @@
 #define PERIPHCLK     100000000U    // Peripheral clock rate, in Hz
 #define PRESCALER     99U           // Prescaler value
 
+static inline uint32_t
+ptimer_read(struct PTimer *ptimer, uint32_t reg)
+{
+  return ptimer->base[reg >> 2];
+}
+
 static inline void
 ptimer_write(struct PTimer *ptimer, uint32_t reg, uint32_t data)
 {
@@ -29,7 +35,9 @@ ptimer_init(struct PTimer *ptimer, void *base)
 void
 ptimer_init_percpu(struct PTimer *ptimer, int rate)
 {
-  ptimer_write(ptimer, LOAD, PERIPHCLK / ((PRESCALER + 1) * rate) - 1);
+  ptimer->period = PERIPHCLK / ((PRESCALER + 1) * rate);
+
+  ptimer_write(ptimer, LOAD, ptimer->period - 1);
   ptimer_write(ptimer, CTRL, (PRESCALER << 8) |
                              CTRL_AUTO |
                              CTRL_IRQEN |
@@ -44,3 +52,48 @@ ptimer_eoi(struct PTimer *ptimer)
 {
   ptimer_write(ptimer, ISR, 1);
 }
+
+/**
+ * Switch the private timer of the current CPU into one-shot mode.
+ * 
+ * @param ptimer  Pointer to the driver instance.
+ * @param periods The number of tick periods until the interrupt. Clamped to
+ *                the maximum interval the counter can represent.
+ */
+void
+ptimer_oneshot(struct PTimer *ptimer, unsigned long periods)
+{
+  uint32_t max_periods = 0xFFFFFFFFU / ptimer->period;
+
+  if (periods > max_periods)
+    periods = max_periods;
+
+  // Writing the Load Register also reloads the counter
+  ptimer_write(ptimer, LOAD, periods * ptimer->period - 1);
+  ptimer_write(ptimer, CTRL, (PRESCALER << 8) |
+                             CTRL_IRQEN |
+                             CTRL_EN);
+}
+
+/**
+ * Switch the private timer of the current CPU back into periodic mode.
+ * 
+ * @param ptimer Pointer to the driver instance.
+ * 
+ * @return The number of whole tick periods elapsed in one-shot mode.
+ */
+unsigned long
+ptimer_periodic(struct PTimer *ptimer)
+{
+  uint32_t load  = ptimer_read(ptimer, LOAD);
+  uint32_t count = ptimer_read(ptimer, COUNT);
+
+  ptimer_write(ptimer, LOAD, ptimer->period - 1);
+  ptimer_write(ptimer, CTRL, (PRESCALER << 8) |
+                             CTRL_AUTO |
+                             CTRL_IRQEN |
+                             CTRL_EN);
+
+  // The counter stops at zero once the one-shot interval has expired
+  return (load - count + 1) / ptimer->period;
+}
@@ -3,9 +3,16 @@
 #include <arch/arm/sp804.h>
 
 // Timer registers
+#define TIMER1_LOAD         0x000     // Load Register
+#define TIMER1_VALUE        0x004     // Current Value Register
 #define TIMER1_CONTROL      0x008     // Control Register
 #define TIMER1_INT_CLR      0x00C     // Interrupt Clear Register
+#define TIMER1_MIS          0x014     // Masked Interrupt Status Register
 #define TIMER1_BG_LOAD      0x018     // Background Load Register
+#define TIMER2_LOAD         0x020     // Load Register
+#define TIMER2_CONTROL      0x028     // Control Register
+#define TIMER2_INT_CLR      0x02C     // Interrupt Clear Register
+#define TIMER2_MIS          0x034     // Masked Interrupt Status Register
 #define TIMER_PERIPH_ID0    0xFE0     // Timer Peripheral ID0 Register
 #define TIMER_PERIPH_ID1    0xFE4     // Timer Peripheral ID1 Register
 #define TIMER_PERIPH_ID2    0xFE8     // Timer Peripheral ID2 Register
@@ -21,6 +28,7 @@
 #define INT_ENABLE          (1 << 5)  // Interrupt Enable
 #define TIMER_PRE_0         (0 << 2)  // 0 stages of prescale
 #define TIMER_SIZE_32       (1 << 1)  // 32-bit counter
+#define TIMER_ONESHOT       (1 << 0)  // One-shot mode
 
 // Hard-coded values for identification registers
 #define PERIPH_ID           0x00141804
@@ -40,8 +48,8 @@ sp804_write(struct Sp804 *sp804, uint32_t reg, uint32_t data)
   sp804->base[reg >> 2] = data;
 }
 
-int 
-sp804_init(struct Sp804 *sp804, void *base, int rate)
+static int
+sp804_probe(struct Sp804 *sp804, void *base)
 {
   uint32_t periph_id, pcell_id;
   
@@ -60,7 +68,18 @@ sp804_init(struct Sp804 *sp804, void *base, int rate)
   if ((periph_id != PERIPH_ID) || (pcell_id != PCELL_ID))
     return -1;
 
-  sp804_write(sp804, TIMER1_BG_LOAD, REF_CLOCK / rate);
+  return 0;
+}
+
+int 
+sp804_init(struct Sp804 *sp804, void *base, int rate)
+{
+  if (sp804_probe(sp804, base) != 0)
+    return -1;
+
+  sp804->period = REF_CLOCK / rate;
+
+  sp804_write(sp804, TIMER1_BG_LOAD, sp804->period);
   sp804_write(sp804, TIMER1_CONTROL,
               TIMER_SIZE_32 |
               TIMER_MODE_PERIODIC |
@@ -77,3 +96,163 @@ sp804_eoi(struct Sp804 *sp804)
   // Writing random value clears the interrupt output
   sp804_write(sp804, TIMER1_INT_CLR, 0xFFFFFFFF);
 }
+
+/**
+ * Switch Timer 1 into one-shot mode.
+ * 
+ * @param sp804   Pointer to the driver instance.
+ * @param periods The number of tick periods until the interrupt. Clamped to
+ *                the maximum interval the counter can represent.
+ */
+void
+sp804_oneshot(struct Sp804 *sp804, unsigned long periods)
+{
+  uint32_t max_periods = 0xFFFFFFFFU / sp804->period;
+
+  if (periods > max_periods)
+    periods = max_periods;
+
+  sp804_write(sp804, TIMER1_CONTROL, TIMER_SIZE_32 | TIMER_ONESHOT);
+  sp804_write(sp804, TIMER1_LOAD, periods * sp804->period);
+  sp804_write(sp804, TIMER1_CONTROL,
+              TIMER_SIZE_32 |
+              TIMER_ONESHOT |
+              INT_ENABLE |
+              TIMER_PRE_0 |
+              TIMER_EN);
+}
+
+/**
+ * Switch Timer 1 back into periodic mode.
+ * 
+ * @param sp804 Pointer to the driver instance.
+ * 
+ * @return The number of whole tick periods elapsed in one-shot mode.
+ */
+unsigned long
+sp804_periodic(struct Sp804 *sp804)
+{
+  uint32_t load  = sp804_read(sp804, TIMER1_LOAD);
+  uint32_t value = sp804_read(sp804, TIMER1_VALUE);
+
+  sp804_write(sp804, TIMER1_CONTROL, TIMER_SIZE_32 | TIMER_MODE_PERIODIC);
+  sp804_write(sp804, TIMER1_LOAD, sp804->period);
+  sp804_write(sp804, TIMER1_CONTROL,
+              TIMER_SIZE_32 |
+              TIMER_MODE_PERIODIC |
+              INT_ENABLE |
+              TIMER_PRE_0 |
+              TIMER_EN);
+
+  return (load - value) / sp804->period;
+}
+
+/**
+ * Initialize the dual timer as a high-resolution clock.
+ * 
+ * Timer 1 is free running and provides the clock value (its wraparound
+ * interrupt makes sure that no overflow is missed), Timer 2 is used to
+ * generate one-shot events.
+ * 
+ * @param sp804 Pointer to the driver instance.
+ * @param base  Memory base address.
+ * 
+ * @return 0 on success, -1 if the device is not found.
+ */
+int
+sp804_clock_init(struct Sp804 *sp804, void *base)
+{
+  if (sp804_probe(sp804, base) != 0)
+    return -1;
+
+  sp804->period     = 0;
+  sp804->clock      = 0;
+  sp804->clock_last = 0xFFFFFFFF;
+
+  sp804_write(sp804, TIMER2_CONTROL, TIMER_SIZE_32 | TIMER_ONESHOT);
+
+  sp804_write(sp804, TIMER1_LOAD, 0xFFFFFFFF);
+  sp804_write(sp804, TIMER1_CONTROL,
+              TIMER_SIZE_32 |
+              TIMER_MODE_PERIODIC |
+              INT_ENABLE |
+              TIMER_PRE_0 |
+              TIMER_EN);
+
+  return 0;
+}
+
+/**
+ * Get the current clock value.
+ * 
+ * The caller is responsible for the mutual exclusion.
+ * 
+ * @param sp804 Pointer to the driver instance.
+ * 
+ * @return The number of microseconds since the clock was initialized.
+ */
+uint64_t
+sp804_clock_now(struct Sp804 *sp804)
+{
+  uint32_t value = sp804_read(sp804, TIMER1_VALUE);
+
+  // The counter is decrementing
+  sp804->clock     += (uint32_t) (sp804->clock_last - value);
+  sp804->clock_last = value;
+
+  return sp804->clock;
+}
+
+/**
+ * Generate an interrupt after the given number of microseconds.
+ * 
+ * @param sp804 Pointer to the driver instance.
+ * @param delay The delay in microseconds. Clamped to the maximum interval the
+ *              counter can represent.
+ */
+void
+sp804_clock_event(struct Sp804 *sp804, uint64_t delay)
+{
+  if (delay == 0)
+    delay = 1;
+  if (delay > 0xFFFFFFFFU)
+    delay = 0xFFFFFFFFU;
+
+  sp804_write(sp804, TIMER2_CONTROL, TIMER_SIZE_32 | TIMER_ONESHOT);
+  sp804_write(sp804, TIMER2_INT_CLR, 0xFFFFFFFF);
+  sp804_write(sp804, TIMER2_LOAD, delay);
+  sp804_write(sp804, TIMER2_CONTROL,
+              TIMER_SIZE_32 |
+              TIMER_ONESHOT |
+              INT_ENABLE |
+              TIMER_PRE_0 |
+              TIMER_EN);
+}
+
+/**
+ * Clear the clock interrupts.
+ * 
+ * The caller is responsible for the mutual exclusion.
+ * 
+ * @param sp804 Pointer to the driver instance.
+ * 
+ * @return Non-zero if the event timer has expired.
+ */
+int
+sp804_clock_eoi(struct Sp804 *sp804)
+{
+  int expired = 0;
+
+  if (sp804_read(sp804, TIMER1_MIS) & 1) {
+    // Account for the wraparound
+    sp804_clock_now(sp804);
+    sp804_write(sp804, TIMER1_INT_CLR, 0xFFFFFFFF);
+  }
+
+  if (sp804_read(sp804, TIMER2_MIS) & 1) {
+    sp804_write(sp804, TIMER2_INT_CLR, 0xFFFFFFFF);
+    expired = 1;
+  }
+
+  return expired;
+}
@@ -0,0 +1,15 @@
+#ifndef __KERNEL_GTIMER_H__
+#define __KERNEL_GTIMER_H__
+
+#include <stdint.h>
+
+struct GTimer {
+  volatile uint32_t *base;
+};
+
+void     gtimer_init(struct GTimer *, void *base);
+uint64_t gtimer_now(struct GTimer *);
+void     gtimer_program(struct GTimer *, uint64_t);
+void     gtimer_eoi(struct GTimer *);
+
+#endif  // !__KERNEL_GTIMER_H__
@@ -17,6 +17,7 @@ struct Machine {
   uint32_t type;
 
   void   (*interrupt_ipi)(void);
+  void   (*interrupt_ipi_cpu)(unsigned);
   int    (*interrupt_id)(void);
   void   (*interrupt_enable)(int, int);
   void   (*interrupt_mask)(int);
@@ -27,6 +28,11 @@ struct Machine {
 
   void   (*timer_init)(void);
   void   (*timer_init_percpu)(void);
+  void   (*timer_oneshot)(unsigned long);
+  unsigned long (*timer_periodic)(void);
+
+  uint64_t (*hrtimer_now)(void);
+  void   (*hrtimer_program)(uint64_t);
 
   void   (*rtc_init)(void);
   time_t (*rtc_get_time)(void);
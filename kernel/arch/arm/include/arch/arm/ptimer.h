@@ -5,10 +5,13 @@
 
 struct PTimer {
   volatile uint32_t *base;
+  uint32_t           period;    ///< Counter value for one tick period
 };
 
 void     ptimer_init(struct PTimer*, void *base);
 void     ptimer_init_percpu(struct PTimer *, int);
 void     ptimer_eoi(struct PTimer *);
+void     ptimer_oneshot(struct PTimer *, unsigned long);
+unsigned long ptimer_periodic(struct PTimer *);
 
 #endif  // !__KERNEL_PTIMER_H__
@@ -8,9 +8,19 @@
  */
 struct Sp804 {
   volatile uint32_t *base;    ///< Memory base address
+  uint32_t           period;  ///< Counter value for one tick period
+  uint64_t           clock;   ///< Clock value, in microseconds
+  uint32_t           clock_last; ///< Counter value at the last clock update
 };
 
 int  sp804_init(struct Sp804 *, void *, int);
 void sp804_eoi(struct Sp804 *);
+void sp804_oneshot(struct Sp804 *, unsigned long);
+unsigned long sp804_periodic(struct Sp804 *);
+
+int      sp804_clock_init(struct Sp804 *, void *);
+uint64_t sp804_clock_now(struct Sp804 *);
+void     sp804_clock_event(struct Sp804 *, uint64_t);
+int      sp804_clock_eoi(struct Sp804 *);
 
 #endif  // !__KERNEL_SP804_H__
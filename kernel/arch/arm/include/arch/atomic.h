@@ -0,0 +1,59 @@
+#ifndef __ARCH_ARM_ATOMIC_H__
+#define __ARCH_ARM_ATOMIC_H__
+
+/*
+ * ARMv7 atomic operations on 32-bit integers, based on exclusive loads and
+ * stores. Each operation is surrounded by barriers to make it fully ordered.
+ */
+
+static inline int
+k_arch_atomic_add_return(volatile int *p, int delta)
+{
+  int result, tmp;
+
+  asm volatile(
+    "\tdmb\n"
+    "\t1:\n"
+    "\tldrex   %0, [%2]\n"      // Read the current value
+    "\tadd     %0, %0, %3\n"    // Add the delta
+    "\tstrex   %1, %0, [%2]\n"  // Try and store the new value
+    "\tteq     %1, #0\n"        // Did this succeed?
+    "\tbne     1b\n"            // No - try again
+    "\tdmb\n"
+    : "=&r"(result), "=&r"(tmp)
+    : "r"(p), "r"(delta)
+    : "memory", "cc");
+
+  return result;
+}
+
+static inline int
+k_arch_atomic_cmpxchg(volatile int *p, int expected, int desired)
+{
+  int old, tmp;
+
+  asm volatile(
+    "\tdmb\n"
+    "\t1:\n"
+    "\tldrex   %0, [%2]\n"      // Read the current value
+    "\tteq     %0, %3\n"        // Does it match the expected one?
+    "\tbne     2f\n"            // No - give up
+    "\tstrex   %1, %4, [%2]\n"  // Try and store the new value
+    "\tteq     %1, #0\n"        // Did this succeed?
+    "\tbne     1b\n"            // No - try again
+    "\t2:\n"
+    "\tdmb\n"
+    : "=&r"(old), "=&r"(tmp)
+    : "r"(p), "r"(expected), "r"(desired)
+    : "memory", "cc");
+
+  return old;
+}
+
+static inline void
+k_arch_atomic_barrier(void)
+{
+  asm volatile("dmb" : : : "memory");
+}
+
+#endif  // !__ARCH_ARM_ATOMIC_H__
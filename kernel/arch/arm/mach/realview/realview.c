@@ -6,6 +6,7 @@
 #include <kernel/fs/buf.h>
 #include <kernel/page.h>
 #include <kernel/dev.h>
+#include <kernel/hrtimer.h>
 #include <kernel/tty.h>
 
 #include <kernel/drivers/sd.h>
@@ -16,6 +17,7 @@
 #include <arch/arm/ds1338.h>
 #include <arch/arm/sbcon.h>
 #include <arch/arm/gic.h>
+#include <arch/arm/gtimer.h>
 #include <arch/arm/ptimer.h>
 #include <arch/arm/sp804.h>
 #include <arch/arm/pl180.h>
@@ -25,6 +27,7 @@
 #include <arch/arm/lan9118.h>
 
 // #define PHYS_GICC         0x1F000100    ///< Interrupt interface
+#define PHYS_GTIMER       0x1F000200    ///< Global timer
 #define PHYS_PTIMER       0x1F000600    ///< Private timer
 // #define PHYS_GICD         0x1F001000    ///< Distributor
 
@@ -32,7 +35,9 @@
 
 static struct Gic gic;
 static struct PTimer ptimer;
+static struct GTimer gtimer;
 static struct Sp804 timer01;
+static struct Sp804 timer23;
 
 static void
 realview_interrupt_ipi(void)
@@ -40,6 +45,12 @@ realview_interrupt_ipi(void)
   gic_sgi(&gic, 0);
 }
 
+static void
+realview_interrupt_ipi_cpu(unsigned cpu)
+{
+  gic_sgi_cpu(&gic, 0, cpu);
+}
+
 static int
 realview_interrupt_id(void)
 {
@@ -158,11 +169,32 @@ realview_pb_a8_timer_irq(int irq, void *arg)
   return timer_irq(irq, arg);
 }
 
+// Protects the Timer 2/3 clock state
+static struct KSpinLock hrtimer_lock = K_SPINLOCK_INITIALIZER("hrtimer_clock");
+
+static int
+realview_pb_a8_hrtimer_irq(int, void *)
+{
+  int expired;
+
+  k_spinlock_acquire(&hrtimer_lock);
+  expired = sp804_clock_eoi(&timer23);
+  k_spinlock_release(&hrtimer_lock);
+
+  if (expired)
+    hrtimer_interrupt();
+
+  return 1;
+}
+
 static void
 realview_pb_a8_timer_init(void)
 {
   sp804_init(&timer01, PA2KVA(0x10011000), TICK_RATE);
   interrupt_attach(36, realview_pb_a8_timer_irq, NULL);
+
+  sp804_clock_init(&timer23, PA2KVA(0x10012000));
+  interrupt_attach(37, realview_pb_a8_hrtimer_irq, NULL);
 }
 
 static void
@@ -171,6 +203,44 @@ realview_pb_a8_timer_init_percpu(void)
 
 }
 
+static void
+realview_pb_a8_timer_oneshot(unsigned long periods)
+{
+  sp804_oneshot(&timer01, periods);
+}
+
+static unsigned long
+realview_pb_a8_timer_periodic(void)
+{
+  return sp804_periodic(&timer01);
+}
+
+static uint64_t
+realview_pb_a8_hrtimer_now(void)
+{
+  uint64_t now;
+
+  k_spinlock_acquire(&hrtimer_lock);
+  now = sp804_clock_now(&timer23);
+  k_spinlock_release(&hrtimer_lock);
+
+  return now * 1000;
+}
+
+static void
+realview_pb_a8_hrtimer_program(uint64_t expires)
+{
+  uint64_t now, target;
+
+  // Round up, so that the event never fires too early
+  target = (expires + 999) / 1000;
+
+  k_spinlock_acquire(&hrtimer_lock);
+  now = sp804_clock_now(&timer23);
+  sp804_clock_event(&timer23, target > now ? target - now : 1);
+  k_spinlock_release(&hrtimer_lock);
+}
+
 struct PL180 mmci;
 static struct SD sd;
 
@@ -312,6 +382,7 @@ MACH_DEFINE(realview_pb_a8) {
   .type = MACH_REALVIEW_PB_A8,
 
   .interrupt_ipi         = realview_interrupt_ipi,
+  .interrupt_ipi_cpu     = realview_interrupt_ipi_cpu,
   .interrupt_id          = realview_interrupt_id,
   .interrupt_enable      = realview_interrupt_enable,
   .interrupt_init        = realview_interrupt_init_pb_a8,
@@ -322,6 +393,11 @@ MACH_DEFINE(realview_pb_a8) {
 
   .timer_init            = realview_pb_a8_timer_init,
   .timer_init_percpu     = realview_pb_a8_timer_init_percpu,
+  .timer_oneshot         = realview_pb_a8_timer_oneshot,
+  .timer_periodic        = realview_pb_a8_timer_periodic,
+
+  .hrtimer_now           = realview_pb_a8_hrtimer_now,
+  .hrtimer_program       = realview_pb_a8_hrtimer_program,
 
   .rtc_init              = realview_rtc_init,
   .rtc_get_time          = realview_rtc_get_time,
@@ -352,12 +428,23 @@ realview_pbx_a9_timer_irq(int irq, void *arg)
   return timer_irq(irq, arg);
 }
 
+static int
+realview_pbx_a9_hrtimer_irq(int, void *)
+{
+  gtimer_eoi(&gtimer);
+  hrtimer_interrupt();
+  return 1;
+}
+
 static void
 realview_pbx_a9_timer_init(void)
 {
   ptimer_init(&ptimer, PA2KVA(PHYS_PTIMER));
   ptimer_init_percpu(&ptimer, TICK_RATE);
   interrupt_attach(29, realview_pbx_a9_timer_irq, NULL);
+
+  gtimer_init(&gtimer, PA2KVA(PHYS_GTIMER));
+  interrupt_attach(27, realview_pbx_a9_hrtimer_irq, NULL);
 }
 
 static void
@@ -365,12 +452,38 @@ realview_pbx_a9_timer_init_percpu(void)
 {
   ptimer_init_percpu(&ptimer, TICK_RATE);
   interrupt_unmask(29);
+  interrupt_unmask(27);
+}
+
+static void
+realview_pbx_a9_timer_oneshot(unsigned long periods)
+{
+  ptimer_oneshot(&ptimer, periods);
+}
+
+static unsigned long
+realview_pbx_a9_timer_periodic(void)
+{
+  return ptimer_periodic(&ptimer);
+}
+
+static uint64_t
+realview_pbx_a9_hrtimer_now(void)
+{
+  return gtimer_now(&gtimer);
+}
+
+static void
+realview_pbx_a9_hrtimer_program(uint64_t expires)
+{
+  gtimer_program(&gtimer, expires);
 }
 
 MACH_DEFINE(realview_pbx_a9) {
   .type = MACH_REALVIEW_PBX_A9,
 
   .interrupt_ipi         = realview_interrupt_ipi,
+  .interrupt_ipi_cpu     = realview_interrupt_ipi_cpu,
   .interrupt_id          = realview_interrupt_id,
   .interrupt_enable      = realview_interrupt_enable,
   .interrupt_init        = realview_interrupt_init_pbx_a9,
@@ -381,6 +494,11 @@ MACH_DEFINE(realview_pbx_a9) {
 
   .timer_init            = realview_pbx_a9_timer_init,
   .timer_init_percpu     = realview_pbx_a9_timer_init_percpu,
+  .timer_oneshot         = realview_pbx_a9_timer_oneshot,
+  .timer_periodic        = realview_pbx_a9_timer_periodic,
+
+  .hrtimer_now           = realview_pbx_a9_hrtimer_now,
+  .hrtimer_program       = realview_pbx_a9_hrtimer_program,
 
   .rtc_init              = realview_rtc_init,
   .rtc_get_time          = realview_rtc_get_time,
@@ -61,7 +61,7 @@ static void *kernel_pgtab;
 #define L2_TABLES_PER_PAGE  2
 
 void
-arch_vm_switch(struct Process *)
+arch_vm_switch(struct Thread *)
 {
   
 }
@@ -44,10 +44,11 @@ fpu_context_restore(void *src)
 int
 arch_process_copy(struct Process *parent, struct Process *child)
 {
-  k_assert(parent->thread != NULL);
+  k_assert(parent == process_current());
   k_assert(child->thread != NULL);
 
-  *child->thread->tf = *parent->thread->tf;
+  // Only the calling thread is duplicated
+  *child->thread->tf = *thread_current()->tf;
   child->thread->tf->r0 = 0;
 
   return 0;
@@ -58,7 +59,7 @@ arch_on_thread_before_switch(struct Thread *thread)
 {
   fpu_context_save(thread->task.kstack);
 
-  arch_vm_switch(thread->process);
+  arch_vm_switch(thread);
   arch_vm_load(thread->process->vm->pgtab);
 }
 
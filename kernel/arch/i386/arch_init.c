@@ -7,6 +7,7 @@
 #include <kernel/page.h>
 #include <kernel/interrupt.h>
 #include <kernel/console.h>
+#include <kernel/hrtimer.h>
 #include <kernel/tty.h>
 #include <kernel/trap.h>
 
@@ -414,10 +415,31 @@ acpi_init(void)
   acpi_rsdt_unmap();
 }
 
+static int
+arch_timer_irq(int irq, void *arg)
+{
+#ifdef NOSMP
+  hrtimer_interrupt();
+  return timer_irq(irq, arg);
+#else
+  int expired = lapic_timer_expired();
+
+  if (expired & LAPIC_TIMER_EVENT)
+    hrtimer_interrupt();
+  if (expired & LAPIC_TIMER_TICK)
+    return timer_irq(irq, arg);
+
+  return 1;
+#endif
+}
+
 void
 arch_init_devices(void)
 {
-  interrupt_attach(0, timer_irq, NULL);
+  interrupt_attach(0, arch_timer_irq, NULL);
+#ifndef NOSMP
+  interrupt_attach(IRQ_IPI, ipi_irq, NULL);
+#endif
   pci_scan();
 }
 
@@ -7,10 +7,19 @@
 #include <arch/i386/i8259.h>
 #include <arch/i386/ioapic.h>
 
+// The local timer and IPIs come from the local APIC rather than the I/O APIC
+static int
+arch_interrupt_is_local(int irq)
+{
+  return (irq == IRQ_PIT) || (irq == IRQ_IPI);
+}
+
 void
 arch_interrupt_ipi(void)
 {
-  // TODO
+#ifndef NOSMP
+  lapic_ipi_others(IRQ_IPI);
+#endif
 }
 
 int
@@ -26,7 +35,8 @@ arch_interrupt_enable(int irq, int cpu)
   (void) irq;
   (void) cpu;
 #else
-  ioapic_enable(irq, cpu);
+  if (irq != IRQ_IPI)
+    ioapic_enable(irq, cpu);
 #endif
 }
 
@@ -39,7 +49,7 @@ arch_interrupt_mask(int irq)
   // if (irq == IRQ_ATA1)
   //   cprintf("[k] mask %d\n", irq);
 
-  if (irq != IRQ_PIT)
+  if (!arch_interrupt_is_local(irq))
     ioapic_mask(irq);
 #endif
 }
@@ -53,7 +63,7 @@ arch_interrupt_unmask(int irq)
   // if (irq == IRQ_ATA1)
   //   cprintf("[k] unmask %d\n", irq);
 
-  if (irq != IRQ_PIT)
+  if (!arch_interrupt_is_local(irq))
     ioapic_unmask(irq);
 #endif
 }
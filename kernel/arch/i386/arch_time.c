@@ -2,9 +2,13 @@
 
 #include <kernel/time.h>
 #include <kernel/console.h>
+#include <kernel/interrupt.h>
 #include <kernel/core/spinlock.h>
+#include <kernel/core/tick.h>
+#include <kernel/hrtimer.h>
 
 #include <arch/i386/io.h>
+#include <arch/i386/lapic.h>
 
 enum {
   CMOS_ADDRESS = 0x70,
@@ -107,3 +111,54 @@ arch_get_time_seconds(void)
 
   return mktime(&tm);
 }
+
+int
+k_arch_tick_oneshot(k_tick_t ticks)
+{
+#ifdef NOSMP
+  // The PIT is shared by all CPUs and kept periodic
+  (void) ticks;
+  return K_ERR_INVAL;
+#else
+  lapic_timer_oneshot(ticks);
+  return 0;
+#endif
+}
+
+k_tick_t
+k_arch_tick_periodic(void)
+{
+#ifdef NOSMP
+  return 0;
+#else
+  return lapic_timer_periodic();
+#endif
+}
+
+void
+k_arch_tick_kick(void)
+{
+  arch_interrupt_ipi();
+}
+
+uint64_t
+arch_hrtimer_now(void)
+{
+#ifdef NOSMP
+  // Fall back to the tick resolution
+  return k_tick_get() * NS_PER_TICK;
+#else
+  return lapic_timer_now();
+#endif
+}
+
+void
+arch_hrtimer_program(uint64_t expires)
+{
+#ifdef NOSMP
+  // Expired timers are processed on each tick
+  (void) expires;
+#else
+  lapic_timer_event(expires);
+#endif
+}
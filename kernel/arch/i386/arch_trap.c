@@ -45,7 +45,7 @@ trap_handle_pgfault(struct TrapFrame *tf)
   cprintf("[%d %s]: user fault va %p\n", process->pid, process->name, address);
 
   // TODO: SEGV_MAPERR or SEGV_ACCERR
-  if (signal_generate(process->pid, SIGSEGV, 0) != 0)
+  if (signal_generate_thread(thread_current(), SIGSEGV, 0) != 0)
     k_panic("sending SIGSEGV failed");
 }
 
@@ -134,15 +134,16 @@ print_trapframe(struct TrapFrame *tf)
 int
 ipi_irq(int, void *)
 {
-  // TODO
-  return -1;
+  // Nothing to do: the IPI brings the CPU out of idle, and a pending reschedule
+  // request is handled by k_irq_handler_end()
+  return 1;
 }
 
 int 
-arch_trap_frame_init(struct Process *process, uintptr_t entry, uintptr_t arg1,
+arch_trap_frame_init(struct Thread *thread, uintptr_t entry, uintptr_t arg1,
                      uintptr_t arg2, uintptr_t arg3, uintptr_t sp)
 {
-  k_assert(process->thread != NULL);
+  struct Process *process = thread->process;
 
   sp -= 4;
   vm_copy_out(process->vm->pgtab, &arg3, sp, sizeof arg3);
@@ -152,15 +153,15 @@ arch_trap_frame_init(struct Process *process, uintptr_t entry, uintptr_t arg1,
   vm_copy_out(process->vm->pgtab, &arg1, sp, sizeof arg1);
   sp -= 4;
 
-  process->thread->tf->cs = SEG_USER_CODE;
-  process->thread->tf->eip = entry;
-  process->thread->tf->es = SEG_USER_DATA;
-  process->thread->tf->ds = SEG_USER_DATA;
-  process->thread->tf->ss = SEG_USER_DATA;
-  process->thread->tf->esp = sp;
-  process->thread->tf->gs = 0;
-  process->thread->tf->fs = 0;
-  process->thread->tf->eflags = EFLAGS_IF;
+  thread->tf->cs = SEG_USER_CODE;
+  thread->tf->eip = entry;
+  thread->tf->es = SEG_USER_DATA;
+  thread->tf->ds = SEG_USER_DATA;
+  thread->tf->ss = SEG_USER_DATA;
+  thread->tf->esp = sp;
+  thread->tf->gs = 0;
+  thread->tf->fs = 0;
+  thread->tf->eflags = EFLAGS_IF;
 
   return 0;
 }
@@ -1,5 +1,6 @@
 #include <kernel/core/assert.h>
 #include <kernel/core/cpu.h>
+#include <arch/trap.h>
 #include <arch/i386/lapic.h>
 
 unsigned
@@ -7,3 +8,19 @@ k_arch_cpu_id(void)
 {
   return lapic_id();
 }
+
+void
+k_arch_cpu_relax(void)
+{
+  asm volatile("pause" : : : "memory");
+}
+
+void
+k_arch_cpu_ipi(unsigned cpu_id)
+{
+#ifdef NOSMP
+  (void) cpu_id;
+#else
+  lapic_ipi(cpu_id, IRQ_IPI);
+#endif
+}
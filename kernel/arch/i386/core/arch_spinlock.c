@@ -5,45 +5,57 @@
 
 #include <arch/i386/regs.h>
 
-static inline int
-xchg(volatile int *p, int new_value)
+static inline unsigned
+xadd(volatile unsigned *p, unsigned value)
 {
-	int old_value;
-
-	asm volatile("lock\n\t"
-               "xchgl %0, %1" :
-			         "+m" (*p), "=a" (old_value) :
-		           "1" (new_value) :
-			         "cc");
-	return old_value;
+  asm volatile("lock\n\t"
+               "xaddl %0, %1" :
+               "+r" (value), "+m" (*p) :
+               :
+               "memory", "cc");
+  return value;
 }
 
 void
-k_arch_spinlock_acquire(volatile int *locked)
+k_arch_spinlock_acquire(volatile unsigned *locked)
 {
-  while (xchg(locked, 1) != 0)
-    ;
+  unsigned ticket;
+
+  // Take a ticket. The locked instruction is a full barrier.
+  ticket = xadd(locked, 1U << K_SPINLOCK_TICKET_SHIFT);
+  ticket >>= K_SPINLOCK_TICKET_SHIFT;
+
+  // Wait for our turn. Only the owner part is polled, so the cache line stays
+  // shared until the current owner releases the lock.
+  while ((*(volatile uint16_t *) locked) != (uint16_t) ticket)
+    asm volatile("pause" : : : "memory");
 }
 
 void
-k_arch_spinlock_release(volatile int *locked)
+k_arch_spinlock_release(volatile unsigned *locked)
 {
-  xchg(locked, 0);
+  // Only the lock owner modifies the lower half, and the 16-bit increment
+  // cannot carry into the next ticket field
+  asm volatile("lock\n\t"
+               "incw %0" :
+               "+m" (*(volatile uint16_t *) locked) :
+               :
+               "memory", "cc");
 }
 
 void
-k_arch_spinlock_save_callstack(struct KSpinLock *spin)
+k_arch_save_callstack(k_uintptr_t *pcs, int max)
 {
   k_uintptr_t *ebp;
   int i;
 
   ebp = (k_uintptr_t *) ebp_get();
 
-  for (i = 0; (ebp != NULL) && (i < K_SPINLOCK_MAX_PCS); i++) {
-    spin->pcs[i] = ebp[1];
+  for (i = 0; (ebp != NULL) && (i < max); i++) {
+    pcs[i] = ebp[1];
     ebp = (k_uintptr_t *) ebp[0];
   }
 
-  for ( ; i < K_SPINLOCK_MAX_PCS; i++)
-    spin->pcs[i] = 0;
+  for ( ; i < max; i++)
+    pcs[i] = 0;
 }
@@ -16,5 +16,7 @@ arch_task_init_stack(struct KTask *task, void (*entry)(void))
 void
 arch_task_idle(void)
 {
-  // do nothing
+  // STI takes effect after the next instruction, so no interrupt can sneak in
+  // before HLT
+  asm volatile("sti; hlt" : : : "memory");
 }
@@ -1,12 +1,15 @@
 #include <stdint.h>
 
 #include <kernel/console.h>
+#include <kernel/core/config.h>
 
 #include <arch/memlayout.h>
 #include <arch/i386/lapic.h>
 #include <arch/i386/i8253.h>
 #include <arch/i386/io.h>
+#include <arch/i386/regs.h>
 #include <arch/trap.h>
+#include <kernel/time.h>
 #include <kernel/vm.h>
 
 enum {
@@ -33,6 +36,7 @@ enum {
 };
 
 enum {
+  ICR_OTHERS      = 0x000C0000,
   ICR_BCAST       = 0x00080000,
   ICR_STARTUP     = 0x00000600,
   ICR_ASSERT      = 0x00004000,
@@ -48,11 +52,29 @@ enum {
 enum {
   LVT_MASKED         = (1 << 16),
   LVT_TIMER_PERIODIC = (1 << 17),
+  LVT_TIMER_DEADLINE = (2 << 17),
 };
 
 uint32_t lapic_pa;
 size_t lapic_ncpus;
 
+// Timer count corresponding to one tick period
+static uint32_t lapic_timer_count;
+
+// TSC increments per one tick period
+static uint64_t lapic_tsc_per_tick;
+
+// Whether the timer supports the TSC-deadline mode
+static int lapic_tsc_deadline;
+
+// The local timer always runs in one-shot mode and is shared between the
+// periodic tick and the high-resolution timer events. All times are TSC values.
+static struct {
+  uint64_t tick_last;     // Time of the last tick
+  uint64_t tick_next;     // Time of the next tick
+  uint64_t event_next;    // Time of the next timer event (0 if none)
+} lapic_timers[K_CPU_MAX];
+
 static volatile uint32_t *lapic_base = (uint32_t *) VIRT_LAPIC_BASE;
 
 void
@@ -62,24 +84,33 @@ lapic_reg_write(int idx, uint32_t value)
   (void) lapic_base[REG_ID];
 }
 
+static void lapic_timer_init(void);
+static void lapic_timer_program(void);
+
 void
 lapic_init_percpu(void)
 {
   uint32_t init_count, count;
+  uint64_t tsc_start, tsc_end;
 
   lapic_reg_write(REG_SPURIOUS, SPURIOUS_ENABLE | (T_IRQ0 + IRQ_SPURIOUS));
 
   // Calibrate
   lapic_reg_write(REG_DIVIDE_CONF, DIVIDE_CONF_X1);
   lapic_reg_write(REG_INITIAL_COUNT, 0xFFFFFFFF);
+  tsc_start = tsc_get();
   i8253_count_down();
+  tsc_end = tsc_get();
   init_count = lapic_base[REG_CURRENT_COUNT];
 
   count = 0xffffffff - init_count;
+  lapic_timer_count = count;
 
-  lapic_reg_write(REG_DIVIDE_CONF, DIVIDE_CONF_X1);
-  lapic_reg_write(REG_LVT_TIMER, LVT_TIMER_PERIODIC | (T_IRQ0 + IRQ_PIT));
-  lapic_reg_write(REG_INITIAL_COUNT, count);
+  // All CPUs must use the same clock rate
+  if (lapic_tsc_per_tick == 0)
+    lapic_tsc_per_tick = tsc_end - tsc_start;
+
+  lapic_timer_init();
 
   lapic_reg_write(REG_LVT_LINT0, LVT_MASKED);
   lapic_reg_write(REG_LVT_LINT1, LVT_MASKED);
@@ -124,6 +155,194 @@ lapic_id(void)
   return lapic_pa ? lapic_base[REG_ID] >> 24 : 0;
 }
 
+static void
+lapic_timer_init(void)
+{
+  uint32_t eax, ebx, ecx, edx;
+  uint64_t now;
+
+  cpuid(1, &eax, &ebx, &ecx, &edx);
+  lapic_tsc_deadline = (ecx & CPUID_1_ECX_TSC_DEADLINE) != 0;
+
+  lapic_reg_write(REG_DIVIDE_CONF, DIVIDE_CONF_X1);
+  lapic_reg_write(REG_LVT_TIMER, (lapic_tsc_deadline ? LVT_TIMER_DEADLINE : 0) |
+                                 (T_IRQ0 + IRQ_PIT));
+
+  now = tsc_get();
+  lapic_timers[lapic_id()].tick_last  = now;
+  lapic_timers[lapic_id()].tick_next  = now + lapic_tsc_per_tick;
+  lapic_timers[lapic_id()].event_next = 0;
+
+  lapic_timer_program();
+}
+
+// Convert a TSC interval into the local timer count
+static uint32_t
+lapic_tsc2count(uint64_t tsc)
+{
+  uint64_t ticks = tsc / lapic_tsc_per_tick;
+
+  if (ticks >= 0xFFFFFFFFU / lapic_timer_count)
+    return 0xFFFFFFFFU;
+
+  return ticks * lapic_timer_count +
+         (tsc % lapic_tsc_per_tick) * lapic_timer_count / lapic_tsc_per_tick;
+}
+
+// Arm the local timer for the nearest of the next tick and the next event.
+// Must be called with interrupts disabled.
+static void
+lapic_timer_program(void)
+{
+  uint64_t deadline = lapic_timers[lapic_id()].tick_next;
+  uint64_t event = lapic_timers[lapic_id()].event_next;
+
+  if ((event != 0) && (event < deadline))
+    deadline = event;
+
+  if (lapic_tsc_deadline) {
+    // A deadline in the past generates an interrupt immediately
+    msr_set(MSR_TSC_DEADLINE, deadline);
+  } else {
+    uint64_t now = tsc_get();
+    uint32_t count = deadline > now ? lapic_tsc2count(deadline - now) : 0;
+
+    lapic_reg_write(REG_INITIAL_COUNT, count != 0 ? count : 1);
+  }
+}
+
+/**
+ * Acknowledge the local timer interrupt and re-arm the timer.
+ * 
+ * The interrupt may be generated earlier than expected if the requested
+ * interval cannot be represented, or be a spurious one.
+ * 
+ * @return A combination of LAPIC_TIMER_TICK (the tick period has elapsed) and
+ *         LAPIC_TIMER_EVENT (the programmed event time has been reached).
+ */
+int
+lapic_timer_expired(void)
+{
+  uint64_t now = tsc_get();
+  int cpu = lapic_id();
+  int expired = 0;
+
+  if (now >= lapic_timers[cpu].tick_next) {
+    lapic_timers[cpu].tick_last  = lapic_timers[cpu].tick_next;
+    lapic_timers[cpu].tick_next += lapic_tsc_per_tick;
+    expired |= LAPIC_TIMER_TICK;
+  }
+
+  if ((lapic_timers[cpu].event_next != 0) &&
+      (now >= lapic_timers[cpu].event_next)) {
+    lapic_timers[cpu].event_next = 0;
+    expired |= LAPIC_TIMER_EVENT;
+  }
+
+  lapic_timer_program();
+
+  return expired;
+}
+
+/**
+ * Request a local timer interrupt at the given time.
+ * 
+ * Must be called with interrupts disabled.
+ * 
+ * @param ns The event time, in nanoseconds (see lapic_timer_now()).
+ */
+void
+lapic_timer_event(uint64_t ns)
+{
+  uint64_t tsc;
+  
+  // Round up, so that the event never fires before the requested time
+  tsc = (ns / NS_PER_TICK) * lapic_tsc_per_tick +
+        ((ns % NS_PER_TICK) * lapic_tsc_per_tick + NS_PER_TICK - 1) / NS_PER_TICK;
+
+  lapic_timers[lapic_id()].event_next = tsc != 0 ? tsc : 1;
+  lapic_timer_program();
+}
+
+/**
+ * Get the time elapsed since the CPU reset.
+ * 
+ * @return The value of the time-stamp counter converted to nanoseconds.
+ */
+uint64_t
+lapic_timer_now(void)
+{
+  uint64_t tsc = tsc_get();
+
+  return (tsc / lapic_tsc_per_tick) * NS_PER_TICK +
+         (tsc % lapic_tsc_per_tick) * NS_PER_TICK / lapic_tsc_per_tick;
+}
+
+/**
+ * Stop the periodic tick on the current CPU.
+ * 
+ * @param periods The number of tick periods until the next tick interrupt.
+ */
+void
+lapic_timer_oneshot(unsigned long long periods)
+{
+  int cpu = lapic_id();
+
+  lapic_timers[cpu].tick_next = lapic_timers[cpu].tick_last +
+                                periods * lapic_tsc_per_tick;
+  lapic_timer_program();
+}
+
+/**
+ * Restart the periodic tick on the current CPU.
+ * 
+ * @return The number of whole tick periods elapsed since the last tick.
+ */
+unsigned long
+lapic_timer_periodic(void)
+{
+  int cpu = lapic_id();
+  uint64_t elapsed;
+
+  elapsed = (tsc_get() - lapic_timers[cpu].tick_last) / lapic_tsc_per_tick;
+
+  lapic_timers[cpu].tick_last += elapsed * lapic_tsc_per_tick;
+  lapic_timers[cpu].tick_next  = lapic_timers[cpu].tick_last +
+                                 lapic_tsc_per_tick;
+  lapic_timer_program();
+
+  return elapsed;
+}
+
+/**
+ * Send an inter-processor interrupt to all CPUs except the current one.
+ * 
+ * @param irq The IRQ number to deliver.
+ */
+void
+lapic_ipi_others(int irq)
+{
+  lapic_reg_write(REG_ICR_HI, 0);
+  lapic_reg_write(REG_ICR_LO, ICR_OTHERS | (T_IRQ0 + irq));
+  while (lapic_base[REG_ICR_LO] & ICR_DELIV_STS)
+    ;
+}
+
+/**
+ * Send an inter-processor interrupt to the given CPU.
+ *
+ * @param cpu_id The local APIC ID of the target CPU.
+ * @param irq    The IRQ number to deliver.
+ */
+void
+lapic_ipi(unsigned cpu_id, int irq)
+{
+  lapic_reg_write(REG_ICR_HI, cpu_id << 24);
+  lapic_reg_write(REG_ICR_LO, T_IRQ0 + irq);
+  while (lapic_base[REG_ICR_LO] & ICR_DELIV_STS)
+    ;
+}
+
 #define CMOS_PORT    0x70
 
 void
@@ -0,0 +1,46 @@
+#ifndef __ARCH_I386_ATOMIC_H__
+#define __ARCH_I386_ATOMIC_H__
+
+/*
+ * Atomic operations on 32-bit integers. Locked instructions are full memory
+ * barriers on x86, so no additional fences are required.
+ */
+
+static inline int
+k_arch_atomic_add_return(volatile int *p, int delta)
+{
+  int old = delta;
+
+  asm volatile("lock\n\t"
+               "xaddl %0, %1" :
+               "+r" (old), "+m" (*p) :
+               :
+               "memory", "cc");
+
+  return old + delta;
+}
+
+static inline int
+k_arch_atomic_cmpxchg(volatile int *p, int expected, int desired)
+{
+  int old;
+
+  asm volatile("lock\n\t"
+               "cmpxchgl %2, %1" :
+               "=a" (old), "+m" (*p) :
+               "r" (desired), "0" (expected) :
+               "memory", "cc");
+
+  return old;
+}
+
+static inline void
+k_arch_atomic_barrier(void)
+{
+  // Any locked instruction will do; unlike MFENCE, it is available on all
+  // 32-bit processors
+  asm volatile("lock\n\t"
+               "addl $0, (%%esp)" : : : "memory", "cc");
+}
+
+#endif  // !__ARCH_I386_ATOMIC_H__
@@ -4,11 +4,21 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#define LAPIC_TIMER_TICK    (1 << 0)    ///< The tick period has elapsed
+#define LAPIC_TIMER_EVENT   (1 << 1)    ///< The event time has been reached
+
 void     lapic_init(void);
 void     lapic_init_percpu(void);
 void     lapic_eoi(void);
 unsigned lapic_id(void);
 void     lapic_start(unsigned, uintptr_t);
+void     lapic_timer_oneshot(unsigned long long);
+unsigned long lapic_timer_periodic(void);
+int      lapic_timer_expired(void);
+void     lapic_timer_event(uint64_t);
+uint64_t lapic_timer_now(void);
+void     lapic_ipi(unsigned, int);
+void     lapic_ipi_others(int);
 
 extern uint32_t lapic_pa;
 extern size_t   lapic_ncpus;
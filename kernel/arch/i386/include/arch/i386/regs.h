@@ -7,6 +7,10 @@
 
 #define CR4_PSE           (1 << 4)    // Page Size Extensions
 
+#define CPUID_1_ECX_TSC_DEADLINE  (1 << 24)   // TSC-deadline timer support
+
+#define MSR_TSC_DEADLINE  0x6E0       // TSC target of the local APIC timer
+
 #define EFLAGS_IF         (1 << 9)    // Interrupt enable
 #define EFLAGS_IOPL_MASK  (3 << 12)   // I/O privilege level field
 #define EFLAGS_IOPL_0     (0 << 12)
@@ -51,6 +55,32 @@ ebp_get(void)
 	return ebp;
 }
 
+static inline void
+cpuid(uint32_t leaf, uint32_t *eax, uint32_t *ebx, uint32_t *ecx,
+      uint32_t *edx)
+{
+  asm volatile("cpuid"
+               : "=a" (*eax), "=b" (*ebx), "=c" (*ecx), "=d" (*edx)
+               : "a" (leaf), "c" (0));
+}
+
+static inline uint64_t
+tsc_get(void)
+{
+  uint32_t lo, hi;
+
+  asm volatile("rdtsc" : "=a" (lo), "=d" (hi));
+  return ((uint64_t) hi << 32) | lo;
+}
+
+static inline void
+msr_set(uint32_t msr, uint64_t value)
+{
+  asm volatile("wrmsr"
+               :
+               : "c" (msr), "a" ((uint32_t) value), "d" ((uint32_t) (value >> 32)));
+}
+
 #endif  // !__ASSEMBLER__
 
 #endif  // !__ARCH_I386_REGS_H__
@@ -38,6 +38,7 @@
 #define IRQ_ATA2      15
 
 #define IRQ_ERROR     19
+#define IRQ_IPI       30
 #define IRQ_SPURIOUS  31
 
 #ifndef __ASSEMBLER__
@@ -46,11 +46,11 @@ k_condvar_destroy(struct KCondVar *cond)
 
   _k_sched_lock();
   _k_sched_wakeup_all_locked(&cond->queue, -K_ERR_INVAL);
-  _k_sched_unlock();
 
   cond->type = 0;
 
-  // TODO: check reschedule
+  _k_sched_may_yield();
+  _k_sched_unlock();
 }
 
 /**
@@ -82,6 +82,39 @@ k_condvar_timed_wait(struct KCondVar *cond,
                      struct KMutex *mutex,
                      k_tick_t timeout,
                      int options)
+{
+  return k_condvar_timed_wait_hook(cond, mutex, timeout, options, K_NULL,
+                                   K_NULL);
+}
+
+/**
+ * @brief Wait on a condition variable, calling a function before going to
+ *        sleep.
+ *
+ * Same as `k_condvar_timed_wait()`, but `hook` is called after the mutex is
+ * unlocked, with the scheduler locked. Notifications are delivered under the
+ * same lock, so any notification sent after the hook is called (e.g. by a
+ * timer armed by the hook) wakes the calling task.
+ *
+ * @param cond     Pointer to the condition variable to wait on.
+ * @param mutex    Pointer to a mutex currently held by the calling task.
+ * @param timeout  Timeout duration in system ticks.
+ * @param options  Wait behavior flags (see `k_condvar_timed_wait()`).
+ * @param hook     Function to call before going to sleep (or `K_NULL`). Must
+ *                 not sleep or call any scheduler functions.
+ * @param hook_arg Argument passed to the hook.
+ *
+ * @retval `0` on successful wakeup (signal or broadcast).
+ * @retval `K_ERR_TIMEDOUT` if the timeout expired before a signal was received.
+ * @retval `K_ERR_INVAL` if the condition variable was destroyed while waiting.
+ */
+int
+k_condvar_timed_wait_hook(struct KCondVar *cond,
+                          struct KMutex *mutex,
+                          k_tick_t timeout,
+                          int options,
+                          void (*hook)(void *),
+                          void *hook_arg)
 {
   int r;
 
@@ -94,6 +127,9 @@ k_condvar_timed_wait(struct KCondVar *cond,
 
   _k_mutex_unlock(mutex);
 
+  if (hook != K_NULL)
+    hook(hook_arg);
+
   r = _k_sched_sleep(&cond->queue,
                      options & K_SLEEP_UNWAKEABLE
                       ? K_TASK_STATE_SLEEP_UNWAKEABLE
@@ -128,10 +164,9 @@ k_condvar_notify_one(struct KCondVar *cond)
 
   _k_sched_lock();
   _k_sched_wakeup_one_locked(&cond->queue, 0);
+  _k_sched_may_yield();
   _k_sched_unlock();
 
-  // TODO: check reschedule
-
   return 0;
 }
 
@@ -156,9 +191,8 @@ k_condvar_notify_all(struct KCondVar *cond)
 
   _k_sched_lock();
   _k_sched_wakeup_all_locked(&cond->queue, 0);
+  _k_sched_may_yield();
   _k_sched_unlock();
 
-  // TODO: check reschedule
-
   return 0;
 }
@@ -9,11 +9,13 @@
 
 struct Context;
 struct KListLink;
+struct KCpu;
+struct KLockStat;
 struct KMutex;
 struct KTimer;
 
 void            _k_sched_resume(struct KTask *, int);
-void            _k_sched_may_yield(struct KTask *);
+void            _k_sched_may_yield(void);
 void            _k_sched_yield_locked(void);
 void            _k_sched_enqueue(struct KTask *);
 void            _k_sched_wakeup_all_locked(struct KListLink *, int);
@@ -22,7 +24,10 @@ int             _k_sched_sleep(struct KListLink *, int, k_tick_t, struct KSpinLo
 void            _k_sched_raise_priority(struct KTask *, int);
 void            _k_sched_recalc_priority(struct KTask *);
 void            _k_sched_adjust_timeouts(k_tick_t);
+k_tick_t        _k_sched_next_timeout(void);
 void            _k_sched_update_effective_priority(void);
+void            _k_sched_set_priority(struct KTask *, int);
+int             _k_sched_set_affinity(struct KTask *, unsigned long);
 void            _k_sched_check_quantum(void);
 
 int             _k_mutex_timed_lock(struct KMutex *, k_tick_t);
@@ -30,15 +35,66 @@ void            _k_mutex_unlock(struct KMutex *);
 int             _k_mutex_get_highest_priority(struct KListLink *);
 void            _k_mutex_may_raise_priority(struct KMutex *, int);
 
+void            _k_rcu_init(void);
+void            _k_rcu_quiescent(struct KCpu *);
+
+void            _k_timer_init(void);
 void            _k_timer_adjust_timeouts(k_tick_t);
+k_tick_t        _k_timer_next_timeout(void);
+
+void            _k_tick_init_percpu(void);
+void            _k_tick_idle_enter(struct KCpu *);
+void            _k_tick_idle_exit(struct KCpu *);
+void            _k_tick_wakeup(void);
+
+#ifdef K_LATENCY_STAT
+void            _k_latency_irqs_off(void);
+void            _k_latency_irqs_on(void);
+void            _k_latency_lock_acquired(struct KSpinLock *);
+void            _k_latency_lock_released(void);
+void            _k_latency_task_woken(struct KTask *);
+void            _k_latency_task_running(struct KTask *);
+#endif
+
+#ifdef K_LOCK_STAT
+unsigned long long _k_lock_stat_clock(void);
+void            _k_lock_stat_acquired(struct KLockStat **, const char *, int,
+                                      unsigned long long);
+void            _k_lock_stat_released(struct KLockStat *, unsigned long long);
+#else
+static inline unsigned long long
+_k_lock_stat_clock(void)
+{
+  return 0;
+}
+#endif
 
-void            _k_timeout_queue_check(struct KListLink *, void (*)(struct KTimeoutEntry *));
-void            _k_timeout_queue_adjust(struct KListLink *,
+/** Number of index bits per timing wheel level */
+#define K_TIMEOUT_WHEEL_BITS    6
+/** Number of slots on each timing wheel level */
+#define K_TIMEOUT_WHEEL_SLOTS   (1 << K_TIMEOUT_WHEEL_BITS)
+/** Number of timing wheel levels */
+#define K_TIMEOUT_WHEEL_LEVELS  4
+
+/**
+ * Queue of pending timeouts organized as a hierarchical timing wheel.
+ */
+struct KTimeoutQueue {
+  k_tick_t         now;     ///< Ticks processed by this queue so far
+  /** Entries sorted by expiry time, lower levels have finer granularity */
+  struct KListLink slots[K_TIMEOUT_WHEEL_LEVELS][K_TIMEOUT_WHEEL_SLOTS];
+  /** Number of entries on each level */
+  k_size_t         level_size[K_TIMEOUT_WHEEL_LEVELS];
+};
+
+void            _k_timeout_queue_init(struct KTimeoutQueue *);
+void            _k_timeout_queue_adjust(struct KTimeoutQueue *,
                         void (*callback)(struct KTimeoutEntry *),
                         k_tick_t);
 void            _k_timeout_create(struct KTimeoutEntry *);
-void            _k_timeout_queue_add(struct KListLink *, struct KTimeoutEntry *, k_tick_t);
-void            _k_timeout_queue_remove(struct KListLink *, struct KTimeoutEntry *);
+void            _k_timeout_queue_add(struct KTimeoutQueue *, struct KTimeoutEntry *, k_tick_t);
+void            _k_timeout_queue_remove(struct KTimeoutQueue *, struct KTimeoutEntry *);
+k_tick_t        _k_timeout_queue_next(struct KTimeoutQueue *);
 void            _k_timeout_destroy(struct KTimeoutEntry *);
 
 extern struct KSpinLock _k_sched_spinlock;
@@ -83,6 +139,22 @@ _k_sched_wakeup_one(struct KListLink *queue, int result)
   _k_sched_unlock();
 }
 
+// Yield if one of the tasks woken up by the caller should preempt the current
+// task. Must be called after releasing all spinlocks, otherwise the reschedule
+// is delayed until the next interrupt.
+static inline void
+_k_sched_preempt(void)
+{
+  struct KTask *my_task = k_task_current();
+
+  // Only take the lock if a reschedule has been requested
+  if ((my_task != K_NULL) && (my_task->flags & K_TASK_FLAG_RESCHEDULE)) {
+    _k_sched_lock();
+    _k_sched_may_yield();
+    _k_sched_unlock();
+  }
+}
+
 /**
  * The kernel maintains a special structure for each processor, which
  * records the per-CPU information.
@@ -93,8 +165,24 @@ struct KCpu {
   int             lock_count;     ///< Sheculer lock nesting level
   int             irq_save_count; ///< Nesting level of k_irq_state_save() calls
   int             irq_flags;      ///< IRQ state before the first k_irq_state_save()
+
+  struct KSpinLock run_queue_lock;  ///< Protects the run queue of this CPU
+  struct KListLink run_queue[K_TASK_MAX_PRIORITIES]; ///< Ready tasks
+  k_size_t         run_queue_size;  ///< Number of tasks in the run queue
+
+  int              tick_stopped;    ///< Periodic tick is stopped while idle
+  int              tick_resumed;    ///< Tick restarted by the current IRQ
+
+  int              lock_stat_busy;  ///< Lock statistics are being recorded
+
+  unsigned long    rcu_qs_count;    ///< Quiescent states passed (for RCU)
+
+  /** Virtual runtime of the fair tasks on this CPU (monotonic) */
+  unsigned long long fair_min_vruntime;
 };
 
+extern struct KCpu _k_cpus[K_CPU_MAX];
+
 struct KCpu    *_k_cpu(void);
 
 #endif  // !__CORE_PRIVATE_H
@@ -4,7 +4,7 @@
 
 #include "core_private.h"
 
-static struct KCpu _k_cpus[K_CPU_MAX];
+struct KCpu _k_cpus[K_CPU_MAX];
 
 struct KCpu *
 _k_cpu(void)
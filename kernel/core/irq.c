@@ -18,10 +18,19 @@
 void
 k_irq_state_save(void)
 {
+#ifdef K_LATENCY_STAT
+  int enabled = k_arch_irq_is_enabled();
+#endif
   int flags = k_arch_irq_state_save();
 
-  if (_k_cpu()->irq_save_count++ == 0)
+  if (_k_cpu()->irq_save_count++ == 0) {
     _k_cpu()->irq_flags = flags;
+
+#ifdef K_LATENCY_STAT
+    if (enabled)
+      _k_latency_irqs_off();
+#endif
+  }
 }
 
 /**
@@ -44,8 +53,13 @@ k_irq_state_restore(void)
 
   k_assert(count >= 0);
 
-  if (count == 0)
+  if (count == 0) {
+#ifdef K_LATENCY_STAT
+    _k_latency_irqs_on();
+#endif
+
     k_arch_irq_state_restore(cpu->irq_flags);
+  }
 }
 
 /**
@@ -54,13 +68,28 @@ k_irq_state_restore(void)
  * This function is called at the entry point of an interrupt service routine
  * (ISR). Increments the per-CPU internal lock counter. This ensures that
  * nested interrupts and re-entrant handler logic remain consistent with the
- * kernel’s locking model.
+ * kernel’s locking model. If the CPU was idle with the periodic tick stopped,
+ * the tick is restarted and the elapsed ticks are accounted for.
  */
 void
 k_irq_handler_begin(void)
 {
+  struct KCpu *cpu;
+
   k_irq_state_save();
-  ++_k_cpu()->lock_count;
+
+  cpu = _k_cpu();
+
+  // RCU readers keep interrupts disabled, so none of them was interrupted
+  if (cpu->lock_count++ == 0)
+    _k_rcu_quiescent(cpu);
+
+  // The CPU is woken up from tickless idle, catch up with the system time
+  if (cpu->tick_stopped) {
+    _k_tick_idle_exit(cpu);
+    cpu->tick_resumed = 1;
+  }
+
   k_irq_state_restore();
 }
 
@@ -87,6 +116,8 @@ k_irq_handler_end(void)
   k_assert(count >= 0);
 
   if (count == 0) {
+    cpu->tick_resumed = 0;
+
     struct KTask *current = cpu->task;
 
     if ((current != K_NULL) && (current->flags & K_TASK_FLAG_RESCHEDULE)) {
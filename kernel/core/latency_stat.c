@@ -0,0 +1,267 @@
+#include <kernel/core/assert.h>
+#include <kernel/core/cpu.h>
+#include <kernel/core/irq.h>
+#include <kernel/core/latency_stat.h>
+#include <kernel/core/percpu.h>
+#include <kernel/core/task.h>
+
+#include "core_private.h"
+
+#ifdef K_LATENCY_STAT
+
+struct KLatencyCpu {
+  struct KLatencyStatInfo stats[K_LATENCY_MAX];
+
+  // The current interrupts-disabled section
+  unsigned long long irqs_off_start;
+  k_uintptr_t        irqs_off_pcs[K_SPINLOCK_MAX_PCS];
+
+  // The current preemption-disabled section
+  int                preempt_depth;
+  unsigned long long preempt_off_start;
+  k_uintptr_t        preempt_off_pcs[K_SPINLOCK_MAX_PCS];
+
+  int                busy;
+};
+
+// Each CPU updates only its own statistics, with interrupts disabled
+K_PERCPU_DEFINE_STATIC(struct KLatencyCpu, k_latency_cpus);
+
+// Get the current time. Sections started by the clock hook itself (i.e. while
+// the statistics are being recorded) are not accounted for, to avoid infinite
+// recursion
+static unsigned long long
+k_latency_clock(struct KLatencyCpu *lat)
+{
+  unsigned long long now;
+
+  lat->busy = 1;
+  now = K_ON_LOCK_STAT_CLOCK();
+  lat->busy = 0;
+
+  return now;
+}
+
+static void
+k_latency_record(struct KLatencyStatInfo *stat, unsigned long long time,
+                 const k_uintptr_t *pcs)
+{
+  unsigned long long units = time >> 10;
+  int bucket, i;
+
+  for (bucket = 0; (units != 0) && (bucket < K_LATENCY_HIST_MAX - 1); bucket++)
+    units >>= 1;
+
+  stat->count++;
+  stat->total += time;
+  stat->hist[bucket]++;
+
+  if (time > stat->max) {
+    stat->max     = time;
+    stat->max_cpu = k_cpu_id();
+    for (i = 0; i < K_SPINLOCK_MAX_PCS; i++)
+      stat->max_pcs[i] = pcs[i];
+  }
+}
+
+/**
+ * @brief Called when interrupts get disabled by the outermost
+ *        `k_irq_state_save()` call.
+ */
+void
+_k_latency_irqs_off(void)
+{
+  struct KLatencyCpu *lat = &K_PERCPU_THIS(k_latency_cpus);
+
+  if (lat->busy)
+    return;
+
+  if ((lat->irqs_off_start = k_latency_clock(lat)) != 0)
+    k_arch_save_callstack(lat->irqs_off_pcs, K_SPINLOCK_MAX_PCS);
+}
+
+/**
+ * @brief Called just before the outermost `k_irq_state_restore()` call
+ *        restores the interrupt state.
+ */
+void
+_k_latency_irqs_on(void)
+{
+  struct KLatencyCpu *lat = &K_PERCPU_THIS(k_latency_cpus);
+  unsigned long long start, now;
+
+  if (lat->busy || ((start = lat->irqs_off_start) == 0))
+    return;
+
+  lat->irqs_off_start = 0;
+
+  if ((now = k_latency_clock(lat)) != 0)
+    k_latency_record(&lat->stats[K_LATENCY_IRQS_OFF], now - start,
+                     lat->irqs_off_pcs);
+}
+
+/**
+ * @brief Called after a spinlock is acquired.
+ *
+ * @param spin The spinlock (its callstack must be already saved).
+ */
+void
+_k_latency_lock_acquired(struct KSpinLock *spin)
+{
+  struct KLatencyCpu *lat = &K_PERCPU_THIS(k_latency_cpus);
+  int i;
+
+  if ((lat->preempt_depth++ != 0) || lat->busy)
+    return;
+
+  if ((lat->preempt_off_start = k_latency_clock(lat)) != 0)
+    for (i = 0; i < K_SPINLOCK_MAX_PCS; i++)
+      lat->preempt_off_pcs[i] = spin->pcs[i];
+}
+
+/**
+ * @brief Called before a spinlock is released.
+ */
+void
+_k_latency_lock_released(void)
+{
+  struct KLatencyCpu *lat = &K_PERCPU_THIS(k_latency_cpus);
+  unsigned long long start, now;
+
+  k_assert(lat->preempt_depth > 0);
+
+  if ((--lat->preempt_depth != 0) || lat->busy)
+    return;
+
+  if ((start = lat->preempt_off_start) == 0)
+    return;
+
+  lat->preempt_off_start = 0;
+
+  if ((now = k_latency_clock(lat)) != 0)
+    k_latency_record(&lat->stats[K_LATENCY_PREEMPT_OFF], now - start,
+                     lat->preempt_off_pcs);
+}
+
+/**
+ * @brief Called when a sleeping task is made ready to run.
+ */
+void
+_k_latency_task_woken(struct KTask *task)
+{
+  struct KLatencyCpu *lat = &K_PERCPU_THIS(k_latency_cpus);
+
+  task->wakeup_time = lat->busy ? 0 : k_latency_clock(lat);
+}
+
+/**
+ * @brief Called when a task is about to start running on the current CPU.
+ */
+void
+_k_latency_task_running(struct KTask *task)
+{
+  struct KLatencyCpu *lat = &K_PERCPU_THIS(k_latency_cpus);
+  k_uintptr_t pcs[K_SPINLOCK_MAX_PCS] = { (k_uintptr_t) task->entry };
+  unsigned long long start, now, latency;
+
+  if (lat->busy || ((start = task->wakeup_time) == 0))
+    return;
+
+  task->wakeup_time = 0;
+
+  // The clocks of different CPUs may be slightly out of sync
+  if (((now = k_latency_clock(lat)) == 0) || (now < start))
+    return;
+
+  latency = now - start;
+
+  k_latency_record(&lat->stats[K_LATENCY_WAKEUP], latency, pcs);
+
+  if (latency > task->wakeup_latency_max)
+    task->wakeup_latency_max = latency;
+}
+
+#endif  // K_LATENCY_STAT
+
+/**
+ * @brief Get the latency statistics.
+ *
+ * The statistics of all CPUs are summed up. Other CPUs may be updating them
+ * concurrently, so the result may be slightly inconsistent.
+ *
+ * @param type The latency type (`K_LATENCY_IRQS_OFF`, etc.)
+ * @param info Pointer to store the statistics.
+ *
+ * @retval 0 on success.
+ * @retval `K_ERR_INVAL` if the type is invalid or the statistics are disabled.
+ */
+int
+k_latency_stat_get(int type, struct KLatencyStatInfo *info)
+{
+#ifdef K_LATENCY_STAT
+  int cpu, i;
+
+  if ((type < 0) || (type >= K_LATENCY_MAX))
+    return K_ERR_INVAL;
+
+  k_memset(info, 0, sizeof(*info));
+
+  for (cpu = 0; cpu < K_CPU_MAX; cpu++) {
+    struct KLatencyStatInfo *stat =
+      &K_PERCPU_GET(k_latency_cpus, cpu).stats[type];
+
+    info->count += stat->count;
+    info->total += stat->total;
+
+    for (i = 0; i < K_LATENCY_HIST_MAX; i++)
+      info->hist[i] += stat->hist[i];
+
+    if (stat->max > info->max) {
+      info->max     = stat->max;
+      info->max_cpu = stat->max_cpu;
+      for (i = 0; i < K_SPINLOCK_MAX_PCS; i++)
+        info->max_pcs[i] = stat->max_pcs[i];
+    }
+  }
+
+  return 0;
+#else
+  (void) type;
+  (void) info;
+  return K_ERR_INVAL;
+#endif
+}
+
+/**
+ * @brief Reset all latency statistics.
+ *
+ * The statistics are cleared while other CPUs may be updating them, so a few
+ * concurrent events may survive the reset.
+ */
+void
+k_latency_stat_reset(void)
+{
+#ifdef K_LATENCY_STAT
+  int cpu;
+
+  for (cpu = 0; cpu < K_CPU_MAX; cpu++)
+    k_memset(K_PERCPU_GET(k_latency_cpus, cpu).stats, 0,
+             sizeof(K_PERCPU_GET(k_latency_cpus, cpu).stats));
+#endif
+}
+
+/**
+ * @brief Get the longest wakeup latency of the given task.
+ *
+ * @return The latency in nanoseconds (0 if the statistics are disabled).
+ */
+unsigned long long
+k_latency_stat_task_max(struct KTask *task)
+{
+#ifdef K_LATENCY_STAT
+  return task->wakeup_latency_max;
+#else
+  (void) task;
+  return 0;
+#endif
+}
@@ -0,0 +1,244 @@
+#include <kernel/core/assert.h>
+#include <kernel/core/cpu.h>
+#include <kernel/core/irq.h>
+#include <kernel/core/lock_stat.h>
+#include <kernel/core/spinlock.h>
+
+#include "core_private.h"
+
+#ifdef K_LOCK_STAT
+
+static struct KLockStat k_lock_stats[K_LOCK_STAT_MAX];
+static int k_lock_stat_count;
+static struct KSpinLock k_lock_stat_lock = K_SPINLOCK_INITIALIZER("lock_stat");
+
+// Locks acquired while collecting the statistics (including those taken by the
+// clock hook) are not accounted for, to avoid infinite recursion
+static inline int
+k_lock_stat_enter(struct KCpu *my_cpu)
+{
+  if (my_cpu->lock_stat_busy)
+    return 0;
+
+  my_cpu->lock_stat_busy = 1;
+  return 1;
+}
+
+static inline void
+k_lock_stat_leave(struct KCpu *my_cpu)
+{
+  my_cpu->lock_stat_busy = 0;
+}
+
+// Lock the statistics table without accounting for the table lock itself
+static int
+k_lock_stat_table_lock(void)
+{
+  int entered;
+
+  k_irq_state_save();
+  entered = k_lock_stat_enter(_k_cpu());
+
+  k_spinlock_acquire(&k_lock_stat_lock);
+
+  return entered;
+}
+
+static void
+k_lock_stat_table_unlock(int entered)
+{
+  k_spinlock_release(&k_lock_stat_lock);
+
+  if (entered)
+    k_lock_stat_leave(_k_cpu());
+  k_irq_state_restore();
+}
+
+// Find or allocate the statistics entry for the given lock name
+static struct KLockStat *
+k_lock_stat_lookup(const char *name)
+{
+  struct KLockStat *stat = K_NULL;
+  int i;
+
+  if (name == K_NULL)
+    name = "<unnamed>";
+
+  k_spinlock_acquire(&k_lock_stat_lock);
+
+  for (i = 0; i < k_lock_stat_count; i++) {
+    if (k_strcmp(k_lock_stats[i].name, name) == 0) {
+      stat = &k_lock_stats[i];
+      break;
+    }
+  }
+
+  if ((stat == K_NULL) && (k_lock_stat_count < K_LOCK_STAT_MAX)) {
+    stat = &k_lock_stats[k_lock_stat_count++];
+    stat->name = name;
+  }
+
+  k_spinlock_release(&k_lock_stat_lock);
+
+  return stat;
+}
+
+/**
+ * @brief Get the current time for the lock statistics.
+ *
+ * Must be called with interrupts disabled.
+ *
+ * @return The current time, or 0 if the event should not be recorded.
+ */
+unsigned long long
+_k_lock_stat_clock(void)
+{
+  struct KCpu *my_cpu = _k_cpu();
+  unsigned long long now;
+
+  if (!k_lock_stat_enter(my_cpu))
+    return 0;
+
+  now = K_ON_LOCK_STAT_CLOCK();
+
+  k_lock_stat_leave(my_cpu);
+
+  return now;
+}
+
+/**
+ * @brief Record a lock acquisition.
+ *
+ * Must be called with interrupts disabled.
+ *
+ * @param statp     Pointer to the cached statistics entry of the lock.
+ * @param name      The lock name.
+ * @param contended Whether the caller had to wait for the lock.
+ * @param wait      The time spent waiting.
+ */
+void
+_k_lock_stat_acquired(struct KLockStat **statp, const char *name,
+                      int contended, unsigned long long wait)
+{
+  struct KCpu *my_cpu = _k_cpu();
+  struct KLockStat *stat;
+  int cpu;
+
+  if (!k_lock_stat_enter(my_cpu))
+    return;
+
+  if ((stat = *statp) == K_NULL)
+    stat = *statp = k_lock_stat_lookup(name);
+
+  if (stat != K_NULL) {
+    cpu = k_cpu_id();
+
+    stat->cpu[cpu].acquired++;
+    if (contended)
+      stat->cpu[cpu].contended++;
+
+    stat->cpu[cpu].wait_total += wait;
+    if (wait > stat->cpu[cpu].wait_max)
+      stat->cpu[cpu].wait_max = wait;
+  }
+
+  k_lock_stat_leave(my_cpu);
+}
+
+/**
+ * @brief Record a lock release.
+ *
+ * Must be called with interrupts disabled.
+ *
+ * @param stat  The statistics entry of the lock.
+ * @param start The time when the lock was acquired (0 if not recorded).
+ */
+void
+_k_lock_stat_released(struct KLockStat *stat, unsigned long long start)
+{
+  unsigned long long now, hold;
+  int cpu;
+
+  if ((stat == K_NULL) || (start == 0))
+    return;
+
+  if ((now = _k_lock_stat_clock()) == 0)
+    return;
+
+  cpu  = k_cpu_id();
+  hold = now - start;
+
+  if (hold > stat->cpu[cpu].hold_max)
+    stat->cpu[cpu].hold_max = hold;
+}
+
+#endif  // K_LOCK_STAT
+
+/**
+ * @brief Get the lock contention statistics.
+ *
+ * The per-CPU counters are summed up for each lock name.
+ *
+ * @param info Array to store the statistics.
+ * @param max  The maximum number of entries to store.
+ *
+ * @return The number of entries stored (0 if the statistics are disabled).
+ */
+int
+k_lock_stat_get(struct KLockStatInfo *info, int max)
+{
+#ifdef K_LOCK_STAT
+  int i, cpu, n, entered;
+
+  entered = k_lock_stat_table_lock();
+
+  n = k_lock_stat_count < max ? k_lock_stat_count : max;
+
+  for (i = 0; i < n; i++) {
+    struct KLockStat *stat = &k_lock_stats[i];
+
+    k_memset(&info[i], 0, sizeof(info[i]));
+    info[i].name = stat->name;
+
+    for (cpu = 0; cpu < K_CPU_MAX; cpu++) {
+      info[i].acquired   += stat->cpu[cpu].acquired;
+      info[i].contended  += stat->cpu[cpu].contended;
+      info[i].wait_total += stat->cpu[cpu].wait_total;
+
+      if (stat->cpu[cpu].wait_max > info[i].wait_max)
+        info[i].wait_max = stat->cpu[cpu].wait_max;
+      if (stat->cpu[cpu].hold_max > info[i].hold_max)
+        info[i].hold_max = stat->cpu[cpu].hold_max;
+    }
+  }
+
+  k_lock_stat_table_unlock(entered);
+
+  return n;
+#else
+  (void) info;
+  (void) max;
+  return 0;
+#endif
+}
+
+/**
+ * @brief Reset all lock contention statistics.
+ *
+ * The counters are cleared while other CPUs may be updating them, so a few
+ * concurrent events may survive the reset.
+ */
+void
+k_lock_stat_reset(void)
+{
+#ifdef K_LOCK_STAT
+  int i, entered;
+
+  entered = k_lock_stat_table_lock();
+
+  for (i = 0; i < k_lock_stat_count; i++)
+    k_memset(k_lock_stats[i].cpu, 0, sizeof(k_lock_stats[i].cpu));
+
+  k_lock_stat_table_unlock(entered);
+#endif
+}
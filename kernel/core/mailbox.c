@@ -4,8 +4,11 @@
 
 #include "core_private.h"
 
-static int k_mailbox_try_receive_locked(struct KMailBox *, void *);
-static int k_mailbox_try_send_locked(struct KMailBox *, const void *);
+static int  k_mailbox_ring_get(struct KMailBox *, void *);
+static int  k_mailbox_ring_put(struct KMailBox *, const void *);
+static void k_mailbox_wakeup(struct KMailBox *, struct KListLink *,
+                             volatile int *);
+static int  k_mailbox_wait(struct KMailBox *, void *, int, k_tick_t, int);
 
 // Used by the kernel to verify that the object is a valid mailbox
 #define K_MAILBOX_TYPE    0x4D424F58  // {'M','B','O','X'}
@@ -15,17 +18,19 @@ static int k_mailbox_try_send_locked(struct KMailBox *, const void *);
  *
  * This function sets up a mailbox object with a specified message size and
  * backing buffer. The buffer is treated as a circular queue divided into
- * fixed-size message slots.
+ * fixed-size message slots, each of `K_MAILBOX_SLOT_SIZE(msg_size)` bytes.
+ * The number of slots is rounded down to a power of two.
  *
  * @param mailbox   Pointer to the mailbox structure to initialize.
  * @param msg_size  Size of each message (in bytes).
  * @param buf       Pointer to the user-supplied buffer for message storage.
- * @param buf_size  Size of the buffer (in bytes). Must be a multiple of msg_size.
+ * @param buf_size  Size of the buffer (in bytes). Use `K_MAILBOX_BUF_SIZE` to
+ *                  compute the size for the desired number of messages.
  *
  * @return 0 on success.
  *
- * @note The caller is responsible for ensuring that the buffer is properly
- *       aligned and remains valid for the lifetime of the mailbox.
+ * @note The caller is responsible for ensuring that the buffer is aligned to
+ *       `sizeof(k_size_t)` and remains valid for the lifetime of the mailbox.
  */
 int
 k_mailbox_create(struct KMailBox *mailbox,
@@ -33,18 +38,31 @@ k_mailbox_create(struct KMailBox *mailbox,
                  void *buf,
                  k_size_t buf_size)
 {
+  k_size_t i;
+
+  k_assert(buf_size >= K_MAILBOX_SLOT_SIZE(msg_size));
+
   k_spinlock_init(&mailbox->lock, "k_mailbox");
   k_list_init(&mailbox->receivers);
   k_list_init(&mailbox->senders);
 
   mailbox->type = K_MAILBOX_TYPE;
-  mailbox->buf_start = (k_uint8_t *) buf;
-  mailbox->buf_end = mailbox->buf_start + buf_size - (buf_size % msg_size);
-  mailbox->read_ptr = mailbox->buf_start;
-  mailbox->write_ptr = mailbox->buf_start;
+  mailbox->buf = (k_uint8_t *) buf;
   mailbox->msg_size = msg_size;
-  mailbox->capacity = buf_size / msg_size;
-  mailbox->size = 0;
+  mailbox->slot_size = K_MAILBOX_SLOT_SIZE(msg_size);
+
+  mailbox->capacity = 1;
+  while (mailbox->capacity * 2 <= buf_size / mailbox->slot_size)
+    mailbox->capacity *= 2;
+
+  // Slot i is free for the sender that claims position i
+  for (i = 0; i < mailbox->capacity; i++)
+    *(k_size_t *) (mailbox->buf + i * mailbox->slot_size) = i;
+
+  mailbox->head = 0;
+  mailbox->tail = 0;
+  mailbox->receivers_waiting = 0;
+  mailbox->senders_waiting = 0;
   mailbox->flags = 0;
 
   return 0;
@@ -77,7 +95,7 @@ k_mailbox_destroy(struct KMailBox *mailbox)
 
   mailbox->type = 0;
 
-  // TODO: check reschedule
+  _k_sched_preempt();
 }
 
 /**
@@ -101,9 +119,8 @@ k_mailbox_try_receive(struct KMailBox *mailbox, void *message)
   k_assert(mailbox != K_NULL);
   k_assert(mailbox->type == K_MAILBOX_TYPE);
 
-  k_spinlock_acquire(&mailbox->lock);
-  r = k_mailbox_try_receive_locked(mailbox, message);
-  k_spinlock_release(&mailbox->lock);
+  if ((r = k_mailbox_ring_get(mailbox, message)) == 0)
+    k_mailbox_wakeup(mailbox, &mailbox->senders, &mailbox->senders_waiting);
 
   return r;
 }
@@ -135,49 +152,16 @@ k_mailbox_timed_receive(struct KMailBox *mailbox,
   k_assert(mailbox != K_NULL);
   k_assert(mailbox->type == K_MAILBOX_TYPE);
 
-  k_spinlock_acquire(&mailbox->lock);
-
-  while ((r = k_mailbox_try_receive_locked(mailbox, message)) != 0) {
-    if (r != K_ERR_AGAIN)
-      break;
-
-    r = _k_sched_sleep(&mailbox->receivers,
-                       options & K_SLEEP_UNWAKEABLE
-                        ? K_TASK_STATE_SLEEP_UNWAKEABLE
-                        : K_TASK_STATE_SLEEP,
-                       timeout,
-                       &mailbox->lock);
-    if (r < 0)
-      break;
-  }
-
-  k_spinlock_release(&mailbox->lock);
+  // Fast path: a message is already available
+  if ((r = k_mailbox_ring_get(mailbox, message)) != 0)
+    r = k_mailbox_wait(mailbox, message, 0, timeout, options);
 
-  // TODO: check reschedule
+  if (r == 0)
+    k_mailbox_wakeup(mailbox, &mailbox->senders, &mailbox->senders_waiting);
 
   return r;
 }
 
-static int
-k_mailbox_try_receive_locked(struct KMailBox *mailbox, void *message)
-{
-  k_assert(k_spinlock_holding(&mailbox->lock));
-
-  if (mailbox->size == 0)
-    return K_ERR_AGAIN;
-
-  k_memmove(message, mailbox->read_ptr, mailbox->msg_size);
-
-  mailbox->read_ptr += mailbox->msg_size;
-  if (mailbox->read_ptr >= mailbox->buf_end)
-    mailbox->read_ptr = mailbox->buf_start;
-
-  mailbox->size--;
-  _k_sched_wakeup_one(&mailbox->senders, 0);
-
-  return 0;
-}
-
 /**
  * @brief Attempt to send a message to a mailbox (non-blocking).
  *
@@ -199,9 +183,9 @@ k_mailbox_try_send(struct KMailBox *mailbox, const void *message)
   k_assert(mailbox != K_NULL);
   k_assert(mailbox->type == K_MAILBOX_TYPE);
 
-  k_spinlock_acquire(&mailbox->lock);
-  r = k_mailbox_try_send_locked(mailbox, message);
-  k_spinlock_release(&mailbox->lock);
+  if ((r = k_mailbox_ring_put(mailbox, message)) == 0)
+    k_mailbox_wakeup(mailbox, &mailbox->receivers,
+                     &mailbox->receivers_waiting);
 
   return r;
 }
@@ -233,13 +217,46 @@ k_mailbox_timed_send(struct KMailBox *mailbox,
   k_assert(mailbox != K_NULL);
   k_assert(mailbox->type == K_MAILBOX_TYPE);
 
+  // Fast path: there is a free slot
+  if ((r = k_mailbox_ring_put(mailbox, message)) != 0)
+    r = k_mailbox_wait(mailbox, (void *) message, 1, timeout, options);
+
+  if (r == 0)
+    k_mailbox_wakeup(mailbox, &mailbox->receivers,
+                     &mailbox->receivers_waiting);
+
+  return r;
+}
+
+// Sleep until a message can be sent (if send is non-zero) or received
+static int
+k_mailbox_wait(struct KMailBox *mailbox,
+               void *message,
+               int send,
+               k_tick_t timeout,
+               int options)
+{
+  struct KListLink *queue = send ? &mailbox->senders : &mailbox->receivers;
+  volatile int *waiting = send
+    ? &mailbox->senders_waiting
+    : &mailbox->receivers_waiting;
+  int r;
+
   k_spinlock_acquire(&mailbox->lock);
 
-  while ((r = k_mailbox_try_send_locked(mailbox, message)) != 0) {
+  // Announce ourselves before re-checking the ring. Paired with the fence in
+  // k_mailbox_wakeup(): either we see the slot updated by the other side, or
+  // the other side sees the counter and wakes us up.
+  __atomic_fetch_add(waiting, 1, __ATOMIC_SEQ_CST);
+
+  for (;;) {
+    r = send
+      ? k_mailbox_ring_put(mailbox, message)
+      : k_mailbox_ring_get(mailbox, message);
     if (r != K_ERR_AGAIN)
       break;
 
-    r = _k_sched_sleep(&mailbox->senders,
+    r = _k_sched_sleep(queue,
                        options & K_SLEEP_UNWAKEABLE
                         ? K_TASK_STATE_SLEEP_UNWAKEABLE
                         : K_TASK_STATE_SLEEP,
@@ -249,29 +266,106 @@ k_mailbox_timed_send(struct KMailBox *mailbox,
       break;
   }
 
-  k_spinlock_release(&mailbox->lock);
+  __atomic_fetch_sub(waiting, 1, __ATOMIC_RELAXED);
 
-  // TODO: check reschedule
+  k_spinlock_release(&mailbox->lock);
 
   return r;
 }
 
+// Wake up one task sleeping on the given queue after a successful ring
+// operation. The common case with no sleepers takes no locks.
+static void
+k_mailbox_wakeup(struct KMailBox *mailbox,
+                 struct KListLink *queue,
+                 volatile int *waiting)
+{
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+  if (__atomic_load_n(waiting, __ATOMIC_RELAXED) == 0)
+    return;
+
+  k_spinlock_acquire(&mailbox->lock);
+  _k_sched_wakeup_one(queue, 0);
+  k_spinlock_release(&mailbox->lock);
+
+  _k_sched_preempt();
+}
+
+// Slot layout: the sequence number followed by the message data. A slot at
+// position pos is free for the sender when seq == pos, and contains a message
+// for the receiver when seq == pos + 1 (a bounded MPMC queue by D. Vyukov).
+#define K_MAILBOX_SLOT(mailbox, pos) \
+  ((mailbox)->buf + ((pos) & ((mailbox)->capacity - 1)) * (mailbox)->slot_size)
+
+static int
+k_mailbox_ring_get(struct KMailBox *mailbox, void *message)
+{
+  k_size_t pos, seq;
+  k_uint8_t *slot;
+  long diff;
+
+  pos = __atomic_load_n(&mailbox->head, __ATOMIC_RELAXED);
+
+  for (;;) {
+    slot = K_MAILBOX_SLOT(mailbox, pos);
+    seq  = __atomic_load_n((k_size_t *) slot, __ATOMIC_ACQUIRE);
+    diff = (long) (seq - (pos + 1));
+
+    if (diff < 0)
+      return K_ERR_AGAIN;
+
+    if (diff == 0) {
+      // On failure, pos is updated with the current value
+      if (__atomic_compare_exchange_n(&mailbox->head, &pos, pos + 1, 0,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        break;
+    } else {
+      // Another receiver has already taken this slot
+      pos = __atomic_load_n(&mailbox->head, __ATOMIC_RELAXED);
+    }
+  }
+
+  k_memmove(message, slot + sizeof(k_size_t), mailbox->msg_size);
+
+  // Free the slot for the sender that wraps around to it
+  __atomic_store_n((k_size_t *) slot, pos + mailbox->capacity,
+                   __ATOMIC_RELEASE);
+
+  return 0;
+}
+
 static int
-k_mailbox_try_send_locked(struct KMailBox *mailbox, const void *message)
+k_mailbox_ring_put(struct KMailBox *mailbox, const void *message)
 {
-  k_assert(k_spinlock_holding(&mailbox->lock));
-  
-  if (mailbox->size == mailbox->capacity)
-    return K_ERR_AGAIN;
-  
-  k_memmove(mailbox->write_ptr, message, mailbox->msg_size);
-
-  mailbox->write_ptr += mailbox->msg_size;
-  if (mailbox->write_ptr >= mailbox->buf_end)
-    mailbox->write_ptr = mailbox->buf_start;
-
-  mailbox->size++;
-  _k_sched_wakeup_one(&mailbox->receivers, 0);
+  k_size_t pos, seq;
+  k_uint8_t *slot;
+  long diff;
+
+  pos = __atomic_load_n(&mailbox->tail, __ATOMIC_RELAXED);
+
+  for (;;) {
+    slot = K_MAILBOX_SLOT(mailbox, pos);
+    seq  = __atomic_load_n((k_size_t *) slot, __ATOMIC_ACQUIRE);
+    diff = (long) (seq - pos);
+
+    if (diff < 0)
+      return K_ERR_AGAIN;
+
+    if (diff == 0) {
+      if (__atomic_compare_exchange_n(&mailbox->tail, &pos, pos + 1, 0,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        break;
+    } else {
+      // Another sender has already taken this slot
+      pos = __atomic_load_n(&mailbox->tail, __ATOMIC_RELAXED);
+    }
+  }
+
+  k_memmove(slot + sizeof(k_size_t), message, mailbox->msg_size);
+
+  // Publish the message
+  __atomic_store_n((k_size_t *) slot, pos + 1, __ATOMIC_RELEASE);
 
   return 0;
 }
@@ -1,4 +1,6 @@
 #include <kernel/core/assert.h>
+#include <kernel/core/cpu.h>
+#include <kernel/core/irq.h>
 #include <kernel/core/mutex.h>
 #include <kernel/core/task.h>
 
@@ -20,6 +22,11 @@ k_mutex_init(struct KMutex *mutex, const char *name)
   mutex->name = name;
   mutex->priority = K_TASK_MAX_PRIORITIES;
   mutex->flags = 0;
+
+#ifdef K_LOCK_STAT
+  mutex->stat = K_NULL;
+  mutex->stat_start = 0;
+#endif
 }
 
 void
@@ -53,6 +60,29 @@ _k_mutex_may_raise_priority(struct KMutex *mutex, int priority)
   }
 }
 
+// Record a successful acquisition started at the given time
+static void
+k_mutex_stat_acquired(struct KMutex *mutex, int contended,
+                      unsigned long long start)
+{
+#ifdef K_LOCK_STAT
+  unsigned long long now;
+
+  mutex->stat_start = 0;
+
+  if ((start != 0) && ((now = _k_lock_stat_clock()) != 0)) {
+    // The task may have migrated to a CPU with a slightly different clock
+    _k_lock_stat_acquired(&mutex->stat, mutex->name, contended,
+                          now > start ? now - start : 0);
+    mutex->stat_start = now;
+  }
+#else
+  (void) mutex;
+  (void) contended;
+  (void) start;
+#endif
+}
+
 static int
 k_mutex_try_lock_locked(struct KMutex *mutex)
 {
@@ -83,14 +113,58 @@ k_mutex_try_lock(struct KMutex *mutex)
   k_assert(k_task_current() != K_NULL);
 
   _k_sched_lock();
-  r = k_mutex_try_lock_locked(mutex);
+
+  if ((r = k_mutex_try_lock_locked(mutex)) == 0)
+    k_mutex_stat_acquired(mutex, 0, _k_lock_stat_clock());
+
   _k_sched_unlock();
 
   return r;
 }
 
+// Busy-wait while the mutex owner is running on another CPU, since it is likely
+// to release the mutex soon. Returns non-zero if the caller should retry
+// locking the mutex, or zero if it should go to sleep.
+static int
+k_mutex_spin_on_owner(struct KMutex *mutex, int *budget)
+{
+  struct KTask *my_task = k_task_current();
+  struct KTask *owner = mutex->owner;
+
+  // A running owner is always on another CPU, since we are running here
+  if ((*budget <= 0) || (owner->state != K_TASK_STATE_RUNNING))
+    return 0;
+
+  // Keep interrupts disabled so the current task is not preempted while the
+  // scheduler lock is dropped. The owner may exit right after releasing the
+  // mutex, in which case its state is read from freed memory once. This is
+  // harmless, since kernel memory is never unmapped.
+  k_irq_state_save();
+  _k_sched_unlock();
+
+  while ((*budget)-- > 0) {
+    if ((*(struct KTask *volatile *) &mutex->owner != owner) ||
+        (*(volatile int *) &owner->state != K_TASK_STATE_RUNNING))
+      break;
+
+    k_arch_cpu_relax();
+  }
+
+  _k_sched_lock();
+  k_irq_state_restore();
+
+  // Higher-priority tasks woken up by the owner must get the mutex first
+  if (mutex->owner == K_NULL)
+    return mutex->priority >= my_task->priority;
+
+  return mutex->owner != owner;
+}
+
 /**
  * Acquire the mutex.
+ *
+ * If the mutex is held by a task running on another CPU, spin for a while
+ * before going to sleep.
  * 
  * @param lock A pointer to the mutex to be acquired.
  */
@@ -98,13 +172,23 @@ int
 _k_mutex_timed_lock(struct KMutex *mutex, k_tick_t timeout)
 {
   struct KTask *my_task = k_task_current();
+  unsigned long long start = _k_lock_stat_clock();
+  int spin_budget = K_MUTEX_SPIN_MAX;
+  int contended = 0;
   int r;
 
   while ((r = k_mutex_try_lock_locked(mutex)) != 0) {
     if (r != K_ERR_AGAIN)
       break;
 
-    _k_mutex_may_raise_priority(mutex, my_task->priority);
+    contended = 1;
+
+    if (k_mutex_spin_on_owner(mutex, &spin_budget))
+      continue;
+
+    // The owner may have released the mutex while we were spinning
+    if (mutex->owner != K_NULL)
+      _k_mutex_may_raise_priority(mutex, my_task->priority);
 
     my_task->sleep_on_mutex = mutex;
     r = _k_sched_sleep(&mutex->queue, K_TASK_STATE_SLEEP, timeout, K_NULL);
@@ -114,6 +198,9 @@ _k_mutex_timed_lock(struct KMutex *mutex, k_tick_t timeout)
       break;
   }
 
+  if (r == 0)
+    k_mutex_stat_acquired(mutex, contended, start);
+
   return r;
 }
 
@@ -175,6 +262,10 @@ _k_mutex_recalc_priority(struct KMutex *mutex)
 void
 _k_mutex_unlock(struct KMutex *mutex)
 {
+#ifdef K_LOCK_STAT
+  _k_lock_stat_released(mutex->stat, mutex->stat_start);
+#endif
+
   k_list_remove(&mutex->link);
   mutex->owner = K_NULL;
   
@@ -197,6 +288,7 @@ k_mutex_unlock(struct KMutex *mutex)
   _k_sched_lock();
 
   _k_mutex_unlock(mutex);
+  _k_sched_may_yield();
 
   _k_sched_unlock();
 
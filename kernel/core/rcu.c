@@ -0,0 +1,141 @@
+#include <kernel/core/assert.h>
+#include <kernel/core/rcu.h>
+#include <kernel/core/spinlock.h>
+#include <kernel/core/timer.h>
+
+#include "core_private.h"
+
+// Callbacks queued since the current grace period has started
+static K_LIST_DECLARE(k_rcu_next);
+// Callbacks waiting for the current grace period to end
+static K_LIST_DECLARE(k_rcu_wait);
+// Quiescent state counters of all CPUs when the current grace period started
+static unsigned long k_rcu_snapshot[K_CPU_MAX];
+
+static struct KSpinLock k_rcu_lock = K_SPINLOCK_INITIALIZER("k_rcu");
+
+// Checks for the end of the grace period while there are pending callbacks
+static struct KTimer k_rcu_timer;
+
+static void k_rcu_timeout(void *);
+
+void
+_k_rcu_init(void)
+{
+  k_timer_create(&k_rcu_timer, k_rcu_timeout, K_NULL, 1, 0);
+}
+
+/**
+ * @brief Free an object once all current RCU readers have finished.
+ *
+ * The callback is invoked after a grace period, from the timer interrupt
+ * context, so it must not sleep.
+ *
+ * @param head Callback descriptor embedded into the object.
+ * @param func Function to free the object.
+ */
+void
+k_rcu_call(struct KRcuHead *head, void (*func)(struct KRcuHead *))
+{
+  head->func = func;
+  k_list_null(&head->link);
+
+  k_spinlock_acquire(&k_rcu_lock);
+  k_list_add_back(&k_rcu_next, &head->link);
+  k_spinlock_release(&k_rcu_lock);
+
+  // Fails if the timer is already pending, which is fine
+  k_timer_start(&k_rcu_timer);
+}
+
+// Record a quiescent state of the current CPU. Called on each context switch
+// and each interrupt that didn't interrupt another handler
+void
+_k_rcu_quiescent(struct KCpu *my_cpu)
+{
+  my_cpu->rcu_qs_count++;
+}
+
+static void
+k_rcu_list_move(struct KListLink *to, struct KListLink *from)
+{
+  while (!k_list_is_empty(from)) {
+    struct KListLink *link = from->next;
+
+    k_list_remove(link);
+    k_list_add_back(to, link);
+  }
+}
+
+static void
+k_rcu_gp_start(void)
+{
+  int i;
+
+  k_assert(k_spinlock_holding(&k_rcu_lock));
+
+  // Make sure the removals are visible before sampling the counters
+  k_atomic_barrier();
+
+  for (i = 0; i < K_CPU_MAX; i++)
+    k_rcu_snapshot[i] = K_RCU_DEREFERENCE(_k_cpus[i].rcu_qs_count);
+}
+
+static int
+k_rcu_gp_done(void)
+{
+  int i;
+
+  k_assert(k_spinlock_holding(&k_rcu_lock));
+
+  k_atomic_barrier();
+
+  for (i = 0; i < K_CPU_MAX; i++) {
+    struct KCpu *cpu = &_k_cpus[i];
+
+    if (K_RCU_DEREFERENCE(cpu->rcu_qs_count) != k_rcu_snapshot[i])
+      continue;
+
+    // The CPU is idle (or offline) and doesn't run any readers
+    if (K_RCU_DEREFERENCE(cpu->task) == K_NULL)
+      continue;
+
+    return 0;
+  }
+
+  return 1;
+}
+
+static void
+k_rcu_timeout(void *)
+{
+  struct KListLink done;
+  int pending;
+
+  k_list_init(&done);
+
+  k_spinlock_acquire(&k_rcu_lock);
+
+  if (!k_list_is_empty(&k_rcu_wait) && k_rcu_gp_done())
+    k_rcu_list_move(&done, &k_rcu_wait);
+
+  // Start a new grace period for the callbacks that arrived meanwhile
+  if (k_list_is_empty(&k_rcu_wait) && !k_list_is_empty(&k_rcu_next)) {
+    k_rcu_list_move(&k_rcu_wait, &k_rcu_next);
+    k_rcu_gp_start();
+  }
+
+  pending = !k_list_is_empty(&k_rcu_wait);
+
+  k_spinlock_release(&k_rcu_lock);
+
+  while (!k_list_is_empty(&done)) {
+    struct KRcuHead *head = K_CONTAINER_OF(done.next, struct KRcuHead, link);
+
+    k_list_remove(&head->link);
+    head->func(head);
+  }
+
+  if (pending)
+    k_timer_start(&k_rcu_timer);
+}
@@ -12,11 +12,32 @@
 
 void k_arch_switch(struct Context **, struct Context *);
 
-K_LIST_DECLARE(_k_sched_timeouts);
+struct KTimeoutQueue _k_sched_timeouts;
 
-static struct KListLink sched_queue[K_TASK_MAX_PRIORITIES];
 struct KSpinLock _k_sched_spinlock = K_SPINLOCK_INITIALIZER("sched");
 
+// CPUs that have entered the scheduler loop
+static unsigned long k_sched_online_cpus;
+
+// Weight of a nice-0 fair task
+#define K_SCHED_NICE_0_WEIGHT   1024
+// Virtual runtime consumed by a nice-0 fair task in one tick
+#define K_SCHED_VRUNTIME_TICK   1024ULL
+
+// Weights of fair tasks for each nice value from K_TASK_NICE_MIN up to
+// K_TASK_NICE_MAX. Each step changes the share of the CPU time by about 10%.
+static const unsigned long
+k_sched_nice_weights[K_TASK_NICE_MAX - K_TASK_NICE_MIN + 1] = {
+  /* -20 */ 88761, 71755, 56483, 46273, 36291,
+  /* -15 */ 29154, 23254, 18705, 14949, 11916,
+  /* -10 */  9548,  7620,  6100,  4904,  3906,
+  /*  -5 */  3121,  2501,  1991,  1586,  1277,
+  /*   0 */  1024,   820,   655,   526,   423,
+  /*   5 */   335,   272,   215,   172,   137,
+  /*  10 */   110,    87,    70,    56,    45,
+  /*  15 */    36,    29,    23,    18,    15,
+};
+
 /**
  * Initialize the scheduler data structures.
  * 
@@ -25,59 +46,329 @@ struct KSpinLock _k_sched_spinlock = K_SPINLOCK_INITIALIZER("sched");
 void
 k_sched_init(void)
 {
-  int i;
+  int i, j;
+
+  for (i = 0; i < K_CPU_MAX; i++) {
+    struct KCpu *cpu = &_k_cpus[i];
+
+    k_spinlock_init(&cpu->run_queue_lock, "run_queue");
+    for (j = 0; j < K_TASK_MAX_PRIORITIES; j++)
+      k_list_init(&cpu->run_queue[j]);
+    cpu->run_queue_size = 0;
+  }
+
+  _k_timeout_queue_init(&_k_sched_timeouts);
+  _k_timer_init();
+  _k_rcu_init();
+}
 
-  for (i = 0; i < K_TASK_MAX_PRIORITIES; i++)
-    k_list_init(&sched_queue[i]);
+// Lock the run queue the given task belongs to. The task may be concurrently
+// stolen by another CPU, so retry until the queue doesn't change under us.
+static struct KCpu *
+k_sched_lock_task_queue(struct KTask *task)
+{
+  for (;;) {
+    struct KCpu *cpu = task->last_cpu;
+
+    k_spinlock_acquire(&cpu->run_queue_lock);
+    if (task->last_cpu == cpu)
+      return cpu;
+    k_spinlock_release(&cpu->run_queue_lock);
+  }
+}
+
+// Check whether the task is allowed to run on the given CPU
+static inline int
+k_sched_cpu_allowed(struct KTask *task, struct KCpu *cpu)
+{
+  return (task->affinity & K_CPU_MASK(cpu - _k_cpus)) != 0;
+}
+
+// Select the least loaded CPU the task is allowed to run on, preferring those
+// that are already running the scheduler
+static struct KCpu *
+k_sched_select_cpu(struct KTask *task)
+{
+  unsigned long mask = task->affinity & k_sched_online_cpus;
+  struct KCpu *cpu, *best;
+
+  k_assert(k_spinlock_holding(&_k_sched_spinlock));
+
+  // The allowed CPUs may not have started yet
+  if (mask == 0)
+    mask = task->affinity;
+
+  // The queue sizes are read without any locks held, the result is only a hint
+  best = K_NULL;
+  for (cpu = _k_cpus; cpu < &_k_cpus[K_CPU_MAX]; cpu++) {
+    if (!(mask & K_CPU_MASK(cpu - _k_cpus)))
+      continue;
+    if ((best == K_NULL) || (cpu->run_queue_size < best->run_queue_size))
+      best = cpu;
+  }
+
+  k_assert(best != K_NULL);
+
+  return best;
+}
+
+// Fair tasks share a single priority level (unless their priority is raised
+// by a mutex they own)
+static inline int
+k_sched_is_fair(struct KTask *task)
+{
+  return task->priority == K_TASK_FAIR_PRIORITY;
+}
+
+// Check whether the given task should preempt the running one
+static int
+k_sched_should_preempt(struct KTask *task, struct KTask *current)
+{
+  int cmp = _k_sched_priority_cmp(task, current);
+
+  if (cmp != 0)
+    return cmp > 0;
+
+  if (!k_sched_is_fair(task))
+    return 0;
+
+  return task->vruntime + K_SCHED_FAIR_GRANULARITY * K_SCHED_VRUNTIME_TICK <
+         current->vruntime;
+}
+
+// Advance the virtual runtime of the CPU to the smallest virtual runtime among
+// its fair tasks, but never move it backwards
+static void
+k_sched_update_min_vruntime(struct KCpu *cpu, struct KTask *current)
+{
+  struct KListLink *queue = &cpu->run_queue[K_TASK_FAIR_PRIORITY];
+  unsigned long long vruntime = current->vruntime;
+
+  k_assert(k_spinlock_holding(&cpu->run_queue_lock));
+
+  if (!k_list_is_empty(queue)) {
+    struct KTask *first = K_CONTAINER_OF(queue->next, struct KTask, link);
+
+    if (first->vruntime < vruntime)
+      vruntime = first->vruntime;
+  }
+
+  if (vruntime > cpu->fair_min_vruntime)
+    cpu->fair_min_vruntime = vruntime;
+}
+
+// Insert the task into the run queue of the given CPU. Real-time tasks are
+// placed after all other tasks with the same priority, while fair tasks are
+// sorted by their virtual runtime.
+static void
+k_sched_queue_add(struct KCpu *cpu, struct KTask *task)
+{
+  struct KListLink *queue = &cpu->run_queue[task->priority];
+  unsigned long long credit;
+  struct KListLink *l;
+
+  k_assert(k_spinlock_holding(&cpu->run_queue_lock));
+
+  if (!k_sched_is_fair(task)) {
+    k_list_add_back(queue, &task->link);
+    return;
+  }
+
+  // Do not let a task that has been sleeping for a long time monopolize the
+  // CPU, but give it a small credit so it can preempt CPU-bound tasks
+  credit = K_SCHED_FAIR_GRANULARITY * K_SCHED_VRUNTIME_TICK;
+  if ((cpu->fair_min_vruntime > credit) &&
+      (task->vruntime < cpu->fair_min_vruntime - credit))
+    task->vruntime = cpu->fair_min_vruntime - credit;
+
+  K_LIST_FOREACH(queue, l) {
+    struct KTask *other = K_CONTAINER_OF(l, struct KTask, link);
+
+    if (other->vruntime > task->vruntime)
+      break;
+  }
+
+  // Insert before the first task with a larger virtual runtime
+  k_list_add_back(l, &task->link);
 }
 
-// Add the specified task to the run queue with the corresponding priority
+// Add the specified task to the run queue with the corresponding priority.
+// The task is placed on the queue of the CPU it last ran on to keep its cache
+// footprint warm; newly created tasks start on the current CPU. If the task is
+// not allowed to run there, the least loaded of the allowed CPUs is chosen.
 void
-_k_sched_enqueue(struct KTask *th)
+_k_sched_enqueue(struct KTask *task)
 {
+  struct KCpu *cpu, *my_cpu;
+  int preempt, kick, stealable;
+
   if (!k_spinlock_holding(&_k_sched_spinlock))
     k_panic("scheduler not locked");
 
-  th->state = K_TASK_STATE_READY;
-  k_list_add_back(&sched_queue[th->priority], &th->link);
+  my_cpu = _k_cpu();
+
+  // The task is not on any run queue, so nobody can steal it right now
+  if (task->last_cpu == K_NULL)
+    task->last_cpu = my_cpu;
+  if (!k_sched_cpu_allowed(task, task->last_cpu))
+    task->last_cpu = k_sched_select_cpu(task);
+  cpu = task->last_cpu;
+
+  k_spinlock_acquire(&cpu->run_queue_lock);
+
+  task->state = K_TASK_STATE_READY;
+  k_sched_queue_add(cpu, task);
+  cpu->run_queue_size++;
+
+  // Ask a lower-priority task running there to give up the CPU
+  preempt = (cpu->task != K_NULL) && (cpu->task != task) &&
+            k_sched_should_preempt(task, cpu->task);
+  if (preempt)
+    cpu->task->flags |= K_TASK_FLAG_RESCHEDULE;
+
+  // Another CPU must be interrupted to notice the request, or to leave the
+  // idle loop if it has nothing to run
+  kick = (cpu != my_cpu) && (preempt || (cpu->task == K_NULL));
+
+  // If another task keeps running there, an idle CPU could pick this one sooner
+  stealable = (cpu->task != K_NULL) && (cpu->task != task) && !preempt;
+
+  k_spinlock_release(&cpu->run_queue_lock);
+
+  if (kick)
+    k_arch_cpu_ipi(cpu - _k_cpus);
+  if (stealable)
+    _k_tick_wakeup();
 }
 
-// Retrieve the highest-priority task from the run queue
+// Move a ready task into the run queue matching its (updated) priority
+static void
+k_sched_requeue(struct KTask *task)
+{
+  struct KCpu *cpu = k_sched_lock_task_queue(task);
+
+  // The task may have been picked up by a scheduler before we got the lock
+  if (task->state == K_TASK_STATE_READY) {
+    k_list_remove(&task->link);
+    k_sched_queue_add(cpu, task);
+  }
+
+  k_spinlock_release(&cpu->run_queue_lock);
+}
+
+// Retrieve the highest-priority task from the run queue of the given CPU that
+// is not still being switched out on another processor and is allowed to run
+// on my_cpu
 static struct KTask *
-k_sched_dequeue(void)
+k_sched_queue_take(struct KCpu *cpu, struct KCpu *my_cpu)
 {
   struct KListLink *link;
   int i;
-  
-  if (!k_spinlock_holding(&_k_sched_spinlock))
-    k_panic("scheduler not locked");
+
+  k_assert(k_spinlock_holding(&cpu->run_queue_lock));
 
   for (i = 0; i < K_TASK_MAX_PRIORITIES; i++) {
-    if (!k_list_is_empty(&sched_queue[i])) {
-      link = sched_queue[i].next;
+    K_LIST_FOREACH(&cpu->run_queue[i], link) {
+      struct KTask *task = K_CONTAINER_OF(link, struct KTask, link);
+
+      if ((task->cpu != K_NULL) || !k_sched_cpu_allowed(task, my_cpu))
+        continue;
+
       k_list_remove(link);
+      cpu->run_queue_size--;
 
-      return K_CONTAINER_OF(link, struct KTask, link);
+      return task;
     }
   }
 
   return K_NULL;
 }
 
-static void
-k_sched_switch(struct KTask *task)
+// Try to take a ready task from the busiest of the other CPUs. Called with the
+// run queue lock of my_cpu held; the lock is still held on return.
+static struct KTask *
+k_sched_steal(struct KCpu *my_cpu)
 {
-  struct KCpu *my_cpu = _k_cpu();
+  struct KCpu *cpu, *victim;
+  struct KTask *task;
+
+  // Look for a victim without any locks held, the result is only a hint
+  victim = K_NULL;
+  for (cpu = _k_cpus; cpu < &_k_cpus[K_CPU_MAX]; cpu++) {
+    if ((cpu == my_cpu) || (cpu->run_queue_size == 0))
+      continue;
+    if ((victim == K_NULL) || (cpu->run_queue_size > victim->run_queue_size))
+      victim = cpu;
+  }
 
+  if (victim == K_NULL)
+    return K_NULL;
+
+  // Always lock two run queues in the same order to avoid deadlocks
+  k_spinlock_release(&my_cpu->run_queue_lock);
+
+  if (victim < my_cpu) {
+    k_spinlock_acquire(&victim->run_queue_lock);
+    k_spinlock_acquire(&my_cpu->run_queue_lock);
+  } else {
+    k_spinlock_acquire(&my_cpu->run_queue_lock);
+    k_spinlock_acquire(&victim->run_queue_lock);
+  }
+
+  if ((task = k_sched_queue_take(victim, my_cpu)) != K_NULL) {
+    task->last_cpu = my_cpu;
+
+    // Keep the virtual runtime relative to the other fair tasks
+    if (task->policy == K_TASK_POLICY_FAIR) {
+      unsigned long long lag = 0;
+
+      if (task->vruntime > victim->fair_min_vruntime)
+        lag = task->vruntime - victim->fair_min_vruntime;
+      task->vruntime = my_cpu->fair_min_vruntime + lag;
+    }
+  }
+
+  k_spinlock_release(&victim->run_queue_lock);
+
+  return task;
+}
+
+// Retrieve the highest-priority task from the local run queue, or steal one
+// from another CPU if there is nothing to run locally
+static struct KTask *
+k_sched_dequeue(struct KCpu *my_cpu)
+{
+  struct KTask *task;
+
+  if ((task = k_sched_queue_take(my_cpu, my_cpu)) != K_NULL)
+    return task;
+
+  return k_sched_steal(my_cpu);
+}
+
+static void
+k_sched_switch(struct KCpu *my_cpu, struct KTask *task)
+{
   task->cpu = my_cpu;
+  task->last_cpu = my_cpu;
   my_cpu->task = task;
 
+  if (task->policy == K_TASK_POLICY_FAIR)
+    k_sched_update_min_vruntime(my_cpu, task);
+
 #ifdef K_ON_SCHED_BEFORE_SWITCH
   K_ON_SCHED_BEFORE_SWITCH(task);
 #endif
 
   task->state = K_TASK_STATE_RUNNING;
 
+#ifdef K_LATENCY_STAT
+  _k_latency_task_running(task);
+#endif
+
+  // The previous task on this CPU is done with any RCU read-side sections
+  _k_rcu_quiescent(my_cpu);
+
   k_arch_switch(&my_cpu->sched_context, task->context);
 
 #ifdef K_ON_SCHED_AFTER_SWITCH
@@ -85,13 +376,15 @@ k_sched_switch(struct KTask *task)
 #endif
 
   my_cpu->task = K_NULL;
+
+  // The task is now completely off this CPU and can be run elsewhere
   task->cpu = K_NULL;
 }
 
 static void
-k_sched_idle(void)
+k_sched_idle(struct KCpu *my_cpu)
 {
-  _k_sched_unlock();
+  k_spinlock_release(&my_cpu->run_queue_lock);
 
   k_irq_enable();
 
@@ -99,9 +392,22 @@ k_sched_idle(void)
   K_ON_SCHED_IDLE();
 #endif
 
-  arch_task_idle();
+  k_irq_disable();
 
-  _k_sched_lock();
+  // Stop the periodic tick first, then check the run queue once more: a task
+  // enqueued before the tick was stopped doesn't kick this CPU
+  _k_tick_idle_enter(my_cpu);
+
+  if (my_cpu->run_queue_size == 0) {
+    arch_task_idle();
+    k_irq_disable();
+  }
+
+  _k_tick_idle_exit(my_cpu);
+
+  k_irq_enable();
+
+  k_spinlock_acquire(&my_cpu->run_queue_lock);
 }
 
 /**
@@ -110,32 +416,62 @@ k_sched_idle(void)
 void
 k_sched_start(void)
 {
+  struct KCpu *my_cpu;
+
+  _k_tick_init_percpu();
+
   _k_sched_lock();
+  k_sched_online_cpus |= K_CPU_MASK(k_cpu_id());
+  _k_sched_unlock();
+
+  k_irq_state_save();
+  my_cpu = _k_cpu();
+  k_spinlock_acquire(&my_cpu->run_queue_lock);
+  k_irq_state_restore();
 
   for (;;) {
-    struct KTask *next = k_sched_dequeue();
+    struct KTask *next = k_sched_dequeue(my_cpu);
 
     if (next != K_NULL) {
       k_assert(next->state == K_TASK_STATE_READY);
-      k_sched_switch(next);
+      k_sched_switch(my_cpu, next);
     } else {
-      k_sched_idle();
+      k_sched_idle(my_cpu);
     }
   }
 }
 
-// Switch back from the current task context back to the scheduler loop
+// Switch back from the current task context back to the scheduler loop.
+//
+// The global scheduler lock protects task states and wait queues, while the
+// switch itself is protected by the run queue lock of the current CPU. The
+// task may be resumed on another CPU, so the run queue lock released after the
+// switch belongs to whichever CPU is running the task by then.
 void
 _k_sched_yield_locked(void)
 {
+  struct KCpu *my_cpu;
   int irq_flags;
 
   if (!k_spinlock_holding(&_k_sched_spinlock))
     k_panic("scheduler not locked");
 
-  irq_flags = _k_cpu()->irq_flags;
-  k_arch_switch(&k_task_current()->context, _k_cpu()->sched_context);
-  _k_cpu()->irq_flags = irq_flags;
+  my_cpu = _k_cpu();
+
+  // Any pending reschedule request is satisfied by this switch
+  my_cpu->task->flags &= ~K_TASK_FLAG_RESCHEDULE;
+
+  k_spinlock_acquire(&my_cpu->run_queue_lock);
+  _k_sched_unlock();
+
+  irq_flags = my_cpu->irq_flags;
+  k_arch_switch(&k_task_current()->context, my_cpu->sched_context);
+
+  my_cpu = _k_cpu();
+  my_cpu->irq_flags = irq_flags;
+
+  k_spinlock_release(&my_cpu->run_queue_lock);
+  _k_sched_lock();
 }
 
 void
@@ -222,8 +558,7 @@ _k_sched_raise_priority(struct KTask *task, int priority)
   switch (task->state) {
   case K_TASK_STATE_READY:
     // Move into another run queue
-    k_list_remove(&task->link);
-    _k_sched_enqueue(task);
+    k_sched_requeue(task);
     break;
   case K_TASK_STATE_SLEEP:
   case K_TASK_STATE_SLEEP_UNWAKEABLE:
@@ -262,8 +597,11 @@ _k_sched_resume(struct KTask *task, int result)
 
   task->sleep_result = result;
 
+#ifdef K_LATENCY_STAT
+  _k_latency_task_woken(task);
+#endif
+
   _k_sched_enqueue(task);
-  //_k_sched_may_yield(task);
 }
 
 // Resume all tasks waiting on the given queue
@@ -302,10 +640,12 @@ _k_sched_wakeup_one_locked(struct KListLink *queue, int result)
   return task;
 }
 
-// Check whether a reschedule is required (taking into account the priority
-// of a task most recently added to the run queue)
+// Yield if a task woken up on this CPU should preempt the current task. The
+// reschedule is delayed until the last call to k_irq_handler_end() if called
+// from an ISR, or until the next interrupt if the caller holds other spinlocks
+// besides the scheduler lock.
 void
-_k_sched_may_yield(struct KTask *task)
+_k_sched_may_yield(void)
 {
   struct KCpu *my_cpu;
   struct KTask *my_task;
@@ -316,16 +656,14 @@ _k_sched_may_yield(struct KTask *task)
   my_cpu = _k_cpu();
   my_task = my_cpu->task;
 
-  if ((my_task != K_NULL) && (_k_sched_priority_cmp(task, my_task) > 0)) {
-    if (my_cpu->lock_count > 0) {
-      // Cannot yield right now, delay until the last call to k_irq_handler_end()
-      // or task_unlock().
-      my_task->flags |= K_TASK_FLAG_RESCHEDULE;
-    } else {
-      _k_sched_enqueue(my_task);
-      _k_sched_yield_locked();
-    }
-  }
+  if ((my_task == K_NULL) || !(my_task->flags & K_TASK_FLAG_RESCHEDULE))
+    return;
+
+  if ((my_cpu->lock_count > 0) || (my_cpu->irq_save_count > 1))
+    return;
+
+  _k_sched_enqueue(my_task);
+  _k_sched_yield_locked();
 }
 
 void
@@ -340,18 +678,47 @@ k_task_timeout_callback(struct KTimeoutEntry *entry)
   }
 }
 
+// Called on each tick to charge the current task for the CPU time used and to
+// check whether it should give way to another task
 void
 _k_sched_check_quantum(void)
 {
-  struct KTask *current_task = k_task_current();
+  struct KCpu *my_cpu;
+  struct KTask *task;
 
-  // Tell the scheduler that the current task has used up its time slice
-  // TODO: add support for other sheduling policies
-  if (current_task != K_NULL) {
-    _k_sched_lock();
-    current_task->flags |= K_TASK_FLAG_RESCHEDULE;
+  _k_sched_lock();
+
+  my_cpu = _k_cpu();
+
+  if ((task = my_cpu->task) == K_NULL) {
     _k_sched_unlock();
+    return;
   }
+
+  if (task->policy == K_TASK_POLICY_FAIR) {
+    struct KListLink *queue = &my_cpu->run_queue[K_TASK_FAIR_PRIORITY];
+
+    task->vruntime += K_SCHED_VRUNTIME_TICK * K_SCHED_NICE_0_WEIGHT /
+                      k_sched_nice_weights[task->nice - K_TASK_NICE_MIN];
+
+    k_spinlock_acquire(&my_cpu->run_queue_lock);
+
+    k_sched_update_min_vruntime(my_cpu, task);
+
+    // Give way to a fair task that has received less CPU time
+    if (k_sched_is_fair(task) && !k_list_is_empty(queue) &&
+        k_sched_should_preempt(K_CONTAINER_OF(queue->next, struct KTask, link),
+                               task))
+      task->flags |= K_TASK_FLAG_RESCHEDULE;
+
+    k_spinlock_release(&my_cpu->run_queue_lock);
+  } else if ((task->policy == K_TASK_POLICY_RR) && (--task->timeslice <= 0)) {
+    // Move behind the other tasks with the same priority
+    task->timeslice = K_SCHED_RR_QUANTUM;
+    task->flags |= K_TASK_FLAG_RESCHEDULE;
+  }
+
+  _k_sched_unlock();
 }
 
 void
@@ -362,6 +729,116 @@ _k_sched_adjust_timeouts(k_tick_t delta_tick)
   _k_sched_unlock();
 }
 
+k_tick_t
+_k_sched_next_timeout(void)
+{
+  k_tick_t ticks;
+
+  _k_sched_lock();
+  ticks = _k_timeout_queue_next(&_k_sched_timeouts);
+  _k_sched_unlock();
+
+  return ticks;
+}
+
+// Change the base priority of a task. The effective priority may still remain
+// higher due to the mutexes owned by the task.
+void
+_k_sched_set_priority(struct KTask *task, int priority)
+{
+  int effective;
+
+  k_assert(k_spinlock_holding(&_k_sched_spinlock));
+
+  task->saved_priority = priority;
+
+  effective = _k_mutex_get_highest_priority(&task->owned_mutexes);
+  if (effective > priority)
+    effective = priority;
+
+  if (effective == task->priority)
+    return;
+
+  if (effective < task->priority) {
+    _k_sched_raise_priority(task, effective);
+    return;
+  }
+
+  task->priority = effective;
+
+  switch (task->state) {
+  case K_TASK_STATE_READY:
+    k_sched_requeue(task);
+    break;
+  case K_TASK_STATE_RUNNING:
+    // Let a higher-priority task run instead
+    task->flags |= K_TASK_FLAG_RESCHEDULE;
+    if (task->cpu != _k_cpu())
+      k_arch_cpu_ipi(task->cpu - _k_cpus);
+    break;
+  case K_TASK_STATE_SLEEP:
+  case K_TASK_STATE_SLEEP_UNWAKEABLE:
+    if (task->sleep_on_mutex != K_NULL) {
+      // Re-insert to update priority
+      k_list_remove(&task->link);
+      _k_sched_add(&task->sleep_on_mutex->queue, task);
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+// Change the set of CPUs a task is allowed to run on. A ready task is moved
+// to another run queue immediately, while a running task is asked to give up
+// the CPU and is moved by the next reschedule.
+int
+_k_sched_set_affinity(struct KTask *task, unsigned long mask)
+{
+  struct KCpu *cpu;
+
+  k_assert(k_spinlock_holding(&_k_sched_spinlock));
+
+  // Once the scheduler is started, at least one allowed CPU must be online
+  mask &= K_CPU_MASK_ALL;
+  if ((mask == 0) ||
+      ((k_sched_online_cpus != 0) && !(mask & k_sched_online_cpus)))
+    return K_ERR_INVAL;
+
+  task->affinity = mask;
+
+  switch (task->state) {
+  case K_TASK_STATE_READY:
+    cpu = k_sched_lock_task_queue(task);
+
+    // The task may have been picked up by a scheduler before we got the lock
+    if ((task->state == K_TASK_STATE_READY) &&
+        !k_sched_cpu_allowed(task, cpu)) {
+      k_list_remove(&task->link);
+      cpu->run_queue_size--;
+
+      k_spinlock_release(&cpu->run_queue_lock);
+
+      _k_sched_enqueue(task);
+    } else {
+      k_spinlock_release(&cpu->run_queue_lock);
+    }
+    break;
+  case K_TASK_STATE_RUNNING:
+    if (!k_sched_cpu_allowed(task, task->cpu)) {
+      task->flags |= K_TASK_FLAG_RESCHEDULE;
+      if (task->cpu != _k_cpu())
+        k_arch_cpu_ipi(task->cpu - _k_cpus);
+    }
+    break;
+  default:
+    // Sleeping and suspended tasks are placed when they become ready
+    break;
+  }
+
+  return 0;
+}
+
 void
 _k_sched_update_effective_priority(void)
 {
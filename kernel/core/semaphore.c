@@ -55,7 +55,7 @@ k_semaphore_destroy(struct KSemaphore *sem)
 
   sem->type = 0;
 
-  // TODO: check reschedule
+  _k_sched_preempt();
 }
 
 /**
@@ -172,7 +172,7 @@ k_semaphore_put(struct KSemaphore *sem)
 
   k_spinlock_release(&sem->lock);
 
-  // TODO: check reschedule
+  _k_sched_preempt();
 
   return 0;
 }
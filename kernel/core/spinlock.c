@@ -19,6 +19,16 @@ k_spinlock_print_callstack(struct KSpinLock *spin)
 #endif
 }
 
+// The lock is held if some ticket has been taken but not released yet
+static inline int
+k_spinlock_is_locked(struct KSpinLock *spin)
+{
+  unsigned locked = spin->locked;
+
+  return ((locked >> K_SPINLOCK_TICKET_SHIFT) & K_SPINLOCK_OWNER_MASK) !=
+         (locked & K_SPINLOCK_OWNER_MASK);
+}
+
 /**
  * @brief Initialize a spinlock.
  *
@@ -34,6 +44,11 @@ k_spinlock_init(struct KSpinLock *spin, const char *name)
   spin->locked = 0;
   spin->cpu = K_NULL;
   spin->name = name;
+
+#ifdef K_LOCK_STAT
+  spin->stat = K_NULL;
+  spin->stat_start = 0;
+#endif
 }
 
 /**
@@ -48,6 +63,11 @@ k_spinlock_init(struct KSpinLock *spin, const char *name)
 void
 k_spinlock_acquire(struct KSpinLock *spin)
 {
+#ifdef K_LOCK_STAT
+  unsigned long long start, now;
+  int contended;
+#endif
+
 #ifndef K_NDEBUG
   if (k_spinlock_holding(spin)) {
     k_spinlock_print_callstack(spin);
@@ -57,10 +77,27 @@ k_spinlock_acquire(struct KSpinLock *spin)
 
   k_irq_state_save();
 
+#ifdef K_LOCK_STAT
+  contended = k_spinlock_is_locked(spin);
+  start = _k_lock_stat_clock();
+#endif
+
   k_arch_spinlock_acquire(&spin->locked);
 
   spin->cpu = _k_cpu();
-  k_arch_spinlock_save_callstack(spin);
+  k_arch_save_callstack(spin->pcs, K_SPINLOCK_MAX_PCS);
+
+#ifdef K_LATENCY_STAT
+  _k_latency_lock_acquired(spin);
+#endif
+
+#ifdef K_LOCK_STAT
+  spin->stat_start = 0;
+  if ((start != 0) && ((now = _k_lock_stat_clock()) != 0)) {
+    _k_lock_stat_acquired(&spin->stat, spin->name, contended, now - start);
+    spin->stat_start = now;
+  }
+#endif
 }
 
 /**
@@ -85,6 +122,14 @@ k_spinlock_release(struct KSpinLock *spin)
   }
 #endif
 
+#ifdef K_LOCK_STAT
+  _k_lock_stat_released(spin->stat, spin->stat_start);
+#endif
+
+#ifdef K_LATENCY_STAT
+  _k_latency_lock_released();
+#endif
+
   spin->cpu = K_NULL;
   spin->pcs[0] = 0;
 
@@ -109,7 +154,7 @@ k_spinlock_holding(struct KSpinLock *spin)
   int r;
 
   k_irq_state_save();
-  r = spin->locked && (spin->cpu == _k_cpu());
+  r = k_spinlock_is_locked(spin) && (spin->cpu == _k_cpu());
   k_irq_state_restore();
 
   return r;
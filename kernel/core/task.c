@@ -29,7 +29,7 @@ k_task_resume(struct KTask *task)
   k_assert(k_list_is_null(&task->link));
 
   _k_sched_enqueue(task);
-  _k_sched_may_yield(task);
+  _k_sched_may_yield();
 
   _k_sched_unlock();
 
@@ -61,8 +61,8 @@ k_task_run(void)
 {
   struct KTask *my_task = k_task_current();
 
-  // Still holding the scheduler lock (acquired in k_sched_start)
-  _k_sched_unlock();
+  // Still holding the run queue lock (acquired in k_sched_start)
+  k_spinlock_release(&_k_cpu()->run_queue_lock);
 
   k_irq_enable();
 
@@ -92,7 +92,9 @@ k_task_wake(struct KTask *task)
  * @param process  Pointer to a process the task belongs to.
  * @param task   Pointer to the kernel task to be initialized.
  * @param entry    task entry point function.
- * @param priority task priority value.
+ * @param priority task priority value. Tasks with priorities below
+ *                 K_TASK_FAIR_PRIORITY are scheduled round-robin, all other
+ *                 tasks belong to the fair class.
  * @param stack    Top of the task stack.
  * 
  * @return 0 on success.
@@ -108,9 +110,23 @@ k_task_create(struct KTask *task,
   k_list_null(&task->link);
   task->sleep_on_mutex     = K_NULL;
 
+  task->cpu            = K_NULL;
+  task->last_cpu       = K_NULL;
   task->flags          = 0;
+
+  if (priority < K_TASK_FAIR_PRIORITY) {
+    task->policy = K_TASK_POLICY_RR;
+  } else {
+    task->policy = K_TASK_POLICY_FAIR;
+    priority     = K_TASK_FAIR_PRIORITY;
+  }
+
   task->saved_priority = priority;
   task->priority       = priority;
+  task->nice           = 0;
+  task->timeslice      = K_SCHED_RR_QUANTUM;
+  task->vruntime       = 0;
+  task->affinity       = K_CPU_MASK_ALL;
   task->state          = K_TASK_STATE_SUSPENDED;
   task->entry          = entry;
   task->arg            = arg;
@@ -118,6 +134,10 @@ k_task_create(struct KTask *task,
   task->ext            = ext;
   task->kstack         = stack;
   task->kstack_size    = stack_size;
+#ifdef K_LATENCY_STAT
+  task->wakeup_time        = 0;
+  task->wakeup_latency_max = 0;
+#endif
 
   _k_timeout_create(&task->timer);
 
@@ -126,6 +146,152 @@ k_task_create(struct KTask *task,
   return 0;
 }
 
+/**
+ * Change the scheduling policy of a task.
+ *
+ * @param task     Pointer to the kernel task.
+ * @param policy   The new scheduling policy.
+ * @param priority The new priority of a real-time task (must be below
+ *                 K_TASK_FAIR_PRIORITY). Ignored for the fair policy.
+ *
+ * @return 0 on success, K_ERR_INVAL if the arguments are invalid.
+ */
+int
+k_task_set_policy(struct KTask *task, int policy, int priority)
+{
+  switch (policy) {
+  case K_TASK_POLICY_FAIR:
+    priority = K_TASK_FAIR_PRIORITY;
+    break;
+  case K_TASK_POLICY_FIFO:
+  case K_TASK_POLICY_RR:
+    if ((priority < 0) || (priority >= K_TASK_FAIR_PRIORITY))
+      return K_ERR_INVAL;
+    break;
+  default:
+    return K_ERR_INVAL;
+  }
+
+  _k_sched_lock();
+
+  task->policy    = policy;
+  task->timeslice = K_SCHED_RR_QUANTUM;
+  _k_sched_set_priority(task, priority);
+
+  _k_sched_may_yield();
+
+  _k_sched_unlock();
+
+  return 0;
+}
+
+/**
+ * Get the scheduling policy of a task.
+ *
+ * @param task     Pointer to the kernel task.
+ * @param policy   Pointer to store the scheduling policy.
+ * @param priority Pointer to store the base priority (not including the
+ *                 priority inherited from the owned mutexes).
+ */
+void
+k_task_get_policy(struct KTask *task, int *policy, int *priority)
+{
+  _k_sched_lock();
+
+  if (policy != K_NULL)
+    *policy = task->policy;
+  if (priority != K_NULL)
+    *priority = task->saved_priority;
+
+  _k_sched_unlock();
+}
+
+/**
+ * Change the nice value of a task. The nice value determines the share of the
+ * CPU time given to a task of the fair class.
+ *
+ * @param task Pointer to the kernel task.
+ * @param nice The new nice value.
+ *
+ * @return 0 on success, K_ERR_INVAL if the value is out of range.
+ */
+int
+k_task_set_nice(struct KTask *task, int nice)
+{
+  if ((nice < K_TASK_NICE_MIN) || (nice > K_TASK_NICE_MAX))
+    return K_ERR_INVAL;
+
+  _k_sched_lock();
+  task->nice = nice;
+  _k_sched_unlock();
+
+  return 0;
+}
+
+/**
+ * Get the nice value of a task.
+ *
+ * @param task Pointer to the kernel task.
+ *
+ * @return The nice value.
+ */
+int
+k_task_get_nice(struct KTask *task)
+{
+  int nice;
+
+  _k_sched_lock();
+  nice = task->nice;
+  _k_sched_unlock();
+
+  return nice;
+}
+
+/**
+ * Restrict the set of CPUs a task is allowed to run on.
+ *
+ * If the task is running on a CPU that is not in the mask, it is migrated at
+ * the next reschedule.
+ *
+ * @param task Pointer to the kernel task.
+ * @param mask The mask of allowed CPUs (see K_CPU_MASK).
+ *
+ * @return 0 on success, K_ERR_INVAL if the mask contains no usable CPUs.
+ */
+int
+k_task_set_affinity(struct KTask *task, unsigned long mask)
+{
+  int r;
+
+  _k_sched_lock();
+
+  r = _k_sched_set_affinity(task, mask);
+  _k_sched_may_yield();
+
+  _k_sched_unlock();
+
+  return r;
+}
+
+/**
+ * Get the set of CPUs a task is allowed to run on.
+ *
+ * @param task Pointer to the kernel task.
+ *
+ * @return The mask of allowed CPUs.
+ */
+unsigned long
+k_task_get_affinity(struct KTask *task)
+{
+  unsigned long mask;
+
+  _k_sched_lock();
+  mask = task->affinity;
+  _k_sched_unlock();
+
+  return mask;
+}
+
 /**
  * Destroy the specified task
  */
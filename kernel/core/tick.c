@@ -1,3 +1,5 @@
+#include <kernel/core/atomic.h>
+#include <kernel/core/config.h>
 #include <kernel/core/irq.h>
 #include <kernel/core/cpu.h>
 #include <kernel/core/timer.h>
@@ -11,6 +13,32 @@ static struct KSpinLock k_tick_lock = K_SPINLOCK_INITIALIZER("k_tick");
 static k_tick_t k_tick_counter = 0; // incremented every system tick interrupt
 static k_tick_t k_tick_prev_counter = 0; // used for delta tick calculations
 
+static int k_tick_online_cpus = 0; // CPUs running the scheduler
+static int k_tick_idle_cpus = 0;   // CPUs with the periodic tick stopped
+
+// Set while the master CPU has the tick stopped, so that other CPUs can wait
+// for it to catch up without taking k_tick_lock
+static k_atomic_t k_tick_master_idle = K_ATOMIC_INIT(0);
+
+// Advance the system tick counter and process expired timeouts
+static void
+k_tick_announce(k_tick_t ticks)
+{
+  k_tick_t delta_tick;
+
+  k_spinlock_acquire(&k_tick_lock);
+
+  k_tick_counter += ticks;
+
+  delta_tick = k_tick_counter - k_tick_prev_counter;
+  k_tick_prev_counter = k_tick_counter;
+
+  k_spinlock_release(&k_tick_lock);
+
+  _k_sched_adjust_timeouts(delta_tick);
+  _k_timer_adjust_timeouts(delta_tick);
+}
+
 /**
  * @brief Tick interrupt handler called periodically by the system timer.
  *
@@ -24,26 +52,179 @@ static k_tick_t k_tick_prev_counter = 0; // used for delta tick calculations
 void
 k_tick(void)
 {
-  k_tick_t delta_tick;
+  struct KCpu *my_cpu;
 
   k_assert(!k_arch_irq_is_enabled());
 
+  my_cpu = _k_cpu();
+
+  // Ticks elapsed while idle have already been accounted for on IRQ entry
+  if (my_cpu->tick_resumed) {
+    my_cpu->tick_resumed = 0;
+    return;
+  }
+
   _k_sched_check_quantum();
 
   if (k_cpu_id() != K_CPU_ID_MASTER)
     return;
 
+  k_tick_announce(1);
+}
+
+// Register the current CPU as running the scheduler
+void
+_k_tick_init_percpu(void)
+{
   k_spinlock_acquire(&k_tick_lock);
+  k_tick_online_cpus++;
+  k_spinlock_release(&k_tick_lock);
+}
 
-  k_tick_counter++;
+// Mark the periodic tick on the given CPU as stopped. The master CPU keeps the
+// system time and processes all timeouts, so it can only stop the tick once
+// no other CPU is active to observe the time or to start new timeouts.
+static int
+k_tick_stop(struct KCpu *my_cpu, int is_master)
+{
+  int stopped = 0;
 
-  delta_tick = k_tick_counter - k_tick_prev_counter;
-  k_tick_prev_counter = k_tick_counter;
+  k_spinlock_acquire(&k_tick_lock);
+
+  if (!is_master || (k_tick_idle_cpus == k_tick_online_cpus - 1)) {
+    my_cpu->tick_stopped = 1;
+    k_tick_idle_cpus++;
+    stopped = 1;
+
+    if (is_master)
+      k_atomic_set(&k_tick_master_idle, 1);
+  }
 
   k_spinlock_release(&k_tick_lock);
 
-  _k_sched_adjust_timeouts(delta_tick);
-  _k_timer_adjust_timeouts(delta_tick);
+  return stopped;
+}
+
+// Mark the periodic tick on the given CPU as running again. Returns whether
+// the tick on the master CPU is still stopped.
+static int
+k_tick_start(struct KCpu *my_cpu)
+{
+  int master_stopped;
+
+  k_spinlock_acquire(&k_tick_lock);
+
+  my_cpu->tick_stopped = 0;
+  k_tick_idle_cpus--;
+
+  // The master CPU has already accounted for the elapsed ticks, if any
+  if (my_cpu == &_k_cpus[K_CPU_ID_MASTER])
+    k_atomic_set(&k_tick_master_idle, 0);
+
+  master_stopped = _k_cpus[K_CPU_ID_MASTER].tick_stopped;
+
+  k_spinlock_release(&k_tick_lock);
+
+  return master_stopped;
+}
+
+// Get the number of ticks until the nearest timeout expiry
+static k_tick_t
+k_tick_next_event(void)
+{
+  k_tick_t ticks = K_TICK_IDLE_MAX;
+  k_tick_t next;
+
+  if (((next = _k_sched_next_timeout()) > 0) && (next < ticks))
+    ticks = next;
+  if (((next = _k_timer_next_timeout()) > 0) && (next < ticks))
+    ticks = next;
+
+  return ticks;
+}
+
+/**
+ * @brief Stop the periodic tick before the CPU goes idle.
+ *
+ * Programs the local timer in one-shot mode for the nearest timeout expiry
+ * (on the master CPU) or for `K_TICK_IDLE_MAX` ticks (on other CPUs, which
+ * have no timeouts to process). Any interrupt, including the one-shot timer
+ * itself, brings the CPU back into the periodic mode.
+ *
+ * Must be called with interrupts disabled.
+ *
+ * @param my_cpu The current CPU.
+ */
+void
+_k_tick_idle_enter(struct KCpu *my_cpu)
+{
+  int is_master = (k_cpu_id() == K_CPU_ID_MASTER);
+  k_tick_t ticks;
+
+  k_assert(!k_arch_irq_is_enabled());
+
+  if ((K_TICK_IDLE_MAX < 2) || !k_tick_stop(my_cpu, is_master))
+    return;
+
+  ticks = is_master ? k_tick_next_event() : K_TICK_IDLE_MAX;
+
+  // Nothing to gain if the next tick is needed anyway
+  if ((ticks < 2) || (k_arch_tick_oneshot(ticks) != 0))
+    k_tick_start(my_cpu);
+}
+
+/**
+ * @brief Restart the periodic tick after the CPU leaves the idle state.
+ *
+ * On the master CPU, accounts for all ticks elapsed while idle. Other CPUs
+ * kick the master CPU and wait until it catches up. Timeouts are kept as
+ * deltas, so a timeout started before that would be shortened by the whole
+ * idle period.
+ *
+ * Must be called with interrupts disabled.
+ *
+ * @param my_cpu The current CPU.
+ */
+void
+_k_tick_idle_exit(struct KCpu *my_cpu)
+{
+  k_tick_t ticks;
+
+  k_assert(!k_arch_irq_is_enabled());
+
+  if (!my_cpu->tick_stopped)
+    return;
+
+  ticks = k_arch_tick_periodic();
+
+  if (k_cpu_id() == K_CPU_ID_MASTER) {
+    k_tick_announce(ticks);
+    k_tick_start(my_cpu);
+  } else if (k_tick_start(my_cpu)) {
+    k_arch_tick_kick();
+
+    // Only takes the IPI latency of the master CPU, spin on the flag rather
+    // than on k_tick_lock, which the master CPU needs to catch up
+    while (k_atomic_read(&k_tick_master_idle))
+      k_arch_cpu_relax();
+
+    k_atomic_barrier();
+  }
+}
+
+/**
+ * @brief Let idle CPUs steal a task added to the run queue of a busy CPU.
+ *
+ * Idle CPUs with the periodic tick stopped would otherwise not notice the task
+ * until their next timer event.
+ */
+void
+_k_tick_wakeup(void)
+{
+  // Read without the lock: the caller has just released the run queue lock,
+  // which orders the enqueue before this read
+  if (k_tick_idle_cpus > 0)
+    k_arch_tick_kick();
 }
 
 /**
@@ -1,10 +1,168 @@
 #include "core_private.h"
 
+/*
+ * Timeout queues are hierarchical timing wheels. Level 0 has one slot per
+ * tick, and each slot of level N covers a whole turn of level N-1. An entry
+ * is placed on the lowest level whose range covers its expiry time, so adding
+ * or removing an entry takes constant time. When the lower wheel completes a
+ * turn, the next slot of the upper wheel is cascaded, i.e. its entries are
+ * redistributed to the lower levels.
+ */
+
+#define K_TIMEOUT_WHEEL_MASK  (K_TIMEOUT_WHEEL_SLOTS - 1)
+
+// Maximum delay that fits into the wheel. Entries expiring later are parked on
+// the top level and re-inserted when their slot is cascaded
+#define K_TIMEOUT_WHEEL_MAX \
+  ((1LL << (K_TIMEOUT_WHEEL_BITS * K_TIMEOUT_WHEEL_LEVELS)) - 1)
+
+static inline int
+k_timeout_slot(k_tick_t expires, int level)
+{
+  return (expires >> (K_TIMEOUT_WHEEL_BITS * level)) & K_TIMEOUT_WHEEL_MASK;
+}
+
+// Put the entry into the slot matching its expiry time
+static void
+k_timeout_queue_insert(struct KTimeoutQueue *queue, struct KTimeoutEntry *entry)
+{
+  k_tick_t delta = entry->expires - queue->now;
+  k_tick_t expires = entry->expires;
+  int level;
+
+  if (delta > K_TIMEOUT_WHEEL_MAX)
+    expires = queue->now + K_TIMEOUT_WHEEL_MAX;
+
+  for (level = 0; level < K_TIMEOUT_WHEEL_LEVELS - 1; level++)
+    if (delta < (1LL << (K_TIMEOUT_WHEEL_BITS * (level + 1))))
+      break;
+
+  entry->level = level;
+  queue->level_size[level]++;
+
+  k_list_add_back(&queue->slots[level][k_timeout_slot(expires, level)],
+                  &entry->link);
+}
+
+// Take the entry out of its slot
+static void
+k_timeout_queue_unlink(struct KTimeoutQueue *queue, struct KTimeoutEntry *entry)
+{
+  queue->level_size[entry->level]--;
+  k_list_remove(&entry->link);
+}
+
+// Redistribute entries from the current slot of the given level to the lower
+// levels. Returns whether the upper levels should be cascaded as well.
+static int
+k_timeout_queue_cascade(struct KTimeoutQueue *queue, int level)
+{
+  struct KListLink *slot;
+  struct KListLink work_list;
+  int index;
+
+  index = k_timeout_slot(queue->now, level);
+  slot  = &queue->slots[level][index];
+
+  // Entries parked beyond the wheel range may land in the same slot again
+  k_list_init(&work_list);
+  while (!k_list_is_empty(slot)) {
+    struct KListLink *link = slot->next;
+
+    k_list_remove(link);
+    k_list_add_back(&work_list, link);
+  }
+
+  while (!k_list_is_empty(&work_list)) {
+    struct KTimeoutEntry *entry;
+
+    entry = K_CONTAINER_OF(work_list.next, struct KTimeoutEntry, link);
+
+    k_list_remove(&entry->link);
+    queue->level_size[level]--;
+
+    k_timeout_queue_insert(queue, entry);
+  }
+
+  return index == 0;
+}
+
+// Advance the queue time by one tick and process the expired entries
+static void
+k_timeout_queue_tick(struct KTimeoutQueue *queue,
+                     void (*callback)(struct KTimeoutEntry *))
+{
+  struct KListLink *slot;
+  int level;
+
+  queue->now++;
+
+  for (level = 1; level < K_TIMEOUT_WHEEL_LEVELS; level++)
+    if ((k_timeout_slot(queue->now, level - 1) != 0) ||
+        !k_timeout_queue_cascade(queue, level))
+      break;
+
+  // New entries never go into the current slot, since they expire at least
+  // one tick later. The callback may modify the queue, so re-read the slot
+  // head every time.
+  slot = &queue->slots[0][k_timeout_slot(queue->now, 0)];
+
+  while (!k_list_is_empty(slot)) {
+    struct KTimeoutEntry *entry;
+
+    entry = K_CONTAINER_OF(slot->next, struct KTimeoutEntry, link);
+    k_assert(entry->expires == queue->now);
+
+    k_timeout_queue_unlink(queue, entry);
+
+    callback(entry);
+  }
+}
+
+// Get the number of ticks that can be skipped without anything to expire or
+// to cascade, up to the given limit
+static k_tick_t
+k_timeout_queue_idle_ticks(struct KTimeoutQueue *queue, k_tick_t limit)
+{
+  k_tick_t boundary;
+  int level;
+
+  for (level = 0; level < K_TIMEOUT_WHEEL_LEVELS; level++)
+    if (queue->level_size[level] != 0)
+      break;
+
+  if (level == 0)
+    return 0;
+  if (level == K_TIMEOUT_WHEEL_LEVELS)
+    return limit;
+
+  // Nothing happens until the next slot of this level is cascaded
+  boundary = ((queue->now >> (K_TIMEOUT_WHEEL_BITS * level)) + 1)
+             << (K_TIMEOUT_WHEEL_BITS * level);
+
+  return boundary - queue->now - 1 < limit ? boundary - queue->now - 1 : limit;
+}
+
+void
+_k_timeout_queue_init(struct KTimeoutQueue *queue)
+{
+  int i, j;
+
+  for (i = 0; i < K_TIMEOUT_WHEEL_LEVELS; i++) {
+    for (j = 0; j < K_TIMEOUT_WHEEL_SLOTS; j++)
+      k_list_init(&queue->slots[i][j]);
+    queue->level_size[i] = 0;
+  }
+
+  queue->now = 0;
+}
+
 void
 _k_timeout_create(struct KTimeoutEntry *entry)
 {
   k_list_null(&entry->link);
-  entry->remain = 0;
+  entry->expires = 0;
+  entry->level = 0;
 }
 
 void
@@ -14,95 +172,110 @@ _k_timeout_destroy(struct KTimeoutEntry *entry)
 }
 
 void
-_k_timeout_queue_add(struct KListLink *queue,
+_k_timeout_queue_add(struct KTimeoutQueue *queue,
                      struct KTimeoutEntry *entry,
                      k_tick_t delay)
 {
-  struct KListLink *next_link;
-
   k_assert(delay > 0);
 
-  entry->remain = delay;
-
-  K_LIST_FOREACH(queue, next_link) {
-    struct KTimeoutEntry *next_entry;
-    
-    next_entry = K_CONTAINER_OF(next_link, struct KTimeoutEntry, link);
+  entry->expires = queue->now + delay;
 
-    if (next_entry->remain > entry->remain) {
-      next_entry->remain -= entry->remain;
-      break;
-    }
+  k_timeout_queue_insert(queue, entry);
+}
 
-    entry->remain -= next_entry->remain;
-  }
+void
+_k_timeout_queue_remove(struct KTimeoutQueue *queue,
+                        struct KTimeoutEntry *entry)
+{
+  k_assert(entry->link.next != K_NULL);
 
-  k_list_add_back(next_link, &entry->link);
+  k_timeout_queue_unlink(queue, entry);
 }
 
-void
-_k_timeout_queue_remove(struct KListLink *queue, struct KTimeoutEntry *entry)
+// Postpone all pending entries by the given number of ticks. This is a rare
+// event (the system time has been set back), so simply reinsert everything.
+static void
+k_timeout_queue_postpone(struct KTimeoutQueue *queue, k_tick_t ticks)
 {
-  struct KListLink *next_link = entry->link.next;
+  struct KListLink work_list;
+  int level, i;
 
-  k_assert(next_link != K_NULL);
+  k_list_init(&work_list);
 
-  k_list_remove(&entry->link);
+  for (level = 0; level < K_TIMEOUT_WHEEL_LEVELS; level++) {
+    for (i = 0; i < K_TIMEOUT_WHEEL_SLOTS; i++) {
+      struct KListLink *slot = &queue->slots[level][i];
 
-  if (next_link != queue) {
-    struct KTimeoutEntry *next_entry;
+      while (!k_list_is_empty(slot)) {
+        struct KListLink *link = slot->next;
 
-    next_entry = K_CONTAINER_OF(next_link, struct KTimeoutEntry, link);
-    next_entry->remain += entry->remain;
+        k_list_remove(link);
+        k_list_add_back(&work_list, link);
+      }
+    }
+    queue->level_size[level] = 0;
+  }
+
+  while (!k_list_is_empty(&work_list)) {
+    struct KTimeoutEntry *entry;
+
+    entry = K_CONTAINER_OF(work_list.next, struct KTimeoutEntry, link);
+    k_list_remove(&entry->link);
+
+    entry->expires += ticks;
+    k_timeout_queue_insert(queue, entry);
   }
 }
 
 void
-_k_timeout_queue_adjust(struct KListLink *queue,
+_k_timeout_queue_adjust(struct KTimeoutQueue *queue,
                         void (*callback)(struct KTimeoutEntry *),
                         k_tick_t delta_ticks)
 {
-  struct KListLink *link;
-  struct KTimeoutEntry *entry;
-
-  if (k_list_is_empty(queue) || (delta_ticks == 0))
-    return;
-
-  link = queue->next;
-  entry = K_CONTAINER_OF(link, struct KTimeoutEntry, link);
-
-  k_assert(entry->remain != 0);
-
   if (delta_ticks < 0) {
-    entry->remain -= delta_ticks;
+    k_timeout_queue_postpone(queue, -delta_ticks);
     return;
   }
 
+  // Catch up tick by tick, but skip the stretches where nothing can happen
   while (delta_ticks > 0) {
-    k_tick_t ticks_to_subtract = delta_ticks;
-    
-    if (ticks_to_subtract < entry->remain) {
-      entry->remain -= ticks_to_subtract;
-      break;
-    }
+    k_tick_t idle_ticks = k_timeout_queue_idle_ticks(queue, delta_ticks);
 
-    if (ticks_to_subtract > entry->remain)
-      ticks_to_subtract = entry->remain;
+    queue->now  += idle_ticks;
+    delta_ticks -= idle_ticks;
+
+    if (delta_ticks > 0) {
+      k_timeout_queue_tick(queue, callback);
+      delta_ticks--;
+    }
+  }
+}
 
-    entry->remain -= ticks_to_subtract;
+// Get the number of ticks until the queue has to be processed next (either
+// the first entry expires or an upper level slot has to be cascaded), or 0 if
+// the queue is empty
+k_tick_t
+_k_timeout_queue_next(struct KTimeoutQueue *queue)
+{
+  k_tick_t next = 0;
+  int level, i;
 
-    while (entry->remain == 0) {
-      k_list_remove(link);
+  for (level = 0; level < K_TIMEOUT_WHEEL_LEVELS; level++) {
+    int shift = K_TIMEOUT_WHEEL_BITS * level;
 
-      callback(entry);
+    if (queue->level_size[level] == 0)
+      continue;
 
-      if (k_list_is_empty(queue))
-        return;
+    for (i = 1; i <= K_TIMEOUT_WHEEL_SLOTS; i++) {
+      k_tick_t time = ((queue->now >> shift) + i) << shift;
 
-      link = queue->next;
-      entry = K_CONTAINER_OF(link, struct KTimeoutEntry, link);
+      if (!k_list_is_empty(&queue->slots[level][k_timeout_slot(time, level)])) {
+        if ((next == 0) || (time - queue->now < next))
+          next = time - queue->now;
+        break;
+      }
     }
-
-    delta_ticks -= ticks_to_subtract;
   }
+
+  return next;
 }
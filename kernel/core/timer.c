@@ -17,7 +17,7 @@ enum {
 static void k_timer_enqueue(struct KTimer *, k_tick_t);
 static void k_timer_dequeue(struct KTimer *);
 
-static K_LIST_DECLARE(k_timer_queue);
+static struct KTimeoutQueue k_timer_queue;
 static struct KSpinLock k_timer_lock = K_SPINLOCK_INITIALIZER("k_timer");
 static struct KTimer *k_timer_current;
 
@@ -169,6 +169,12 @@ _k_timer_timeout(struct KTimeoutEntry *entry)
   }
 }
 
+void
+_k_timer_init(void)
+{
+  _k_timeout_queue_init(&k_timer_queue);
+}
+
 void
 _k_timer_adjust_timeouts(k_tick_t ticks)
 {
@@ -177,6 +183,18 @@ _k_timer_adjust_timeouts(k_tick_t ticks)
   k_spinlock_release(&k_timer_lock);
 }
 
+k_tick_t
+_k_timer_next_timeout(void)
+{
+  k_tick_t ticks;
+
+  k_spinlock_acquire(&k_timer_lock);
+  ticks = _k_timeout_queue_next(&k_timer_queue);
+  k_spinlock_release(&k_timer_lock);
+
+  return ticks;
+}
+
 static void
 k_timer_enqueue(struct KTimer *timer, k_tick_t delay)
 {
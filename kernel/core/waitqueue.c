@@ -27,6 +27,7 @@ k_waitqueue_wakeup_one(struct KWaitQueue *chan)
 {
   _k_sched_lock();
   _k_sched_wakeup_one_locked(&chan->head, 0);
+  _k_sched_may_yield();
   _k_sched_unlock();
 }
 
@@ -35,5 +36,6 @@ k_waitqueue_wakeup_all(struct KWaitQueue *chan)
 {
   _k_sched_lock();
   _k_sched_wakeup_all_locked(&chan->head, 0);
+  _k_sched_may_yield();
   _k_sched_unlock();
 }
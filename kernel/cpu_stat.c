@@ -0,0 +1,42 @@
+#include <string.h>
+
+#include <kernel/cpu_stat.h>
+
+K_PERCPU_DEFINE(cpu_stats);
+
+static const char *cpu_stat_names[CPU_STAT_MAX] = {
+  [CPU_STAT_CONTEXT_SWITCHES] = "ctx-switches",
+  [CPU_STAT_SYSCALLS]         = "syscalls",
+  [CPU_STAT_PAGE_FAULTS]      = "page-faults",
+  [CPU_STAT_IPC_MESSAGES]     = "ipc-messages",
+  [CPU_STAT_BUF_HITS]         = "buf-hits",
+  [CPU_STAT_BUF_MISSES]       = "buf-misses",
+  [CPU_STAT_PAGE_ALLOCS]      = "page-allocs",
+  [CPU_STAT_PAGE_REFILLS]     = "page-refills",
+  [CPU_STAT_PAGE_ZERO_HITS]   = "page-zero-hits",
+  [CPU_STAT_PAGE_ZERO_MISSES] = "page-zero-misses",
+};
+
+/**
+ * Get the display name of the given counter.
+ */
+const char *
+cpu_stat_name(int counter)
+{
+  return cpu_stat_names[counter];
+}
+
+/**
+ * Reset the counters of all CPUs.
+ *
+ * The counters are cleared while other CPUs may be updating them, so a few
+ * concurrent events may survive the reset.
+ */
+void
+cpu_stat_reset(void)
+{
+  int cpu;
+
+  for (cpu = 0; cpu < K_CPU_MAX; cpu++)
+    memset(&K_PERCPU_GET(cpu_stats, cpu), 0, sizeof(struct CpuStat));
+}
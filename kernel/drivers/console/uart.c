@@ -2,7 +2,8 @@
 #include <kernel/tty.h>
 #include <kernel/interrupt.h>
 
-static void uart_irq_task(int, void *);
+static int  uart_irq(int, void *);
+static void uart_irq_thread(int, void *);
 
 int
 uart_init(struct Uart *uart, struct UartOps *ops, void *ctx, int irq)
@@ -10,7 +11,10 @@ uart_init(struct Uart *uart, struct UartOps *ops, void *ctx, int irq)
   uart->ops = ops;
   uart->ctx = ctx;
 
-  interrupt_attach_task(irq, uart_irq_task, uart);
+  k_spinlock_init(&uart->rx_lock, "uart_rx");
+  uart->rx_head = uart->rx_tail = 0;
+
+  interrupt_attach_threaded(irq, uart_irq, uart_irq_thread, uart);
 
   return 0;
 }
@@ -41,21 +45,50 @@ uart_putc(struct Uart *uart, int c)
   return 0;
 }
 
-static void
-uart_irq_task(int irq, void *arg)
+// Drain the receive FIFO, so that the line can be unmasked immediately. The
+// characters are passed to the TTY layer later, since it may sleep.
+static int
+uart_irq(int irq, void *arg)
 {
   struct Uart *uart = (struct Uart *) arg;
-
-  char buf[2];
   int c;
 
+  (void) irq;
+
+  k_spinlock_acquire(&uart->rx_lock);
+
   while ((c = uart_getc(uart)) >= 0) {
-    if (c != 0) {
-      buf[0] = c;
-      buf[1] = '\0';
-      tty_process_input(tty_system, buf);
-    }
+    // Drop the character if the bottom half cannot keep up
+    if ((c != 0) && (uart->rx_head - uart->rx_tail < UART_RX_BUF_SIZE))
+      uart->rx_buf[uart->rx_head++ % UART_RX_BUF_SIZE] = c;
   }
 
-  arch_interrupt_unmask(irq);
+  k_spinlock_release(&uart->rx_lock);
+
+  return INTERRUPT_UNMASK | INTERRUPT_WAKE_THREAD;
+}
+
+static void
+uart_irq_thread(int irq, void *arg)
+{
+  struct Uart *uart = (struct Uart *) arg;
+  char buf[2];
+
+  (void) irq;
+
+  for (;;) {
+    k_spinlock_acquire(&uart->rx_lock);
+
+    if (uart->rx_tail == uart->rx_head) {
+      k_spinlock_release(&uart->rx_lock);
+      break;
+    }
+
+    buf[0] = uart->rx_buf[uart->rx_tail++ % UART_RX_BUF_SIZE];
+    buf[1] = '\0';
+
+    k_spinlock_release(&uart->rx_lock);
+
+    tty_process_input(tty_system, buf);
+  }
 }
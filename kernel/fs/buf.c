@@ -1,11 +1,13 @@
 #include <kernel/core/assert.h>
 #include <kernel/dev.h>
 #include <kernel/console.h>
+#include <kernel/cpu_stat.h>
 #include <kernel/fs/buf.h>
 #include <kernel/core/list.h>
 #include <kernel/object_pool.h>
 #include <kernel/core/spinlock.h>
 #include <kernel/page.h>
+#include <kernel/trace.h>
 
 struct KObjectPool *buf_pool;
 
@@ -32,7 +34,15 @@ buf_ctor(void *ptr, size_t)
   k_mutex_init(&buf->_mutex, "buf");
 }
 
-// no buf_dtor since buffers stay in cache forever (for now)
+// no buf_dtor since buffers stay in cache until reclaimed, and the mutex
+// needs no cleanup
+
+static unsigned buf_cache_shrink(unsigned);
+
+static struct PageShrinker buf_cache_shrinker = {
+  .name   = "buf_cache",
+  .shrink = buf_cache_shrink,
+};
 
 void
 buf_init(void)
@@ -47,6 +57,8 @@ buf_init(void)
 
   k_spinlock_init(&buf_cache.lock, "buf_cache");
   k_list_init(&buf_cache.head);
+
+  page_shrinker_register(&buf_cache_shrinker);
 }
 
 static uint8_t *
@@ -150,6 +162,48 @@ buf_cache_grow(unsigned block_no, size_t block_size, dev_t dev)
   return buf;
 }
 
+// Free the least recently used unreferenced buffers. Such buffers are never
+// dirty, since the data is written when the buffer is released
+static unsigned
+buf_cache_shrink(unsigned nr_pages)
+{
+  struct KListLink freed, *l;
+  size_t bytes = 0;
+
+  k_list_init(&freed);
+
+  k_spinlock_acquire(&buf_cache.lock);
+
+  for (l = buf_cache.head.prev;
+       (l != &buf_cache.head) && (bytes < nr_pages * PAGE_SIZE); ) {
+    struct Buf *buf = K_CONTAINER_OF(l, struct Buf, _cache_link);
+
+    l = l->prev;
+
+    if (buf->_ref_count != 0)
+      continue;
+
+    k_list_remove(&buf->_cache_link);
+    k_list_add_back(&freed, &buf->_cache_link);
+    buf_cache.size--;
+
+    bytes += buf->block_size;
+  }
+
+  k_spinlock_release(&buf_cache.lock);
+
+  while (!k_list_is_empty(&freed)) {
+    struct Buf *buf = K_CONTAINER_OF(freed.next, struct Buf, _cache_link);
+
+    k_list_remove(&buf->_cache_link);
+
+    buf_free_data(buf->data, buf->block_size);
+    k_object_pool_put(buf_pool, buf);
+  }
+
+  return bytes / PAGE_SIZE;
+}
+
 static struct Buf *
 buf_cache_lookup(unsigned block_no, size_t block_size, dev_t dev, struct Buf **unused_store)
 {
@@ -261,8 +315,12 @@ buf_read(unsigned block_no, size_t block_size, dev_t dev)
   buf_assert(buf);
 
   // If needed, read the block contents.
-  if (!(buf->_flags & BUF_FLAGS_VALID))
+  if (!(buf->_flags & BUF_FLAGS_VALID)) {
+    cpu_stat_inc(CPU_STAT_BUF_MISSES);
     buf_request(buf, BUF_REQUEST_READ);
+  } else {
+    cpu_stat_inc(CPU_STAT_BUF_HITS);
+  }
   
   // TODO: check error
   buf->_flags |= BUF_FLAGS_VALID;
@@ -332,5 +390,7 @@ buf_request(struct Buf *buf, int type)
 
   buf_request_init(&req, buf, type);
 
+  TRACE(TRACE_BUF_REQUEST_BEGIN, buf->block_no, type);
   dev->request(&req);
+  TRACE(TRACE_BUF_REQUEST_END, buf->block_no, type);
 }
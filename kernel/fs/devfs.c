@@ -30,6 +30,7 @@ static struct DevfsNode {
   { 9, "zero", S_IFCHR | 0666, 0x0202 },
   { 10, "null", S_IFCHR | 0666, 0x0203 },
   { 11, "tty", S_IFCHR | 0666, 0x0300 },
+  { 12, "trace", S_IFCHR | 0600, 0x0400 },
 };
 
 #define NDEV  (sizeof(devices) / sizeof devices[0])
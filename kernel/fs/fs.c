@@ -556,7 +556,7 @@ fs_open(const char *path, int oflag, mode_t mode, struct Connection **file_store
   connection->type         = CONNECTION_TYPE_FILE;
   connection->node         = NULL;
   connection->endpoint     = NULL;
-  connection->ref_count    = 1;
+  k_refcount_init(&connection->ref_count, 1);
 
   flags = FS_LOOKUP_FOLLOW_LINKS;
   if ((oflag & O_EXCL) && (oflag & O_CREAT))
@@ -624,7 +624,7 @@ fs_select(struct Connection *connection, struct timeval *timeout)
 {
   struct IpcMessage msg;
 
-  k_assert(connection->ref_count > 0);
+  k_assert(k_refcount_read(&connection->ref_count) > 0);
   k_assert(connection->type == CONNECTION_TYPE_FILE);
 
   msg.type = IPC_MSG_SELECT;
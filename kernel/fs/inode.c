@@ -49,7 +49,7 @@ fs_inode_get(ino_t ino, dev_t dev)
   K_LIST_FOREACH(&inode_cache.head, l) {
     ip = K_CONTAINER_OF(l, struct Inode, cache_link);
     if ((ip->ino == ino) && (ip->dev == dev)) {
-      ip->ref_count++;
+      k_refcount_get(&ip->ref_count);
 
       k_spinlock_release(&inode_cache.lock);
 
@@ -58,12 +58,12 @@ fs_inode_get(ino_t ino, dev_t dev)
       return ip;
     }
 
-    if (ip->ref_count == 0)
+    if (k_refcount_read(&ip->ref_count) == 0)
       empty = ip;
   }
 
   if (empty != NULL) {
-    empty->ref_count = 1;
+    k_refcount_init(&empty->ref_count, 1);
     empty->ino       = ino;
     empty->dev       = dev;
     empty->fs        = NULL;
@@ -93,9 +93,7 @@ fs_inode_get(ino_t ino, dev_t dev)
 struct Inode *
 fs_inode_duplicate(struct Inode *inode)
 {
-  k_spinlock_acquire(&inode_cache.lock);
-  inode->ref_count++;
-  k_spinlock_release(&inode_cache.lock);
+  k_refcount_get(&inode->ref_count);
 
   return inode;
 }
@@ -119,14 +117,8 @@ fs_inode_put(struct Inode *inode)
   // If the link count reaches zero, delete inode from the filesystem before
   // returning it to the cache
   if ((inode->flags & FS_INODE_VALID) && (inode->nlink == 0)) {
-    int ref_count;
-
-    k_spinlock_acquire(&inode_cache.lock);
-    ref_count = inode->ref_count;
-    k_spinlock_release(&inode_cache.lock);
-
     // If this is the last reference to this inode
-    if (ref_count == 1) {
+    if (k_refcount_read(&inode->ref_count) == 1) {
       // TODO: process_current?
       inode->fs->ops->inode_delete(process_current(), inode);
       inode->flags &= ~FS_INODE_VALID;
@@ -135,9 +127,13 @@ fs_inode_put(struct Inode *inode)
 
   k_mutex_unlock(&inode->mutex);
 
-  // Return the inode to the cache
+  if (!k_refcount_put(&inode->ref_count))
+    return;
+
+  // Return the inode to the cache. It might have been reused by fs_inode_get()
+  // in the meantime, then leave it alone.
   k_spinlock_acquire(&inode_cache.lock);
-  if (--inode->ref_count == 0) {
+  if (k_refcount_read(&inode->ref_count) == 0) {
     // cprintf("[inode drop %d]\n", inode->ino);
     // cprintf("put %d -> %p\n", inode->ino, inode);
 
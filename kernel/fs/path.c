@@ -48,15 +48,17 @@ fs_path_node_create(const char *name,
   node->mounted_connection = NULL;
   node->mounted_ino = 0;
   node->parent = parent;
-  node->ref_count++;
+  k_refcount_get(&node->ref_count);
 
   if (parent != NULL) {
     k_spinlock_acquire(&fs_path_lock);
   
-    parent->ref_count++;
+    k_refcount_get(&parent->ref_count);
     
-    k_list_add_front(&parent->children, &node->siblings);
-    node->ref_count++;
+    // Account for the parent's reference before the node becomes visible to
+    // lookups
+    k_refcount_get(&node->ref_count);
+    k_list_add_front_rcu(&parent->children, &node->siblings);
 
     k_spinlock_release(&fs_path_lock);
   }
@@ -70,25 +72,35 @@ fs_path_node_remove(struct PathNode *path)
   k_spinlock_acquire(&fs_path_lock);
 
   if (path->parent) {
-    path->parent->ref_count--;
+    k_refcount_dec(&path->parent->ref_count);
     path->parent = NULL;
   }
 
-  k_list_remove(&path->siblings);
-  path->ref_count--;
+  k_list_remove_rcu(&path->siblings);
+  k_refcount_dec(&path->ref_count);
 
   k_spinlock_release(&fs_path_lock);
 }
 
+// Return the node to the pool once no lookups can be looking at it
+static void
+fs_path_node_free(struct KRcuHead *head)
+{
+  struct PathNode *node = K_CONTAINER_OF(head, struct PathNode, rcu);
+
+  k_list_null(&node->siblings);
+  k_object_pool_put(fs_path_pool, node);
+}
+
 struct PathNode *
 fs_path_node_ref(struct PathNode *node)
 {
   k_assert(node != NULL);
-  k_assert(node->ref_count > 0);
+  k_assert(k_refcount_read(&node->ref_count) > 0);
 
-  k_spinlock_acquire(&fs_path_lock);
-  node->ref_count++;
-  k_spinlock_release(&fs_path_lock);
+  // The caller already holds a reference, so the node cannot be freed
+  // concurrently
+  k_refcount_get(&node->ref_count);
 
   return node;
 }
@@ -96,11 +108,16 @@ fs_path_node_ref(struct PathNode *node)
 void
 fs_path_node_unref(struct PathNode *path)
 {
+  // Fast path: at least one more reference besides the parent's one remains,
+  // so the node stays in use
+  if (k_refcount_put_above(&path->ref_count, 1))
+    return;
+
   k_spinlock_acquire(&fs_path_lock);
 
-  path->ref_count--;
+  k_refcount_dec(&path->ref_count);
 
-  if ((path->ref_count == 0) && (path->parent != NULL))
+  if ((k_refcount_read(&path->ref_count) == 0) && (path->parent != NULL))
     k_panic("path in bad state");
 
   // Move up the tree and remove all unused nodes. A node is considered unused
@@ -108,19 +125,22 @@ fs_path_node_unref(struct PathNode *path)
   // a) the reference count is 0
   // b) the reference count is 1, and it's referenced only by the parent node
   // TODO: parent of unmounted entry??
-  while ((path != NULL) && (path->ref_count < 2)) {
+  while (path != NULL) {
     struct PathNode *parent = path->parent;
 
-    k_assert(path->ref_count >= 0);
+    k_assert(k_refcount_read(&path->ref_count) >= 0);
 
-    if ((path->ref_count == 1) && (parent == NULL))
-      // Only one link left, and this is not the parent node
-      break;
+    if (parent == NULL) {
+      // Not reachable by lookups, so nobody can take a new reference
+      if (k_refcount_read(&path->ref_count) != 0)
+        break;
+    } else {
+      // Drop the parent's reference, unless a concurrent lookup has just
+      // taken another one
+      if (!k_refcount_put_if_one(&path->ref_count))
+        break;
 
-    if (parent) {
-      k_assert(path->ref_count == 1);
-      k_list_remove(&path->siblings);
-      path->ref_count--;
+      k_list_remove_rcu(&path->siblings);
     }
 
     k_spinlock_release(&fs_path_lock);
@@ -134,12 +154,12 @@ fs_path_node_unref(struct PathNode *path)
 
     path->ino = 0;
 
-    k_object_pool_put(fs_path_pool, path);
+    k_rcu_call(&path->rcu, fs_path_node_free);
     
     k_spinlock_acquire(&fs_path_lock);
 
     if (parent)
-      parent->ref_count--;
+      k_refcount_dec(&parent->ref_count);
 
     path = parent;
   }
@@ -167,7 +187,7 @@ fs_path_ino(struct PathNode *node, struct Connection **connectionp)
 void
 fs_path_node_lock(struct PathNode *node)
 {
-  k_assert((node->ref_count != 1) || (node->parent == NULL));
+  k_assert((k_refcount_read(&node->ref_count) != 1) || (node->parent == NULL));
 
   if (k_mutex_lock(&node->mutex) < 0)
     k_panic("lock");
@@ -176,7 +196,7 @@ fs_path_node_lock(struct PathNode *node)
 void
 fs_path_node_unlock(struct PathNode *node)
 {
-  k_assert((node->ref_count != 1) || (node->parent == NULL));
+  k_assert((k_refcount_read(&node->ref_count) != 1) || (node->parent == NULL));
 
   if (k_mutex_unlock(&node->mutex) < 0)
     k_panic("unlock");
@@ -502,24 +522,23 @@ fs_path_node_lookup_cached(struct PathNode *parent, const char *name)
 {
   struct KListLink *l;
 
-  // TODO: this is a bottleneck! 
-  // if there are many child nodes, comparing all names may take too long, and
-  // we're blocking the entire system. Could we use a per-node mutex instead?
-  // or a hash table?
+  // TODO: if there are many child nodes, comparing all names may take too
+  // long. Could we use a hash table?
 
-  k_spinlock_acquire(&fs_path_lock);
+  k_rcu_read_lock();
 
-  K_LIST_FOREACH(&parent->children, l) {
+  K_LIST_FOREACH_RCU(&parent->children, l) {
     struct PathNode *p = K_CONTAINER_OF(l, struct PathNode, siblings);
     
-    if (strcmp(p->name, name) == 0) {
-      p->ref_count++;
-      k_spinlock_release(&fs_path_lock);
+    // Skip nodes that are being removed
+    if ((strcmp(p->name, name) == 0) &&
+        k_refcount_get_unless_zero(&p->ref_count)) {
+      k_rcu_read_unlock();
       return p;
     }
   }
 
-  k_spinlock_release(&fs_path_lock);
+  k_rcu_read_unlock();
 
   return NULL;
 }
@@ -579,7 +598,7 @@ fs_init(void)
   connection->flags        = 0;
   connection->type         = CONNECTION_TYPE_FILE;
   connection->node         = NULL;
-  connection->ref_count    = 1;
+  k_refcount_init(&connection->ref_count, 1);
 
   
   root_ino = ext2_mount(FS_ROOT_DEV, &fs);
@@ -598,7 +617,7 @@ fs_path_node_ctor(void *ptr, size_t)
 
   node->mounted_connection = NULL;
   node->mounted_ino = 0;
-  node->ref_count = 0;
+  k_refcount_init(&node->ref_count, 0);
   k_list_init(&node->children);
   k_list_null(&node->siblings);
   k_mutex_init(&node->mutex, "path_node");
@@ -610,7 +629,7 @@ fs_path_node_dtor(void *ptr, size_t)
   struct PathNode *node = (struct PathNode *) ptr;
 
   k_assert(node->mounted_connection == NULL);
-  k_assert(node->ref_count == 0);
+  k_assert(k_refcount_read(&node->ref_count) == 0);
   k_assert(k_list_is_empty(&node->children));
   k_assert(k_list_is_empty(&node->siblings));
   k_assert(!k_mutex_holding(&node->mutex));
@@ -657,7 +676,7 @@ fs_path_mount(struct PathNode *node, ino_t ino, struct FS *fs)
   connection->type      = CONNECTION_TYPE_FILE;
   connection->node      = NULL;
   connection->endpoint  = &fs->endpoint;
-  connection->ref_count = 1;
+  k_refcount_init(&connection->ref_count, 1);
 
   node->mounted_ino     = ino;
   node->mounted_connection = connection;
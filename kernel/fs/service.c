@@ -13,6 +13,18 @@
 #include <kernel/vmspace.h>
 #include <kernel/dev.h>
 #include <kernel/hash.h>
+#include <kernel/core/cpu.h>
+
+// CPUs to run the file system service tasks on (e.g. to keep them away from
+// the CPUs running user processes)
+#ifndef FS_SERVICE_CPUS
+#define FS_SERVICE_CPUS   K_CPU_MASK_ALL
+#endif
+
+// Maximum number of service tasks per file system
+#ifndef FS_SERVICE_WORKERS_MAX
+#define FS_SERVICE_WORKERS_MAX  ENDPOINT_WORKERS_MAX
+#endif
 
 // File data
 
@@ -1206,33 +1218,26 @@ fs_dispatch_table[] = {
 
 #define FS_DISPATCH_TABLE_SIZE (int)(sizeof(fs_dispatch_table) / sizeof(fs_dispatch_table[0]))
 
-void
-fs_service_task(void *arg)
+static void
+fs_service_handle(void *arg, struct Request *req)
 {
   struct FS *fs = (struct FS *) arg;
-  struct Request *req;
+  struct IpcMessage msg;
 
-  while (endpoint_receive(&fs->endpoint, &req) >= 0) {
-    struct IpcMessage msg;
-
-    if (request_read(req, &msg, sizeof(msg)) < 0) {
-      request_reply(req, -EFAULT);
-    } else if (msg.type >= 0 && msg.type < FS_DISPATCH_TABLE_SIZE && fs_dispatch_table[msg.type] != NULL) {
-      fs_dispatch_table[msg.type](fs, req, &msg);
-    } else {
-      k_warn("unsupported msg type %d\n", msg.type);
-      request_reply(req, -ENOSYS);
-    }
+  if (request_read(req, &msg, sizeof(msg)) < 0) {
+    request_reply(req, -EFAULT);
+  } else if (msg.type >= 0 && msg.type < FS_DISPATCH_TABLE_SIZE && fs_dispatch_table[msg.type] != NULL) {
+    fs_dispatch_table[msg.type](fs, req, &msg);
+  } else {
+    k_warn("unsupported msg type %d\n", msg.type);
+    request_reply(req, -ENOSYS);
   }
-
-  k_panic("error");
 }
 
 struct FS *
 fs_create_service(char *name, dev_t dev, void *extra, struct FSOps *ops)
 {
   struct FS *fs;
-  int i;
 
   // TODO: move this code out from here
   if (k_list_is_null(&file_hash.table[0])) {
@@ -1248,19 +1253,8 @@ fs_create_service(char *name, dev_t dev, void *extra, struct FSOps *ops)
   fs->extra = extra;
   fs->ops   = ops;
 
-  endpoint_init(&fs->endpoint);
-
-  for (i = 0; i < ENDPOINT_MBOX_CAPACITY; i++) {
-    struct Page *kstack;
-
-    if ((kstack = page_alloc_one(0, 0)) == NULL)
-      k_panic("out of memory");
-
-    kstack->ref_count++;
-
-    k_task_create(&fs->tasks[i], NULL, fs_service_task, fs, page2kva(kstack), PAGE_SIZE, 0);
-    k_task_resume(&fs->tasks[i]);
-  }
+  endpoint_init(&fs->endpoint, name, fs_service_handle, fs, FS_SERVICE_CPUS,
+                FS_SERVICE_WORKERS_MAX);
 
   return fs;
 }
@@ -0,0 +1,304 @@
+/*
+ * Fast user-space mutexes.
+ *
+ * A futex is an aligned int in user memory. User space manipulates it with
+ * atomic instructions and only enters the kernel to sleep until the value
+ * changes (FUTEX_WAIT) or to wake up the sleepers (FUTEX_WAKE).
+ *
+ * Futexes are keyed by the physical page and the offset within it, so tasks
+ * that map the same page at different addresses (or share it after fork())
+ * refer to the same futex. Copy-on-write sharing is broken before computing
+ * the key, since a write would move the word to another page anyway.
+ */
+
+#include <errno.h>
+#include <time.h>
+
+#include <kernel/core/spinlock.h>
+#include <kernel/futex.h>
+#include <kernel/hash.h>
+#include <kernel/page.h>
+#include <kernel/process.h>
+#include <kernel/time.h>
+#include <kernel/vm.h>
+#include <kernel/vmspace.h>
+#include <kernel/waitqueue.h>
+
+#define FUTEX_HASH_SIZE   64
+
+static struct FutexBucket {
+  struct KSpinLock lock;
+  struct KListLink waiters;
+} futex_hash[FUTEX_HASH_SIZE];
+
+// Allocated on the stack of the sleeping task
+struct FutexWaiter {
+  struct KListLink    link;     // Link into the bucket list, NULL if woken
+  struct Page        *page;     // Key: the physical page
+  unsigned            offset;   // Key: the offset within the page
+  struct FutexBucket *bucket;   // Changed by FUTEX_REQUEUE
+  struct KWaitQueue   queue;
+};
+
+void
+futex_init(void)
+{
+  int i;
+
+  for (i = 0; i < FUTEX_HASH_SIZE; i++) {
+    k_spinlock_init(&futex_hash[i].lock, "futex");
+    k_list_init(&futex_hash[i].waiters);
+  }
+}
+
+static struct FutexBucket *
+futex_bucket(struct Page *page, unsigned offset)
+{
+  return &futex_hash[((page2pa(page) + offset) / sizeof(int)) %
+                     FUTEX_HASH_SIZE];
+}
+
+static int
+futex_key(uintptr_t va, struct Page **page_store, unsigned *offset_store)
+{
+  int r;
+
+  if ((r = vm_user_get_word(process_current()->vm->pgtab, va, page_store,
+                            NULL)) < 0)
+    return r;
+
+  *offset_store = va % PAGE_SIZE;
+
+  return 0;
+}
+
+// Wake up the waiter. Must be called with the bucket locked, otherwise the
+// waiter may time out and return, destroying the structure.
+static void
+futex_waiter_wakeup(struct FutexWaiter *waiter)
+{
+  k_list_remove(&waiter->link);
+  k_waitqueue_wakeup_one(&waiter->queue);
+}
+
+// Lock the bucket the waiter is currently in
+static struct FutexBucket *
+futex_waiter_lock(struct FutexWaiter *waiter)
+{
+  struct FutexBucket *bucket;
+
+  for (;;) {
+    bucket = *(struct FutexBucket * volatile *) &waiter->bucket;
+
+    k_spinlock_acquire(&bucket->lock);
+    if (waiter->bucket == bucket)
+      return bucket;
+    k_spinlock_release(&bucket->lock);
+  }
+}
+
+/**
+ * Sleep until woken up by futex_wake() if the futex contains the given value.
+ *
+ * @param va      The user address of the futex.
+ * @param val     The expected value.
+ * @param timeout Relative timeout, or NULL to sleep indefinitely.
+ *
+ * @retval 0          Woken up by futex_wake() or futex_requeue().
+ * @retval -EAGAIN    The futex value does not match.
+ * @retval -ETIMEDOUT The timeout has expired.
+ * @retval -EINTR     The sleep was interrupted by a signal.
+ * @retval -EFAULT    Bad futex address.
+ * @retval -EINVAL    Bad timeout value.
+ */
+int
+futex_wait(uintptr_t va, int val, const struct timespec *timeout)
+{
+  struct FutexWaiter waiter;
+  struct FutexBucket *bucket;
+  struct Page *page;
+  unsigned long ticks = 0;
+  int r, curr;
+
+  if (timeout != NULL) {
+    if ((timeout->tv_sec < 0) ||
+        (timeout->tv_nsec < 0) ||
+        (timeout->tv_nsec >= 1000000000L))
+      return -EINVAL;
+
+    ticks = (timespec2ns(timeout) + NS_PER_TICK - 1) / NS_PER_TICK;
+  }
+
+  if ((r = futex_key(va, &page, &waiter.offset)) < 0)
+    return r;
+
+  for (;;) {
+    bucket = futex_bucket(page, waiter.offset);
+
+    k_spinlock_acquire(&bucket->lock);
+
+    // Read the value with the bucket locked, so that a concurrent waker
+    // cannot miss us after changing it
+    r = vm_user_get_word(process_current()->vm->pgtab, va, &waiter.page,
+                         &curr);
+    if (r < 0) {
+      k_spinlock_release(&bucket->lock);
+      return r;
+    }
+
+    if (waiter.page == page)
+      break;
+
+    // The address has been remapped in the meantime
+    k_spinlock_release(&bucket->lock);
+    page = waiter.page;
+  }
+
+  if (curr != val) {
+    k_spinlock_release(&bucket->lock);
+    return -EAGAIN;
+  }
+
+  if ((timeout != NULL) && (ticks == 0)) {
+    k_spinlock_release(&bucket->lock);
+    return -ETIMEDOUT;
+  }
+
+  waiter.bucket = bucket;
+  k_waitqueue_init(&waiter.queue);
+  k_list_null(&waiter.link);
+  k_list_add_back(&bucket->waiters, &waiter.link);
+
+  r = k_waitqueue_timed_sleep(&waiter.queue, &bucket->lock, ticks);
+
+  // Returns with the original bucket locked, but a requeue may have moved the
+  // waiter to another bucket
+  k_spinlock_release(&bucket->lock);
+  bucket = futex_waiter_lock(&waiter);
+
+  if (k_list_is_null(&waiter.link))
+    r = 0;
+  else
+    k_list_remove(&waiter.link);
+
+  k_spinlock_release(&bucket->lock);
+
+  return r;
+}
+
+// Wake up to max waiters with the given key and move up to max_requeue of the
+// remaining ones to another bucket. The caller must hold both bucket locks.
+static int
+futex_wake_locked(struct FutexBucket *bucket, struct Page *page,
+                  unsigned offset, int max, struct FutexBucket *bucket2,
+                  struct Page *page2, unsigned offset2, int max_requeue)
+{
+  struct KListLink *l, *next;
+  int n = 0;
+
+  for (l = bucket->waiters.next; l != &bucket->waiters; l = next) {
+    struct FutexWaiter *waiter = K_CONTAINER_OF(l, struct FutexWaiter, link);
+
+    next = l->next;
+
+    if ((waiter->page != page) || (waiter->offset != offset))
+      continue;
+
+    if (max > 0) {
+      futex_waiter_wakeup(waiter);
+      max--;
+    } else if (max_requeue > 0) {
+      k_list_remove(&waiter->link);
+
+      waiter->page   = page2;
+      waiter->offset = offset2;
+      waiter->bucket = bucket2;
+      k_list_add_back(&bucket2->waiters, &waiter->link);
+
+      max_requeue--;
+    } else {
+      break;
+    }
+
+    n++;
+  }
+
+  return n;
+}
+
+/**
+ * Wake up tasks waiting on a futex.
+ *
+ * @param va  The user address of the futex.
+ * @param max The maximum number of tasks to wake up.
+ *
+ * @return The number of tasks woken up, or a negative error code.
+ */
+int
+futex_wake(uintptr_t va, int max)
+{
+  struct FutexBucket *bucket;
+  struct Page *page;
+  unsigned offset;
+  int r;
+
+  if ((r = futex_key(va, &page, &offset)) < 0)
+    return r;
+
+  bucket = futex_bucket(page, offset);
+
+  k_spinlock_acquire(&bucket->lock);
+  r = futex_wake_locked(bucket, page, offset, max, NULL, NULL, 0, 0);
+  k_spinlock_release(&bucket->lock);
+
+  return r;
+}
+
+/**
+ * Wake up tasks waiting on a futex and move the remaining ones to another
+ * futex, so that they do not all wake up at once just to sleep again on it
+ * (e.g. to implement a condition variable broadcast).
+ *
+ * @param va          The user address of the futex.
+ * @param max         The maximum number of tasks to wake up.
+ * @param max_requeue The maximum number of tasks to move.
+ * @param va2         The user address of the target futex.
+ *
+ * @return The number of tasks woken up or moved, or a negative error code.
+ */
+int
+futex_requeue(uintptr_t va, int max, int max_requeue, uintptr_t va2)
+{
+  struct FutexBucket *bucket, *bucket2;
+  struct Page *page, *page2;
+  unsigned offset, offset2;
+  int r;
+
+  if ((r = futex_key(va, &page, &offset)) < 0)
+    return r;
+  if ((r = futex_key(va2, &page2, &offset2)) < 0)
+    return r;
+
+  bucket  = futex_bucket(page, offset);
+  bucket2 = futex_bucket(page2, offset2);
+
+  // Always lock the buckets in the same order to avoid deadlocks
+  if (bucket < bucket2) {
+    k_spinlock_acquire(&bucket->lock);
+    k_spinlock_acquire(&bucket2->lock);
+  } else if (bucket > bucket2) {
+    k_spinlock_acquire(&bucket2->lock);
+    k_spinlock_acquire(&bucket->lock);
+  } else {
+    k_spinlock_acquire(&bucket->lock);
+  }
+
+  r = futex_wake_locked(bucket, page, offset, max, bucket2, page2, offset2,
+                        max_requeue);
+
+  if (bucket != bucket2)
+    k_spinlock_release(&bucket2->lock);
+  k_spinlock_release(&bucket->lock);
+
+  return r;
+}
@@ -1,8 +1,13 @@
 #include <kernel/core/task.h>
 
 #include <kernel/console.h>
+#include <kernel/cpu_stat.h>
+#include <kernel/hrtimer.h>
+#include <kernel/ipc.h>
 #include <kernel/kdebug.h>
+#include <kernel/page.h>
 #include <kernel/process.h>
+#include <kernel/trace.h>
 #include <kernel/vmspace.h>
 
 void
@@ -10,6 +15,8 @@ on_task_destroy(struct KTask *task)
 {
   if (task->ext != NULL)
     thread_on_destroy((struct Thread *) task->ext);
+  else
+    endpoint_on_task_destroy(task);
 }
 
 void arch_on_thread_before_switch(struct Thread *);
@@ -18,6 +25,10 @@ void arch_on_thread_after_switch(struct Thread *);
 void
 on_sched_before_switch(struct KTask *task)
 {
+  TRACE_TASK(task, TRACE_SCHED_SWITCH_IN, 0, 0);
+
+  cpu_stat_inc(CPU_STAT_CONTEXT_SWITCHES);
+
   if (task->ext != NULL) {
     struct Thread *thread = (struct Thread *) task->ext;
 
@@ -35,12 +46,16 @@ on_sched_after_switch(struct KTask *task)
   if (task->ext != NULL) {
     arch_on_thread_after_switch((struct Thread *) task->ext);
   }
+
+  TRACE_TASK(task, TRACE_SCHED_SWITCH_OUT, task->state, 0);
 }
 
 void
 on_sched_idle(void)
 {
   thread_idle();
+  endpoint_idle();
+  page_zero_idle();
 }
 
 void
@@ -53,3 +68,9 @@ on_spinlock_debug_pc(k_uintptr_t pc)
           pc,
           info.fn_name, info.file, info.line);
 }
+
+unsigned long long
+on_lock_stat_clock(void)
+{
+  return hrtimer_now();
+}
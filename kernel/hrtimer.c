@@ -0,0 +1,278 @@
+#include <errno.h>
+
+#include <kernel/core/assert.h>
+#include <kernel/core/condvar.h>
+#include <kernel/core/cpu.h>
+#include <kernel/core/mutex.h>
+#include <kernel/core/spinlock.h>
+#include <kernel/hrtimer.h>
+#include <kernel/time.h>
+
+// Active timers of each CPU, sorted by expiration time
+static struct KListLink hrtimer_queues[K_CPU_MAX];
+static struct KSpinLock hrtimer_lock = K_SPINLOCK_INITIALIZER("hrtimer");
+
+// The clock hardware is not usable until the subsystem is initialized
+static int hrtimer_started;
+
+/**
+ * Initialize the high-resolution timer subsystem.
+ */
+void
+hrtimer_init(void)
+{
+  int i;
+
+  for (i = 0; i < K_CPU_MAX; i++)
+    k_list_init(&hrtimer_queues[i]);
+
+  hrtimer_started = 1;
+}
+
+/**
+ * Initialize a high-resolution timer.
+ *
+ * @param timer        Pointer to the timer object to initialize.
+ * @param callback     Function to be invoked (in the interrupt context) when
+ *                     the timer expires.
+ * @param callback_arg Argument passed to the callback function.
+ */
+void
+hrtimer_create(struct HRTimer *timer, void (*callback)(void *),
+               void *callback_arg)
+{
+  k_list_null(&timer->link);
+  timer->expires      = 0;
+  timer->period       = 0;
+  timer->callback     = callback;
+  timer->callback_arg = callback_arg;
+  timer->cpu          = -1;
+  timer->running      = -1;
+  timer->cancelled    = 0;
+}
+
+// Insert the timer into the queue of the given CPU and reprogram the event
+// timer if it becomes the first one to expire
+static void
+hrtimer_enqueue(struct HRTimer *timer, int cpu)
+{
+  struct KListLink *queue = &hrtimer_queues[cpu];
+  struct KListLink *l;
+
+  k_assert(k_spinlock_holding(&hrtimer_lock));
+
+  K_LIST_FOREACH(queue, l) {
+    struct HRTimer *other = K_CONTAINER_OF(l, struct HRTimer, link);
+
+    if (other->expires > timer->expires)
+      break;
+  }
+
+  // Insert before the first timer that expires later
+  k_list_add_back(l, &timer->link);
+  timer->cpu = cpu;
+
+  if ((queue->next == &timer->link) && (cpu == (int) k_cpu_id()))
+    arch_hrtimer_program(timer->expires);
+}
+
+/**
+ * Start a high-resolution timer on the current CPU.
+ *
+ * @param timer   Pointer to the timer object.
+ * @param expires Absolute expiration time, in nanoseconds.
+ * @param period  Reload period in nanoseconds, or 0 for a one-shot timer.
+ *
+ * @retval 0 on success.
+ * @retval -EINVAL if the timer is already active.
+ */
+int
+hrtimer_start(struct HRTimer *timer, uint64_t expires, uint64_t period)
+{
+  k_spinlock_acquire(&hrtimer_lock);
+
+  if (timer->cpu >= 0) {
+    k_spinlock_release(&hrtimer_lock);
+    return -EINVAL;
+  }
+
+  timer->expires   = expires;
+  timer->period    = period;
+  timer->cancelled = 0;
+
+  hrtimer_enqueue(timer, k_cpu_id());
+
+  k_spinlock_release(&hrtimer_lock);
+
+  return 0;
+}
+
+/**
+ * Stop a high-resolution timer.
+ *
+ * If the timer callback is being executed on another CPU, wait until it
+ * completes. Therefore, the caller must not hold any locks acquired by the
+ * callback.
+ *
+ * @param timer Pointer to the timer object.
+ *
+ * @return The number of nanoseconds left until the timer expiration, or 0 if
+ *         the timer was not active.
+ */
+uint64_t
+hrtimer_stop(struct HRTimer *timer)
+{
+  uint64_t remaining = 0;
+
+  k_spinlock_acquire(&hrtimer_lock);
+
+  if (timer->cpu >= 0) {
+    uint64_t now = arch_hrtimer_now();
+
+    // Already expired but not processed yet: report the minimal value
+    remaining = timer->expires > now ? timer->expires - now : 1;
+
+    // Do not bother reprogramming the event timer, a spurious interrupt is
+    // harmless
+    k_list_remove(&timer->link);
+    timer->cpu = -1;
+  }
+
+  if (timer->running >= 0) {
+    timer->cancelled = 1;
+
+    // The callback may also stop the timer itself
+    while ((timer->running >= 0) && (timer->running != (int) k_cpu_id())) {
+      k_spinlock_release(&hrtimer_lock);
+      k_spinlock_acquire(&hrtimer_lock);
+    }
+  }
+
+  k_spinlock_release(&hrtimer_lock);
+
+  return remaining;
+}
+
+/**
+ * Get the current value of the monotonic clock.
+ *
+ * @return The number of nanoseconds since an arbitrary point in the past, or 0
+ *         if the clock is not initialized yet.
+ */
+uint64_t
+hrtimer_now(void)
+{
+  if (!hrtimer_started)
+    return 0;
+
+  return arch_hrtimer_now();
+}
+
+/**
+ * Process expired timers of the current CPU.
+ *
+ * Called by the architecture-specific code from the event timer interrupt
+ * handler.
+ */
+void
+hrtimer_interrupt(void)
+{
+  struct KListLink *queue;
+  int cpu;
+
+  k_spinlock_acquire(&hrtimer_lock);
+
+  cpu   = k_cpu_id();
+  queue = &hrtimer_queues[cpu];
+
+  while (!k_list_is_empty(queue)) {
+    struct HRTimer *timer = K_CONTAINER_OF(queue->next, struct HRTimer, link);
+    uint64_t now = arch_hrtimer_now();
+
+    if (timer->expires > now)
+      break;
+
+    k_list_remove(&timer->link);
+    timer->cpu = -1;
+    timer->running = cpu;
+
+    // The callback may restart or stop the timer
+    k_spinlock_release(&hrtimer_lock);
+    timer->callback(timer->callback_arg);
+    k_spinlock_acquire(&hrtimer_lock);
+
+    if ((timer->period != 0) && !timer->cancelled && (timer->cpu < 0)) {
+      now = arch_hrtimer_now();
+
+      // Skip the periods missed due to a late interrupt
+      timer->expires += timer->period;
+      if (timer->expires <= now)
+        timer->expires += ((now - timer->expires) / timer->period + 1) *
+                          timer->period;
+
+      hrtimer_enqueue(timer, cpu);
+    }
+
+    // Do not touch the timer after this point, hrtimer_stop() may return
+    timer->running = -1;
+  }
+
+  if (!k_list_is_empty(queue))
+    arch_hrtimer_program(K_CONTAINER_OF(queue->next, struct HRTimer,
+                                        link)->expires);
+
+  k_spinlock_release(&hrtimer_lock);
+}
+
+static void
+hrtimer_condvar_notify(void *arg)
+{
+  k_condvar_notify_all((struct KCondVar *) arg);
+}
+
+// Called by k_condvar_timed_wait_hook() with the scheduler locked, so the
+// notification cannot be sent before the task is queued on the condvar. The
+// deadline has been stored into the timer by hrtimer_condvar_timed_wait()
+static void
+hrtimer_condvar_arm(void *arg)
+{
+  struct HRTimer *timer = (struct HRTimer *) arg;
+
+  hrtimer_start(timer, timer->expires, 0);
+}
+
+/**
+ * Wait on a condition variable until the given deadline.
+ *
+ * @param cond     Pointer to the condition variable to wait on.
+ * @param mutex    Pointer to a mutex currently held by the calling task.
+ * @param deadline Absolute wakeup time, in nanoseconds.
+ *
+ * @retval 0 on wakeup before the deadline (the caller should re-check the
+ *         condition).
+ * @retval -ETIMEDOUT if the deadline has passed.
+ * @retval -EINTR if the sleep was interrupted.
+ */
+int
+hrtimer_condvar_timed_wait(struct KCondVar *cond, struct KMutex *mutex,
+                           uint64_t deadline)
+{
+  struct HRTimer timer;
+  int r;
+
+  if (hrtimer_now() >= deadline)
+    return -ETIMEDOUT;
+
+  hrtimer_create(&timer, hrtimer_condvar_notify, cond);
+  timer.expires = deadline;
+
+  r = k_condvar_timed_wait_hook(cond, mutex, 0, 0, hrtimer_condvar_arm,
+                                &timer);
+
+  hrtimer_stop(&timer);
+
+  if ((r == 0) && (hrtimer_now() >= deadline))
+    return -ETIMEDOUT;
+
+  return r;
+}
@@ -0,0 +1,118 @@
+#ifndef __INCLUDE_KERNEL_CORE_ATOMIC_H__
+#define __INCLUDE_KERNEL_CORE_ATOMIC_H__
+
+#include <arch/atomic.h>
+
+/**
+ * @file kernel/core/atomic.h
+ *
+ * Atomic integer operations.
+ *
+ * All read-modify-write operations are full memory barriers, so they can be
+ * used to publish or consume data protected by the atomic value. Plain reads
+ * and writes are not ordered with respect to other memory accesses.
+ */
+
+/**
+ * @brief Atomic integer.
+ */
+typedef struct {
+  volatile int value;
+} k_atomic_t;
+
+/**
+ * @brief Static initializer for an atomic integer.
+ */
+#define K_ATOMIC_INIT(v)  { (v) }
+
+/* -------------------------------------------------------------------------- */
+/*                                 Kernel API                                 */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Read the value of an atomic integer.
+ */
+static inline int
+k_atomic_read(const k_atomic_t *a)
+{
+  return a->value;
+}
+
+/**
+ * @brief Set the value of an atomic integer.
+ */
+static inline void
+k_atomic_set(k_atomic_t *a, int value)
+{
+  a->value = value;
+}
+
+/**
+ * @brief Atomically add to an atomic integer.
+ *
+ * @return The new value.
+ */
+static inline int
+k_atomic_add_return(k_atomic_t *a, int delta)
+{
+  return k_arch_atomic_add_return(&a->value, delta);
+}
+
+/**
+ * @brief Atomically increment an atomic integer.
+ */
+static inline void
+k_atomic_inc(k_atomic_t *a)
+{
+  k_arch_atomic_add_return(&a->value, 1);
+}
+
+/**
+ * @brief Atomically decrement an atomic integer.
+ */
+static inline void
+k_atomic_dec(k_atomic_t *a)
+{
+  k_arch_atomic_add_return(&a->value, -1);
+}
+
+/**
+ * @brief Atomically decrement an atomic integer and test the result.
+ *
+ * @return Non-zero if the new value is zero.
+ */
+static inline int
+k_atomic_dec_and_test(k_atomic_t *a)
+{
+  return k_arch_atomic_add_return(&a->value, -1) == 0;
+}
+
+/**
+ * @brief Atomically replace the value of an atomic integer if it is equal to
+ *        the expected one.
+ *
+ * @param a        Pointer to the atomic integer.
+ * @param expected The expected value.
+ * @param desired  The value to store.
+ *
+ * @return The previous value (equal to `expected` on success).
+ */
+static inline int
+k_atomic_cmpxchg(k_atomic_t *a, int expected, int desired)
+{
+  return k_arch_atomic_cmpxchg(&a->value, expected, desired);
+}
+
+/**
+ * @brief Full memory barrier.
+ *
+ * Memory accesses before the barrier are completed before any memory accesses
+ * after the barrier.
+ */
+static inline void
+k_atomic_barrier(void)
+{
+  k_arch_atomic_barrier();
+}
+
+#endif  // !__INCLUDE_KERNEL_CORE_ATOMIC_H__
@@ -25,6 +25,8 @@ struct KMutex;
 void k_condvar_create(struct KCondVar *);
 void k_condvar_destroy(struct KCondVar *);
 int k_condvar_timed_wait(struct KCondVar *, struct KMutex *, k_tick_t, int);
+int k_condvar_timed_wait_hook(struct KCondVar *, struct KMutex *, k_tick_t,
+                              int, void (*)(void *), void *);
 int k_condvar_notify_one(struct KCondVar *);
 int k_condvar_notify_all(struct KCondVar *);
 
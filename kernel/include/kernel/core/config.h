@@ -53,11 +53,60 @@ typedef uintptr_t   k_uintptr_t;
  */
 #define K_CPU_MAX   4
 
+/**
+ * @brief Size of a CPU cache line, in bytes.
+ *
+ * Per-CPU data is aligned to this boundary, so that updates made by different
+ * CPUs never touch the same cache line.
+ */
+#define K_CACHE_LINE_SIZE  64
+
 /**
  * @brief Maximum number of distinct task priority levels.
  */
 #define K_TASK_MAX_PRIORITIES  (2 * NZERO)
 
+/**
+ * @brief Priority level shared by all tasks of the fair scheduling class.
+ *
+ * Real-time tasks use the levels above it (lower values), so they always
+ * preempt fair tasks. Fair tasks at this level are ordered by their virtual
+ * runtime instead.
+ */
+#define K_TASK_FAIR_PRIORITY   NZERO
+
+/**
+ * @brief Time slice of round-robin real-time tasks, in ticks.
+ */
+#define K_SCHED_RR_QUANTUM     5
+
+/**
+ * @brief Minimum virtual runtime lead, in ticks, for a fair task to preempt
+ *        another fair task.
+ *
+ * Also limits the credit a fair task may accumulate while sleeping.
+ */
+#define K_SCHED_FAIR_GRANULARITY  1
+
+/**
+ * @brief Maximum number of system ticks an idle CPU may skip in a row.
+ *
+ * Instead of taking every periodic tick, an idle CPU programs a one-shot timer
+ * for the nearest timeout expiry, but never further than this many ticks
+ * ahead. Values less than `2` disable tickless idle.
+ */
+#define K_TICK_IDLE_MAX        1000
+
+/**
+ * @brief Maximum number of iterations to spin on a locked mutex.
+ *
+ * A task trying to acquire a mutex whose owner is running on another CPU
+ * busy-waits for up to this many iterations, expecting the owner to release
+ * the mutex soon, before going to sleep. A value of `0` disables adaptive
+ * spinning.
+ */
+#define K_MUTEX_SPIN_MAX       4000
+
 #ifdef NDEBUG
   /**
    * @brief Kernel alias for the standard `NDEBUG` macro.
@@ -72,6 +121,34 @@ typedef uintptr_t   k_uintptr_t;
   #define K_NDEBUG
 #endif
 
+#ifdef LOCKSTAT
+  /**
+   * @brief Enable lock contention statistics.
+   *
+   * When defined, every spinlock and mutex acquisition records how long the
+   * caller had to wait and how long the lock was held. The statistics are
+   * aggregated by lock name and can be retrieved with `k_lock_stat_get()`.
+   */
+  #define K_LOCK_STAT
+#endif
+
+/**
+ * @brief Maximum number of distinct lock names tracked by the lock statistics.
+ */
+#define K_LOCK_STAT_MAX        128
+
+#ifdef LATSTAT
+  /**
+   * @brief Enable latency statistics.
+   *
+   * When defined, the kernel records how long interrupts stay disabled, how
+   * long spinlocks are held (so that the CPU cannot be preempted), and how long
+   * woken up tasks wait before they start running. The statistics can be
+   * retrieved with `k_latency_stat_get()`.
+   */
+  #define K_LATENCY_STAT
+#endif
+
 /* -------------------------------------------------------------------------- */
 /*                      Kernel-level error code aliases                       */
 /* -------------------------------------------------------------------------- */
@@ -124,6 +201,11 @@ typedef uintptr_t   k_uintptr_t;
  */
 #define k_memset      memset
 
+/**
+ * @brief Wrapper around standard string compare function.
+ */
+#define k_strcmp      strcmp
+
 /**
  * @brief Kernel panic macro.
  *
@@ -149,6 +231,7 @@ void on_sched_before_switch(struct KTask *);
 void on_sched_after_switch(struct KTask *);
 void on_sched_idle(void);
 void on_spinlock_debug_pc(k_uintptr_t);
+unsigned long long on_lock_stat_clock(void);
 
 /**
  * @brief Called when a task is destroyed.
@@ -195,4 +278,13 @@ void on_spinlock_debug_pc(k_uintptr_t);
  */
 #define K_ON_SPINLOCK_DEBUG_PC     on_spinlock_debug_pc
 
+/**
+ * @brief Clock source for the lock contention and latency statistics.
+ *
+ * Must return a monotonically increasing time in nanoseconds, or `0` if the
+ * clock is not available yet (the event is not recorded then). Called with
+ * interrupts disabled; locks acquired by the hook are not accounted for.
+ */
+#define K_ON_LOCK_STAT_CLOCK       on_lock_stat_clock
+
 #endif  // !__INCLUDE_KERNEL_CORE_CONFIG_H__
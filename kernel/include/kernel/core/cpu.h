@@ -1,6 +1,8 @@
 #ifndef __INCLUDE_KERNEL_CORE_CPU_H__
 #define __INCLUDE_KERNEL_CORE_CPU_H__
 
+#include <kernel/core/config.h>
+
 /* -------------------------------------------------------------------------- */
 /*                           Architecture Interface                           */
 /* -------------------------------------------------------------------------- */
@@ -18,6 +20,26 @@
  */
 unsigned k_arch_cpu_id(void);
 
+/**
+ * @brief Hint the processor that the caller is in a busy-wait loop
+ *        (architecture-specific).
+ *
+ * Called on each iteration of a spin-wait loop to reduce power consumption
+ * and yield pipeline resources to other hardware threads.
+ */
+void     k_arch_cpu_relax(void);
+
+/**
+ * @brief Send a reschedule interrupt to another CPU (architecture-specific).
+ *
+ * The interrupt must be handled between `k_irq_handler_begin()` and
+ * `k_irq_handler_end()`, so that the target CPU leaves the idle state or
+ * preempts its current task if a reschedule was requested.
+ *
+ * @param cpu_id The ID of the target CPU.
+ */
+void     k_arch_cpu_ipi(unsigned cpu_id);
+
 /* -------------------------------------------------------------------------- */
 /*                                 Kernel API                                 */
 /* -------------------------------------------------------------------------- */
@@ -47,4 +69,18 @@ k_cpu_id(void)
  */
 #define K_CPU_ID_MASTER   0
 
+/**
+ * @brief CPU mask with only the given CPU set.
+ *
+ * CPU masks are used to restrict the set of CPUs a task may run on.
+ *
+ * @param id The zero-based CPU ID.
+ */
+#define K_CPU_MASK(id)    (1UL << (id))
+
+/**
+ * @brief CPU mask with all CPUs set.
+ */
+#define K_CPU_MASK_ALL    (~0UL >> (sizeof(unsigned long) * 8 - K_CPU_MAX))
+
 #endif  // !__INCLUDE_KERNEL_CORE_CPU_H__
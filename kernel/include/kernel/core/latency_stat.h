@@ -0,0 +1,54 @@
+#ifndef __INCLUDE_KERNEL_CORE_LATENCY_STAT_H__
+#define __INCLUDE_KERNEL_CORE_LATENCY_STAT_H__
+
+#include <kernel/core/config.h>
+#include <kernel/core/spinlock.h>
+
+struct KTask;
+
+/**
+ * @brief Number of histogram buckets for each latency type.
+ *
+ * Bucket `i` counts the events that took less than `2^i` microseconds (but
+ * were not counted by the previous bucket); the last bucket counts all longer
+ * events. For speed, a microsecond is approximated by 1024 nanoseconds.
+ */
+#define K_LATENCY_HIST_MAX    16
+
+/**
+ * @brief Latency types.
+ */
+enum {
+  K_LATENCY_IRQS_OFF,     ///< Interrupts disabled by `k_irq_state_save()`
+  K_LATENCY_PREEMPT_OFF,  ///< Spinlocks held, so the task cannot be preempted
+  K_LATENCY_WAKEUP,       ///< From wakeup until the task starts running
+  K_LATENCY_MAX,
+};
+
+/**
+ * @brief Statistics for one latency type.
+ *
+ * All times are in the units of `K_ON_LOCK_STAT_CLOCK` (nanoseconds).
+ */
+struct KLatencyStatInfo {
+  unsigned long       count;      ///< Number of recorded events
+  unsigned long long  total;      ///< Total time
+  unsigned long long  max;        ///< The longest event
+  unsigned            max_cpu;    ///< CPU the longest event happened on
+  /**
+   * Where the longest section has started, or the entry point of the task
+   * (for wakeups)
+   */
+  k_uintptr_t         max_pcs[K_SPINLOCK_MAX_PCS];
+  unsigned long       hist[K_LATENCY_HIST_MAX];
+};
+
+/* -------------------------------------------------------------------------- */
+/*                                 Kernel API                                 */
+/* -------------------------------------------------------------------------- */
+
+int                k_latency_stat_get(int, struct KLatencyStatInfo *);
+void               k_latency_stat_reset(void);
+unsigned long long k_latency_stat_task_max(struct KTask *);
+
+#endif  // !__INCLUDE_KERNEL_CORE_LATENCY_STAT_H__
@@ -0,0 +1,44 @@
+#ifndef __INCLUDE_KERNEL_CORE_LOCK_STAT_H__
+#define __INCLUDE_KERNEL_CORE_LOCK_STAT_H__
+
+#include <kernel/core/config.h>
+
+/**
+ * @brief Contention statistics for all locks sharing the same name.
+ *
+ * Each CPU updates only its own counters (with interrupts disabled), so no
+ * additional synchronization is required to record an event.
+ */
+struct KLockStat {
+  const char           *name;
+  struct {
+    unsigned long       acquired;   ///< Number of acquisitions
+    unsigned long       contended;  ///< Acquisitions that had to wait
+    unsigned long long  wait_total; ///< Total spin/sleep time
+    unsigned long long  wait_max;   ///< Maximum spin/sleep time
+    unsigned long long  hold_max;   ///< Maximum hold time
+  } cpu[K_CPU_MAX];
+};
+
+/**
+ * @brief Summary of the statistics for one lock name.
+ *
+ * All times are in the units of `K_ON_LOCK_STAT_CLOCK` (nanoseconds).
+ */
+struct KLockStatInfo {
+  const char         *name;
+  unsigned long       acquired;
+  unsigned long       contended;
+  unsigned long long  wait_total;
+  unsigned long long  wait_max;
+  unsigned long long  hold_max;
+};
+
+/* -------------------------------------------------------------------------- */
+/*                                 Kernel API                                 */
+/* -------------------------------------------------------------------------- */
+
+int  k_lock_stat_get(struct KLockStatInfo *, int);
+void k_lock_stat_reset(void);
+
+#endif  // !__INCLUDE_KERNEL_CORE_LOCK_STAT_H__
@@ -9,22 +9,44 @@
  *
  * A mailbox provides synchronized message-passing between tasks using a
  * circular buffer. It supports multiple concurrent senders and receivers.
+ *
+ * Messages are stored in a bounded lock-free ring, so a transfer that does not
+ * have to wake up a sleeping task takes no locks at all. The spinlock only
+ * protects the lists of sleeping senders and receivers.
  */
 struct KMailBox {
   int type;
   int flags;
   struct KSpinLock lock;
-  k_uint8_t *buf_start;
-  k_uint8_t *buf_end;
-  k_uint8_t *read_ptr;
-  k_uint8_t *write_ptr;
-  k_size_t size;
+  k_uint8_t *buf;
+  k_size_t slot_size;
   k_size_t capacity;
   k_size_t msg_size;
+  volatile k_size_t head;           ///< Next slot to receive from
+  volatile k_size_t tail;           ///< Next slot to send to
+  volatile int receivers_waiting;   ///< Number of tasks in `receivers`
+  volatile int senders_waiting;     ///< Number of tasks in `senders`
   struct KListLink receivers;
   struct KListLink senders;
 };
 
+/**
+ * @brief Size of a mailbox buffer slot holding one message.
+ *
+ * Each slot stores a sequence number in front of the message data.
+ */
+#define K_MAILBOX_SLOT_SIZE(msg_size) \
+  (sizeof(k_size_t) + \
+   (((msg_size) + sizeof(k_size_t) - 1) & ~(sizeof(k_size_t) - 1)))
+
+/**
+ * @brief Size of a mailbox buffer holding the given number of messages.
+ *
+ * The capacity should be a power of two, otherwise it is rounded down.
+ */
+#define K_MAILBOX_BUF_SIZE(capacity, msg_size) \
+  ((capacity) * K_MAILBOX_SLOT_SIZE(msg_size))
+
 int k_mailbox_create(struct KMailBox *, k_size_t, void *, k_size_t);
 void k_mailbox_destroy(struct KMailBox *);
 int k_mailbox_try_receive(struct KMailBox *, void *);
@@ -6,6 +6,7 @@
 #include <kernel/core/list.h>
 #include <kernel/core/spinlock.h>
 
+struct KLockStat;
 struct KTask;
 
 /**
@@ -28,6 +29,12 @@ struct KMutex {
   int               priority;
   /** Mutex name (for debugging purposes). */
   const char       *name;
+#ifdef K_LOCK_STAT
+  /** Cached contention statistics entry. */
+  struct KLockStat   *stat;
+  /** Time of the last acquisition. */
+  unsigned long long  stat_start;
+#endif
 };
 
 #define K_MUTEX_TYPE    0x4D555458  // {'M','U','T','X'}
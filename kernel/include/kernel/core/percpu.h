@@ -0,0 +1,81 @@
+#ifndef __INCLUDE_KERNEL_CORE_PERCPU_H__
+#define __INCLUDE_KERNEL_CORE_PERCPU_H__
+
+#include <kernel/core/config.h>
+#include <kernel/core/cpu.h>
+
+/**
+ * @file kernel/core/percpu.h
+ *
+ * Per-CPU variables.
+ *
+ * A per-CPU variable has a separate copy for each CPU. Every copy is placed
+ * into its own cache line, so CPUs updating their copies concurrently do not
+ * cause cache line bouncing. A CPU usually accesses only its own copy, with
+ * interrupts disabled, and therefore needs no locks. Other copies may be read
+ * (e.g. to sum up statistics), but the values may be slightly out of date.
+ */
+
+/**
+ * @brief Structure type holding one CPU copy of the given per-CPU variable.
+ */
+#define K_PERCPU_TYPE(name)   struct _k_percpu_##name
+
+#define _K_PERCPU_STRUCT(type, name)                          \
+  K_PERCPU_TYPE(name) {                                       \
+    type value;                                               \
+  } __attribute__((aligned(K_CACHE_LINE_SIZE)))
+
+/**
+ * @brief Declare a per-CPU variable defined in another file.
+ *
+ * The declaration must be visible to the file that defines the variable
+ * using `K_PERCPU_DEFINE()`.
+ *
+ * @param type The type of each CPU copy.
+ * @param name The variable name.
+ */
+#define K_PERCPU_DECLARE(type, name) \
+  extern _K_PERCPU_STRUCT(type, name) name[K_CPU_MAX]
+
+/**
+ * @brief Define a per-CPU variable declared with `K_PERCPU_DECLARE()`.
+ *
+ * @param name The variable name.
+ */
+#define K_PERCPU_DEFINE(name) \
+  K_PERCPU_TYPE(name) name[K_CPU_MAX]
+
+/**
+ * @brief Define a per-CPU variable visible only in the current file.
+ *
+ * @param type The type of each CPU copy.
+ * @param name The variable name.
+ */
+#define K_PERCPU_DEFINE_STATIC(type, name) \
+  static _K_PERCPU_STRUCT(type, name) name[K_CPU_MAX]
+
+/**
+ * @brief Access the copy of a per-CPU variable that belongs to the given CPU.
+ *
+ * @param name The variable name.
+ * @param cpu  The zero-based CPU ID.
+ *
+ * @return An lvalue designating the copy.
+ */
+#define K_PERCPU_GET(name, cpu)   ((name)[cpu].value)
+
+/**
+ * @brief Access the copy of a per-CPU variable that belongs to the current
+ *        CPU.
+ *
+ * The caller must disable interrupts (or otherwise prevent migration to
+ * another CPU) for the duration of the access.
+ *
+ * @param name The variable name.
+ *
+ * @return An lvalue designating the copy.
+ */
+#define K_PERCPU_THIS(name)       K_PERCPU_GET(name, k_cpu_id())
+
+#endif  // !__INCLUDE_KERNEL_CORE_PERCPU_H__
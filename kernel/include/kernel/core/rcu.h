@@ -0,0 +1,143 @@
+#ifndef __INCLUDE_KERNEL_CORE_RCU_H__
+#define __INCLUDE_KERNEL_CORE_RCU_H__
+
+#include <kernel/core/atomic.h>
+#include <kernel/core/irq.h>
+#include <kernel/core/list.h>
+
+/**
+ * @file kernel/core/rcu.h
+ *
+ * Read-copy-update synchronization for read-mostly data.
+ *
+ * Readers traverse the shared data without taking any locks, between
+ * `k_rcu_read_lock()` and `k_rcu_read_unlock()`. Writers still serialize with
+ * each other using an ordinary lock, but an object removed from the shared
+ * data is freed via `k_rcu_call()` only after a grace period, i.e. once every
+ * reader that could have found the object has finished.
+ *
+ * Read-side critical sections run with interrupts disabled, so they must be
+ * short, must never sleep and can only be used by tasks. Thus, each context
+ * switch, as well as each interrupt taken with interrupts enabled, is a
+ * quiescent state in which the CPU cannot hold references to the shared data.
+ * A grace period ends as soon as all CPUs have passed a quiescent state (or
+ * have been idle).
+ */
+
+/**
+ * @brief Callback descriptor embedded into objects freed via `k_rcu_call()`.
+ */
+struct KRcuHead {
+  struct KListLink link;
+  void           (*func)(struct KRcuHead *);
+};
+
+/**
+ * @brief Read a pointer to RCU-protected data.
+ *
+ * Prevents the compiler from caching or refetching the value. Both supported
+ * architectures order dependent loads, so no memory barrier is required.
+ */
+#define K_RCU_DEREFERENCE(p)  (*(__typeof__(p) volatile *) &(p))
+
+/**
+ * @brief Iterate over a list that may be modified concurrently.
+ *
+ * Must be used inside a read-side critical section.
+ *
+ * @param head Pointer to the list head.
+ * @param lp   Loop variable (`struct KListLink *`).
+ */
+#define K_LIST_FOREACH_RCU(head, lp)                                    \
+  for (lp = K_RCU_DEREFERENCE((head)->next);                            \
+       lp != (head);                                                    \
+       lp = K_RCU_DEREFERENCE(lp->next))
+
+/* -------------------------------------------------------------------------- */
+/*                                 Kernel API                                 */
+/* -------------------------------------------------------------------------- */
+
+void k_rcu_call(struct KRcuHead *, void (*)(struct KRcuHead *));
+
+/**
+ * @brief Enter an RCU read-side critical section.
+ *
+ * Critical sections may be nested.
+ */
+static inline void
+k_rcu_read_lock(void)
+{
+  k_irq_state_save();
+}
+
+/**
+ * @brief Leave an RCU read-side critical section.
+ */
+static inline void
+k_rcu_read_unlock(void)
+{
+  k_irq_state_restore();
+}
+
+/**
+ * @brief Insert a link at the front of a list traversed by RCU readers.
+ *
+ * The caller must hold the lock that serializes writers. The link is fully
+ * initialized before it becomes visible to readers.
+ */
+static inline void
+k_list_add_front_rcu(struct KListLink *head, struct KListLink *link)
+{
+  k_assert(k_list_is_null(link));
+
+  link->next = head->next;
+  link->prev = head;
+
+  k_atomic_barrier();
+
+  head->next->prev = link;
+  head->next = link;
+}
+
+/**
+ * @brief Insert a link at the back of a list traversed by RCU readers.
+ *
+ * The caller must hold the lock that serializes writers.
+ */
+static inline void
+k_list_add_back_rcu(struct KListLink *head, struct KListLink *link)
+{
+  k_assert(k_list_is_null(link));
+
+  link->next = head;
+  link->prev = head->prev;
+
+  k_atomic_barrier();
+
+  head->prev->next = link;
+  head->prev = link;
+}
+
+/**
+ * @brief Remove a link from a list traversed by RCU readers.
+ *
+ * The forward pointer is left intact, so readers currently positioned at the
+ * link can continue the traversal. Once a grace period has passed, the link
+ * should be reset with `k_list_null()` before it is reused. It is safe to call
+ * this function if the link is already removed.
+ *
+ * The caller must hold the lock that serializes writers.
+ */
+static inline void
+k_list_remove_rcu(struct KListLink *link)
+{
+  if (link->prev == K_NULL)
+    return;
+
+  link->prev->next = link->next;
+  link->next->prev = link->prev;
+
+  link->prev = K_NULL;
+}
+
+#endif  // !__INCLUDE_KERNEL_CORE_RCU_H__
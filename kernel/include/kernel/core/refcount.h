@@ -0,0 +1,165 @@
+#ifndef __INCLUDE_KERNEL_CORE_REFCOUNT_H__
+#define __INCLUDE_KERNEL_CORE_REFCOUNT_H__
+
+#include <kernel/core/assert.h>
+#include <kernel/core/atomic.h>
+
+/**
+ * @file kernel/core/refcount.h
+ *
+ * Reference counters.
+ *
+ * Taking and dropping references does not require any locks. A lock is only
+ * needed if the object can be found (and a reference taken) while its counter
+ * is zero, e.g. in a cache of unused objects.
+ */
+
+/**
+ * @brief Reference counter.
+ */
+struct KRefCount {
+  k_atomic_t count;
+};
+
+/**
+ * @brief Static initializer for a reference counter.
+ */
+#define K_REFCOUNT_INIT(n)  { K_ATOMIC_INIT(n) }
+
+/* -------------------------------------------------------------------------- */
+/*                                 Kernel API                                 */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Initialize a reference counter.
+ *
+ * @param ref Pointer to the reference counter.
+ * @param n   The initial number of references.
+ */
+static inline void
+k_refcount_init(struct KRefCount *ref, int n)
+{
+  k_atomic_set(&ref->count, n);
+}
+
+/**
+ * @brief Get the current number of references.
+ *
+ * The value may change at any moment unless the caller prevents that by other
+ * means, so it should only be used for assertions and heuristics.
+ */
+static inline int
+k_refcount_read(const struct KRefCount *ref)
+{
+  return k_atomic_read(&ref->count);
+}
+
+/**
+ * @brief Take a reference.
+ *
+ * The caller must already hold a reference, or prevent the counter from
+ * dropping to zero concurrently with a lock.
+ */
+static inline void
+k_refcount_get(struct KRefCount *ref)
+{
+  k_atomic_inc(&ref->count);
+}
+
+/**
+ * @brief Take a reference, unless the counter has already dropped to zero.
+ *
+ * Used to take a reference to an object found without a lock (e.g. under
+ * `k_rcu_read_lock()`), which may be in the middle of being destroyed.
+ *
+ * @return Non-zero if the reference was taken.
+ */
+static inline int
+k_refcount_get_unless_zero(struct KRefCount *ref)
+{
+  int count = k_atomic_read(&ref->count);
+
+  while (count != 0) {
+    int old = k_atomic_cmpxchg(&ref->count, count, count + 1);
+
+    if (old == count)
+      return 1;
+
+    count = old;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Drop a reference.
+ *
+ * @return Non-zero if this was the last reference.
+ */
+static inline int
+k_refcount_put(struct KRefCount *ref)
+{
+  int count = k_atomic_add_return(&ref->count, -1);
+
+  k_assert(count >= 0);
+
+  return count == 0;
+}
+
+/**
+ * @brief Drop a reference, without checking whether it was the last one.
+ *
+ * Used when the counter dropping to zero is handled separately by the caller
+ * (e.g. under a lock that prevents new references from being taken).
+ */
+static inline void
+k_refcount_dec(struct KRefCount *ref)
+{
+  int count = k_atomic_add_return(&ref->count, -1);
+
+  k_assert(count >= 0);
+  (void) count;
+}
+
+/**
+ * @brief Drop the reference, if it is the only one.
+ *
+ * @return Non-zero if the reference was dropped.
+ */
+static inline int
+k_refcount_put_if_one(struct KRefCount *ref)
+{
+  return k_atomic_cmpxchg(&ref->count, 1, 0) == 1;
+}
+
+/**
+ * @brief Drop a reference, unless no more than the given number of references
+ *        would remain.
+ *
+ * Allows dropping a reference without a lock in the common case, when the
+ * remaining references need special handling (e.g. those held by a cache).
+ *
+ * @param ref Pointer to the reference counter.
+ * @param min The reference is only dropped if more than this number of
+ *            references would remain.
+ *
+ * @return Non-zero if the reference was dropped.
+ */
+static inline int
+k_refcount_put_above(struct KRefCount *ref, int min)
+{
+  int count = k_atomic_read(&ref->count);
+
+  while (count > min + 1) {
+    int old = k_atomic_cmpxchg(&ref->count, count, count - 1);
+
+    if (old == count)
+      return 1;
+
+    count = old;
+  }
+
+  return 0;
+}
+
+#endif  // !__INCLUDE_KERNEL_CORE_REFCOUNT_H__
@@ -4,6 +4,7 @@
 #include <kernel/core/config.h>
 
 struct KCpu;
+struct KLockStat;
 
 /**
  * @brief Maximum number of program counter (PC) entries stored for debug tracing.
@@ -19,13 +20,21 @@ struct KCpu;
  *
  * A spinlock ensures mutual exclusion between CPUs. It can be used to protect
  * shared kernel data structures in contexts where sleeping is not allowed.
+ *
+ * Spinlocks are ticket locks: each CPU takes the next ticket and waits until
+ * the ticket is served, so the lock is granted in the FIFO order.
  */
 struct KSpinLock {
-  volatile int  locked;
+  volatile unsigned locked; ///< Next ticket (high 16 bits) and current owner
 
   struct KCpu  *cpu;
   const char   *name;
   k_uintptr_t   pcs[K_SPINLOCK_MAX_PCS];
+
+#ifdef K_LOCK_STAT
+  struct KLockStat   *stat;       ///< Cached contention statistics entry
+  unsigned long long  stat_start; ///< Time of the last acquisition
+#endif
 };
 
 /**
@@ -56,38 +65,50 @@ int  k_spinlock_holding(struct KSpinLock *);
 /*                           Architecture Interface                           */
 /* -------------------------------------------------------------------------- */
 
+/**
+ * @brief Shift of the next ticket number in the lock word.
+ */
+#define K_SPINLOCK_TICKET_SHIFT   16
+
+/**
+ * @brief Mask of the owner ticket number in the lock word.
+ */
+#define K_SPINLOCK_OWNER_MASK     0xFFFF
+
 /**
  * @brief Acquire a low-level hardware spinlock.
  *
- * Atomically acquires the spinlock flag at the architecture level.
+ * Atomically takes the next ticket by incrementing the upper half of the lock
+ * word, then waits until the lower half (the ticket being served) becomes
+ * equal to it. Must act as an acquire barrier.
  *
- * @param lock Pointer to the architecture-specific lock variable.
+ * @param lock Pointer to the lock word.
  *
- * @note Implemented per architecture (e.g., using atomic test-and-set or
- *       compare-and-swap instructions).
+ * @note Implemented per architecture (e.g., using atomic fetch-and-add or
+ *       exclusive load/store instructions).
  */
-void k_arch_spinlock_acquire(volatile int *);
+void k_arch_spinlock_acquire(volatile unsigned *);
 
 /**
  * @brief Release a low-level hardware spinlock.
  *
- * Atomically releases the spinlock flag at the architecture level.
+ * Passes the lock to the next waiting CPU by incrementing the lower half of
+ * the lock word. Must act as a release barrier.
  *
- * @param lock Pointer to the architecture-specific lock variable.
+ * @param lock Pointer to the lock word.
  */
-void k_arch_spinlock_release(volatile int *);
+void k_arch_spinlock_release(volatile unsigned *);
 
 /**
- * @brief Record callstack information for a spinlock.
- *
- * Saves the current program counter values into the spinlock’s `pcs` array.
- * This is used for debugging and diagnostics when spinlock debugging is
- * enabled.
+ * @brief Record the current callstack.
  *
- * @param spin Pointer to the spinlock to record callstack data for.
+ * Saves the program counter values of the current call chain, starting with
+ * the caller. Used for debugging and diagnostics, e.g. to remember where a
+ * spinlock was acquired. Unused entries are set to zero.
  *
- * @note Has no effect if spinlock callstack tracking is disabled.
+ * @param pcs Array to store the program counter values.
+ * @param max The maximum number of values to store.
  */
-void k_arch_spinlock_save_callstack(struct KSpinLock *);
+void k_arch_save_callstack(k_uintptr_t *, int);
 
 #endif  // !__KERNEL_INCLUDE_CORE_SPINLOCK_H__
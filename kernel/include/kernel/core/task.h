@@ -24,6 +24,23 @@ enum {
   K_TASK_FLAG_DESTROY    = (1 << 1),
 };
 
+/**
+ * Scheduling policies.
+ */
+enum {
+  /** Fair share of the CPU time, weighted by the nice value */
+  K_TASK_POLICY_FAIR = 0,
+  /** Real-time, runs until it blocks or yields */
+  K_TASK_POLICY_FIFO,
+  /** Real-time, time-sliced among tasks of the same priority */
+  K_TASK_POLICY_RR,
+};
+
+/** The highest (most favorable) nice value */
+#define K_TASK_NICE_MIN   (-NZERO)
+/** The lowest (least favorable) nice value */
+#define K_TASK_NICE_MAX   (NZERO - 1)
+
 struct KObjectPool;
 extern struct KObjectPool *k_task_cache;
 
@@ -41,10 +58,22 @@ struct KTask {
   /** Task priority value */
   int               priority;
   int               saved_priority;
+  /** Scheduling policy */
+  int               policy;
+  /** Nice value (fair tasks only) */
+  int               nice;
+  /** Ticks left in the current time slice (round-robin tasks only) */
+  int               timeslice;
+  /** Weighted CPU time consumed (fair tasks only) */
+  unsigned long long vruntime;
+  /** Mask of CPUs the task is allowed to run on */
+  unsigned long     affinity;
   /** Various flags */
   int               flags;
   /** CPU */
   struct KCpu       *cpu;
+  /** CPU whose run queue this task was last placed on */
+  struct KCpu       *last_cpu;
 
   struct KListLink   owned_mutexes;
   struct KMutex     *sleep_on_mutex;
@@ -68,9 +97,25 @@ struct KTask {
 
   /** Tne process this task belongs to */
   void             *ext;
+
+#ifdef K_LATENCY_STAT
+  /** Time the task was last woken up */
+  unsigned long long wakeup_time;
+  /** The longest time from wakeup until the task started running */
+  unsigned long long wakeup_latency_max;
+#endif
 };
 
 void          arch_task_init_stack(struct KTask *, void (*)(void));
+
+/**
+ * @brief Wait for an interrupt (architecture-specific).
+ *
+ * Called with interrupts disabled. Must re-enable interrupts and put the CPU
+ * into a low-power state atomically, so that an interrupt that becomes pending
+ * in between still wakes the CPU up. Returns with interrupts enabled after the
+ * interrupt has been handled.
+ */
 void          arch_task_idle(void);
 
 struct KTask *k_task_current(void);
@@ -80,6 +125,12 @@ int           k_task_resume(struct KTask *);
 void          k_task_suspend(void);
 void          k_task_yield(void);
 void          k_task_wake(struct KTask *);
+int           k_task_set_policy(struct KTask *, int, int);
+void          k_task_get_policy(struct KTask *, int *, int *);
+int           k_task_set_nice(struct KTask *, int);
+int           k_task_get_nice(struct KTask *);
+int           k_task_set_affinity(struct KTask *, unsigned long);
+unsigned long k_task_get_affinity(struct KTask *);
 
 void          k_sched_init(void);
 void          k_sched_start(void);
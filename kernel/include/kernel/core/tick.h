@@ -3,8 +3,49 @@
 
 #include <kernel/core/types.h>
 
+/* -------------------------------------------------------------------------- */
+/*                           Architecture Interface                           */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Stop the periodic tick on the current CPU (architecture-specific).
+ *
+ * Reprograms the local timer to generate a single interrupt after the given
+ * number of tick periods instead of one interrupt every period. The
+ * architecture may fire earlier if the hardware cannot represent the whole
+ * interval.
+ *
+ * @param ticks Number of tick periods until the interrupt (at least 2).
+ *
+ * @return 0 on success, or a negative error code if the timer cannot be used
+ *         in one-shot mode.
+ */
+int      k_arch_tick_oneshot(k_tick_t ticks);
+
+/**
+ * @brief Restart the periodic tick on the current CPU (architecture-specific).
+ *
+ * Called after a successful `k_arch_tick_oneshot()`, once the CPU leaves the
+ * idle state.
+ *
+ * @return The number of whole tick periods elapsed since the one-shot timer
+ *         was programmed.
+ */
+k_tick_t k_arch_tick_periodic(void);
+
+/**
+ * @brief Interrupt all other CPUs (architecture-specific).
+ *
+ * Used to bring idle CPUs out of the tickless mode.
+ */
+void     k_arch_tick_kick(void);
+
+/* -------------------------------------------------------------------------- */
+/*                                 Kernel API                                 */
+/* -------------------------------------------------------------------------- */
+
 k_tick_t k_tick_get(void);
-void k_tick_set(k_tick_t);
-void k_tick(void);
+void     k_tick_set(k_tick_t);
+void     k_tick(void);
 
 #endif  // !__INCLUDE_KERNEL_CORE_TICK_H__
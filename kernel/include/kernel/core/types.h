@@ -55,8 +55,9 @@ enum {
  * semaphore wait timeout, or timer expiration.
  */
 struct KTimeoutEntry {
-  struct KListLink link;
-  k_tick_t remain;
+  struct KListLink link;      ///< Link into the timing wheel slot
+  k_tick_t         expires;   ///< Expiry time, in the queue's own ticks
+  int              level;     ///< Timing wheel level the entry is placed on
 };
 
 /**
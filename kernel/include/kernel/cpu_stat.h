@@ -0,0 +1,57 @@
+#ifndef __KERNEL_INCLUDE_KERNEL_CPU_STAT_H__
+#define __KERNEL_INCLUDE_KERNEL_CPU_STAT_H__
+
+#ifndef __ARGENTUM_KERNEL__
+#error "This is a kernel header; user programs should not #include it"
+#endif
+
+/**
+ * @file include/kernel/cpu_stat.h
+ *
+ * Always-on per-CPU event counters.
+ *
+ * Each CPU increments only its own counters, with interrupts disabled, so
+ * counting an event costs a few instructions and never touches a shared cache
+ * line. The counters of all CPUs are summed up only when they are displayed.
+ */
+
+#include <kernel/core/irq.h>
+#include <kernel/core/percpu.h>
+#include <kernel/interrupt.h>
+
+enum {
+  CPU_STAT_CONTEXT_SWITCHES,
+  CPU_STAT_SYSCALLS,
+  CPU_STAT_PAGE_FAULTS,
+  CPU_STAT_IPC_MESSAGES,
+  CPU_STAT_BUF_HITS,
+  CPU_STAT_BUF_MISSES,
+  CPU_STAT_PAGE_ALLOCS,
+  CPU_STAT_PAGE_REFILLS,
+  CPU_STAT_PAGE_ZERO_HITS,
+  CPU_STAT_PAGE_ZERO_MISSES,
+  CPU_STAT_MAX,
+};
+
+struct CpuStat {
+  unsigned long counters[CPU_STAT_MAX];
+  unsigned long irqs[INTERRUPT_HANDLER_MAX];
+};
+
+K_PERCPU_DECLARE(struct CpuStat, cpu_stats);
+
+const char *cpu_stat_name(int);
+void        cpu_stat_reset(void);
+
+/**
+ * Increment the given counter of the current CPU.
+ */
+static inline void
+cpu_stat_inc(int counter)
+{
+  k_irq_state_save();
+  K_PERCPU_THIS(cpu_stats).counters[counter]++;
+  k_irq_state_restore();
+}
+
+#endif  // !__KERNEL_INCLUDE_KERNEL_CPU_STAT_H__
@@ -5,6 +5,11 @@
 #error "This is a kernel header; user programs should not #include it"
 #endif
 
+#include <kernel/core/spinlock.h>
+
+// Size of the receive buffer filled by the interrupt handler
+#define UART_RX_BUF_SIZE  64
+
 struct UartOps {
   int (*read)(void *);
   int (*write)(void *, int);
@@ -13,6 +18,11 @@ struct UartOps {
 struct Uart {
   struct UartOps *ops;
   void *ctx;
+
+  struct KSpinLock rx_lock;
+  char rx_buf[UART_RX_BUF_SIZE];
+  unsigned rx_head;
+  unsigned rx_tail;
 };
 
 int uart_init(struct Uart *, struct UartOps *, void *, int);
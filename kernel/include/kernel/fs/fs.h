@@ -13,6 +13,8 @@
 #include <kernel/elf.h>
 #include <kernel/core/list.h>
 #include <kernel/core/mutex.h>
+#include <kernel/core/rcu.h>
+#include <kernel/core/refcount.h>
 #include <kernel/core/task.h>
 #include <kernel/ipc.h>
 
@@ -29,8 +31,9 @@ struct Inode {
   ino_t           ino;
   dev_t           dev;
 
-  // These two fields are protected by inode_cache.lock
-  int             ref_count;
+  // The reference count is atomic, but it can only be raised from zero and
+  // the cache link can only be changed with inode_cache.lock held
+  struct KRefCount ref_count;
   struct KListLink cache_link;
 
   struct KMutex   mutex;
@@ -53,13 +56,16 @@ struct Inode {
 
 struct PathNode {
   char             name[NAME_MAX + 1];
-  int              ref_count;
+  struct KRefCount ref_count;
 
   struct KMutex    mutex;
 
+  // The children lists are modified with fs_path_lock held, but may be
+  // traversed without it, under k_rcu_read_lock()
   struct PathNode *parent;
   struct KListLink children;
   struct KListLink siblings;
+  struct KRcuHead  rcu;
 
   // struct Inode    *inode;
   // struct Inode    *mounted;
@@ -103,7 +109,6 @@ struct FS {
   char           *name;
   
   struct Endpoint endpoint;
-  struct KTask    tasks[ENDPOINT_MBOX_CAPACITY];
 };
 
 #define FS_INODE_VALID  (1 << 0)
@@ -164,6 +169,5 @@ int              fs_path_set_cwd(struct PathNode *);
 ino_t            fs_path_ino(struct PathNode *, struct Connection **);
 
 struct FS *      fs_create_service(char *, dev_t, void *, struct FSOps *);
-void             fs_service_task(void *);
 
 #endif  // !__KERNEL_INCLUDE_KERNEL_FS_H__
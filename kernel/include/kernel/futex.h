@@ -0,0 +1,17 @@
+#ifndef __KERNEL_INCLUDE_KERNEL_FUTEX_H__
+#define __KERNEL_INCLUDE_KERNEL_FUTEX_H__
+
+#ifndef __ARGENTUM_KERNEL__
+#error "This is a kernel header; user programs should not #include it"
+#endif
+
+#include <stdint.h>
+
+struct timespec;
+
+void futex_init(void);
+int  futex_wait(uintptr_t, int, const struct timespec *);
+int  futex_wake(uintptr_t, int);
+int  futex_requeue(uintptr_t, int, int, uintptr_t);
+
+#endif  // !__KERNEL_INCLUDE_KERNEL_FUTEX_H__
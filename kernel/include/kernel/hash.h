@@ -6,6 +6,7 @@
 #endif
 
 #include <kernel/core/list.h>
+#include <kernel/core/rcu.h>
 #include <kernel/types.h>
 
 #define HASH_DECLARE(name, n)  struct KListLink name[n]
@@ -29,4 +30,14 @@
 
 #define HASH_REMOVE(node)   k_list_remove(node)
 
+// Variants for tables with lock-free readers (see kernel/core/rcu.h)
+
+#define HASH_FOREACH_ENTRY_RCU(hash, lp, key) \
+  K_LIST_FOREACH_RCU(&hash[key % ARRAY_SIZE(hash)], lp)
+
+#define HASH_PUT_RCU(hash, node, key) \
+  k_list_add_back_rcu(&hash[key % ARRAY_SIZE(hash)], node);
+
+#define HASH_REMOVE_RCU(node)   k_list_remove_rcu(node)
+
 #endif  // !__KERNEL_INCLUDE_KERNEL_HASH_H__
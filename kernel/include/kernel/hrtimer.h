@@ -0,0 +1,65 @@
+#ifndef __KERNEL_INCLUDE_KERNEL_HRTIMER_H__
+#define __KERNEL_INCLUDE_KERNEL_HRTIMER_H__
+
+#ifndef __ARGENTUM_KERNEL__
+#error "This is a kernel header; user programs should not #include it"
+#endif
+
+/**
+ * @file include/kernel/hrtimer.h
+ *
+ * High-resolution timers.
+ *
+ * Unlike the tick-based kernel timers, expiration times are specified in
+ * nanoseconds of the monotonic clock returned by `hrtimer_now()` and are
+ * programmed directly into the per-CPU event timer hardware.
+ */
+
+#include <stdint.h>
+
+#include <kernel/core/list.h>
+
+struct KCondVar;
+struct KMutex;
+
+/**
+ * High-resolution timer.
+ */
+struct HRTimer {
+  struct KListLink link;              ///< Link into the per-CPU timer queue
+  uint64_t         expires;           ///< Expiration time, in nanoseconds
+  uint64_t         period;            ///< Reload period (0 for one-shot)
+  void           (*callback)(void *); ///< Called in the interrupt context
+  void            *callback_arg;      ///< Argument to be passed to callback
+  int              cpu;               ///< Queue holding the timer (or -1)
+  int              running;           ///< CPU running the callback (or -1)
+  int              cancelled;         ///< Do not reload after the callback
+};
+
+void     hrtimer_init(void);
+void     hrtimer_create(struct HRTimer *, void (*)(void *), void *);
+int      hrtimer_start(struct HRTimer *, uint64_t, uint64_t);
+uint64_t hrtimer_stop(struct HRTimer *);
+uint64_t hrtimer_now(void);
+void     hrtimer_interrupt(void);
+int      hrtimer_condvar_timed_wait(struct KCondVar *, struct KMutex *,
+                                    uint64_t);
+
+/**
+ * Get the current value of the monotonic clock (architecture-specific).
+ *
+ * @return The number of nanoseconds since an arbitrary point in the past.
+ */
+uint64_t arch_hrtimer_now(void);
+
+/**
+ * Program the event timer of the current CPU (architecture-specific).
+ *
+ * The architecture must call `hrtimer_interrupt()` on the current CPU once the
+ * given time is reached, or as soon as possible if it has already passed.
+ *
+ * @param expires The event time, in nanoseconds.
+ */
+void     arch_hrtimer_program(uint64_t expires);
+
+#endif  // !__KERNEL_INCLUDE_KERNEL_HRTIMER_H__
@@ -3,6 +3,9 @@
 
 #include <kernel/core/semaphore.h>
 
+// TODO: should be architecture-specific?
+#define INTERRUPT_HANDLER_MAX       64
+
 struct KTask;
 struct TrapFrame;
 
@@ -15,9 +18,16 @@ void arch_interrupt_enable(int, int);
 int  arch_interrupt_id(struct TrapFrame *);
 void arch_interrupt_eoi(int);
 
+/** Unmask the interrupt line when the handler returns */
+#define INTERRUPT_UNMASK        (1 << 0)
+/** Run the bottom half of a threaded handler */
+#define INTERRUPT_WAKE_THREAD   (1 << 1)
+
 typedef int (*interrupt_handler_t)(int, void *);
 
 void interrupt_attach(int, interrupt_handler_t, void *);
+void interrupt_attach_threaded(int, interrupt_handler_t,
+                               void (*)(int, void *), void *);
 void interrupt_attach_task(int, void (*)(int, void *), void *);
 void interrupt_dispatch(struct TrapFrame *);
 
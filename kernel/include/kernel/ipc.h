@@ -5,10 +5,12 @@
 #include <sys/uio.h>
 #include <sys/ipc.h>
 
-#include <kernel/core/semaphore.h>
 #include <kernel/core/mailbox.h>
+#include <kernel/core/refcount.h>
+#include <kernel/core/semaphore.h>
 
 struct Inode;
+struct KTask;
 struct stat;
 
 enum {
@@ -29,7 +31,7 @@ struct Endpoint;
 
 struct Connection {
   int                  type;         // File type (inode, console, or pipe)
-  int                  ref_count;    // The number of references to this file
+  struct KRefCount     ref_count;    // The number of references to this file
   
   int                  flags;
   struct PathNode     *node;         // Pointer to the corresponding inode
@@ -68,8 +70,7 @@ struct Request {
   struct KSemaphore sem;
   struct Process *process;
   struct Connection *connection;
-  struct KSpinLock lock;
-  int ref_count;
+  struct KRefCount ref_count;
 
   intptr_t r;
 };
@@ -81,14 +82,47 @@ void            request_reply(struct Request *, intptr_t);
 ssize_t         request_write(struct Request *, void *, size_t);
 ssize_t         request_read(struct Request *, void *, size_t);
 
-#define ENDPOINT_MBOX_CAPACITY  20
+// Default maximum number of worker tasks serving an endpoint
+#define ENDPOINT_WORKERS_MAX    32
+
+typedef void (*endpoint_handler_t)(void *, struct Request *);
 
 struct Endpoint {
-  struct KMailBox mbox;
-  uint8_t         mbox_buf[ENDPOINT_MBOX_CAPACITY * sizeof(void *)];
+  const char         *name;
+  struct KMailBox     mbox;
+  void               *mbox_buf;
+
+  struct KListLink    link;         // Link into the list of all endpoints
+
+  // Elastic pool of worker tasks
+  struct KSpinLock    lock;
+  endpoint_handler_t  handler;
+  void               *handler_arg;
+  unsigned long       cpus;         // CPUs to run the workers on
+  int                 workers_max;
+  int                 workers;      // Number of running workers
+  int                 idle;         // Workers waiting for requests
+  int                 queued;       // Requests sent but not received yet
+  int                 queued_max;   // Highest queue depth observed
+};
+
+/**
+ * Snapshot of the endpoint statistics.
+ */
+struct EndpointInfo {
+  const char         *name;
+  int                 workers;
+  int                 workers_max;
+  int                 idle;
+  int                 queued;
+  int                 queued_max;
 };
 
-void endpoint_init(struct Endpoint *);
-int  endpoint_receive(struct Endpoint *, struct Request **);
+void endpoint_init(struct Endpoint *, const char *, endpoint_handler_t, void *,
+                   unsigned long, int);
+int  endpoint_send(struct Endpoint *, struct Request *, k_tick_t);
+int  endpoint_stat(struct EndpointInfo *, int);
+void endpoint_idle(void);
+void endpoint_on_task_destroy(struct KTask *);
 
 #endif  // !__KERNEL_INCLUDE_KERNEL_IPC_CONNECTION__
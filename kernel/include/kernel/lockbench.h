@@ -0,0 +1,6 @@
+#ifndef __KERNEL_INCLUDE_KERNEL_LOCKBENCH_H__
+#define __KERNEL_INCLUDE_KERNEL_LOCKBENCH_H__
+
+void lockbench_init(void);
+
+#endif  // !__KERNEL_INCLUDE_KERNEL_LOCKBENCH_H__
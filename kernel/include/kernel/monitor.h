@@ -35,6 +35,30 @@ int mon_kerninfo(int, char **, struct TrapFrame *);
  */
 int mon_backtrace(int, char **, struct TrapFrame *);
 
+/**
+ * Display the object pools with their magazine hit rates, the memory
+ * shrinkers, and the internal fragmentation of each k_malloc size class.
+ */
 int mon_kmeminfo(int, char **, struct TrapFrame *);
 
+/**
+ * Display the locks with the highest total wait time.
+ */
+int mon_lockstat(int, char **, struct TrapFrame *);
+
+/**
+ * Display the per-CPU event counters.
+ */
+int mon_cpustat(int, char **, struct TrapFrame *);
+
+/**
+ * Display the queue depth and the number of workers of each endpoint.
+ */
+int mon_ipcstat(int, char **, struct TrapFrame *);
+
+/**
+ * Display the worst-case interrupt, preemption and wakeup latencies.
+ */
+int mon_latstat(int, char **, struct TrapFrame *);
+
 #endif  // !__KERNEL_INCLUDE_KERNEL_MONITOR_H__
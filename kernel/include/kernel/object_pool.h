@@ -11,11 +11,44 @@
 #error "This is a kernel header; user programs should not #include it"
 #endif
 
+#include <kernel/core/config.h>
 #include <kernel/core/list.h>
 #include <kernel/core/spinlock.h>
 
 #define K_OBJECT_POOL_NAME_MAX  64
 
+/** The number of objects (rounds) each magazine can hold. */
+#define K_OBJECT_MAGAZINE_SIZE  15
+
+/**
+ * Magazine: a stack of free objects cached by the pool.
+ */
+struct KObjectMagazine {
+  /** Link into the depot list. */
+  struct KObjectMagazine *next;
+  /** The number of objects in the magazine. */
+  unsigned                rounds;
+  /** The objects. */
+  void                   *objs[K_OBJECT_MAGAZINE_SIZE];
+};
+
+/**
+ * Per-CPU part of the pool descriptor.
+ *
+ * Accessed only by the owning CPU, with interrupts disabled, so allocations
+ * and deallocations that hit the loaded magazines don't need any locks.
+ */
+struct KObjectPoolCpu {
+  /** The magazine to allocate from and free into. */
+  struct KObjectMagazine *loaded;
+  /** The previously loaded magazine (either full or empty). */
+  struct KObjectMagazine *previous;
+  /** The number of allocations satisfied from the magazines. */
+  unsigned long           hits;
+  /** The number of allocations that had to go to the slab layer. */
+  unsigned long           misses;
+} __attribute__((aligned(K_CACHE_LINE_SIZE)));
+
 /**
  * Object pool descriptor.
  */
@@ -59,10 +92,39 @@ struct KObjectPool {
 
   /** Human-readable pool name (for debugging purposes). */
   char              name[K_OBJECT_POOL_NAME_MAX + 1];
+
+  /** Depot: full magazines. */
+  struct KObjectMagazine *depot_full;
+  /** Depot: empty magazines. */
+  struct KObjectMagazine *depot_empty;
+
+  /** Per-CPU magazines. */
+  struct KObjectPoolCpu cpus[K_CPU_MAX];
 };
 
 enum {
-  K_OBJECT_POOL_OFF_SLAB = (1 << 0)
+  K_OBJECT_POOL_OFF_SLAB     = (1 << 0),
+  K_OBJECT_POOL_NO_MAGAZINES = (1 << 1),
+};
+
+/**
+ * Object pool statistics.
+ */
+struct KObjectPoolInfo {
+  /** Human-readable pool name. */
+  char              name[K_OBJECT_POOL_NAME_MAX + 1];
+  /** Size of a single object in bytes. */
+  size_t            obj_size;
+  /** The number of slabs. */
+  unsigned          slabs;
+  /** The total number of objects in all slabs. */
+  unsigned          objs_total;
+  /** The number of objects allocated from the slabs (including cached). */
+  unsigned          objs_used;
+  /** The number of allocations satisfied from the magazines. */
+  unsigned long     hits;
+  /** The number of allocations that had to go to the slab layer. */
+  unsigned long     misses;
 };
 
 struct KObjectTag {
@@ -87,16 +149,33 @@ struct KObjectSlab {
   struct KObjectTag   tags[0];
 };
 
+/**
+ * Statistics of a single k_malloc size class.
+ */
+struct KMallocInfo {
+  /** Size of the blocks in this class. */
+  size_t             size;
+  /** The number of allocations. */
+  unsigned long      allocs;
+  /** The number of deallocations. */
+  unsigned long      frees;
+  /** The total number of bytes requested by all allocations. */
+  unsigned long long requested;
+};
+
 struct KObjectPool *k_object_pool_create(const char *, size_t, size_t,
                                       void (*)(void *, size_t),
                                       void (*)(void *, size_t));
 int                k_object_pool_destroy(struct KObjectPool *);
 void              *k_object_pool_get(struct KObjectPool *);
 void               k_object_pool_put(struct KObjectPool *, void *);
+unsigned           k_object_pool_reap(struct KObjectPool *);
+int                k_object_pool_stat(struct KObjectPoolInfo *, int);
 
 void               k_object_pool_system_init(void);
 
 void              *k_malloc(size_t);
 void               k_free(void *);
+int                k_malloc_stat(struct KMallocInfo *, int);
 
 #endif  // !__KERNEL_OBJECT_POOL_H__
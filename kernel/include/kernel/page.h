@@ -121,6 +121,37 @@ void         page_free_block(struct Page *, unsigned);
 void         page_free_region(physaddr_t, physaddr_t);
 void         page_assert(struct Page *, unsigned, int);
 
+/**
+ * Shrinker: a callback to free memory held by a cache under memory pressure.
+ */
+struct PageShrinker {
+  /** Name displayed in the statistics */
+  const char      *name;
+  /** Try to free the given number of pages, return the number freed */
+  unsigned       (*shrink)(unsigned);
+  /** Link into the list of shrinkers */
+  struct KListLink link;
+  /** The number of calls */
+  unsigned long    calls;
+  /** The total number of pages freed */
+  unsigned long    freed;
+};
+
+/**
+ * Shrinker statistics.
+ */
+struct PageShrinkerInfo {
+  const char      *name;
+  unsigned long    calls;
+  unsigned long    freed;
+};
+
+void         page_shrinker_register(struct PageShrinker *);
+int          page_shrinker_stat(struct PageShrinkerInfo *, int);
+void         page_reclaim_init(void);
+void         page_reclaim_wakeup(void);
+void         page_zero_idle(void);
+
 /**
  * Allocate a single page.
  * 
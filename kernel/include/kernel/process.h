@@ -15,9 +15,10 @@
 #include <kernel/core/cpu.h>
 #include <kernel/core/spinlock.h>
 #include <kernel/core/list.h>
-#include <kernel/core/timer.h>
+#include <kernel/core/rcu.h>
 #include <kernel/vm.h>
 #include <kernel/core/task.h>
+#include <kernel/hrtimer.h>
 #include <kernel/trap.h>
 #include <kernel/waitqueue.h>
 
@@ -26,6 +27,7 @@ struct KSpinLock;
 struct Inode;
 struct Process;
 struct PathNode;
+struct sched_param;
 struct Signal;
 
 struct ConnectionDesc {
@@ -36,6 +38,12 @@ struct ConnectionDesc {
 struct Thread {
   struct KTask     task;
   struct Process  *process;
+  /** Link into the list of process threads */
+  struct KListLink process_link;
+  /** Unique thread identifier (the main thread uses the process ID) */
+  pid_t            tid;
+  /** User address to be cleared and woken up when the thread exits */
+  uintptr_t        clear_tid;
   /** Address of the current trap frame on the stack */
   struct TrapFrame *tf;
 
@@ -54,11 +62,19 @@ struct Process {
 
   /** Main process thread */
   struct Thread        *thread;
+  /** List of all process threads */
+  struct KListLink      threads;
+  /** Number of threads in the list */
+  int                   nthreads;
+  /** Queue to sleep waiting for other threads to exit */
+  struct KWaitQueue     thread_queue;
 
   /** Unique thread identifier */
   pid_t                 pid;
   /** Link into the PID hash table */
   struct KListLink      pid_link;
+  /** Used to free the process once PID lookups no longer see it */
+  struct KRcuHead       rcu;
   /** Process group ID */
   pid_t                 pgid;
 
@@ -104,10 +120,15 @@ struct Process {
   /** Controlling terminal */
   dev_t                 ctty;
 
-  struct {
-    struct itimerval value;
-    struct KTimer    timer;
-  } itimers[3];
+  /** Interval timers */
+  struct HRTimer        itimers[3];
+};
+
+// Wakeup latency of a thread, for the statistics
+struct ThreadLatencyInfo {
+  pid_t                 pid;
+  pid_t                 tid;
+  unsigned long long    wakeup_max;
 };
 
 enum {
@@ -119,6 +140,7 @@ enum {
 
 enum {
   PROCESS_STATUS_AVAILABLE = (1 << 0),
+  PROCESS_STATUS_EXITING   = (1 << 1),
 };
 
 static inline struct Thread *
@@ -149,8 +171,16 @@ void           process_update_times(struct Process *, clock_t, clock_t);
 void           process_get_times(struct Process *, struct tms *);
 pid_t          process_get_gid(pid_t);
 int            process_set_gid(pid_t, pid_t);
+int            process_set_scheduler(pid_t, int, const struct sched_param *);
+int            process_get_param(pid_t, struct sched_param *);
+int            process_nice(int);
+int            process_set_affinity(pid_t, unsigned long);
+int            process_get_affinity(pid_t, unsigned long *);
 int            process_match_pid(struct Process *, pid_t);
 int            process_set_itimer(int, struct itimerval *, struct itimerval *);
+int            process_latency_stat(struct ThreadLatencyInfo *, int);
+pid_t          process_thread_create(uintptr_t, uintptr_t, uintptr_t, uintptr_t);
+void           process_thread_exit(void);
 
 void           thread_on_destroy(struct Thread *);
 void           thread_idle(void);
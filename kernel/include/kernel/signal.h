@@ -7,6 +7,7 @@
 #include <kernel/core/list.h>
 
 struct Process;
+struct Thread;
 
 struct Signal {
   struct KListLink link;
@@ -25,6 +26,7 @@ int  arch_signal_return(struct Process *, struct SignalFrame *, int *);
 void signal_init_system(void);
 void signal_init(struct Process *);
 int  signal_generate(pid_t, int, int);
+int  signal_generate_thread(struct Thread *, int, int);
 void signal_clone(struct Process *, struct Process *);
 void signal_deliver_pending(void);
 int  signal_action_change(int, uintptr_t, struct sigaction *, struct sigaction *);
@@ -69,5 +69,13 @@ int32_t sys_utime(void);
 int32_t sys_symlink(void);
 int32_t sys_ipc_send(void);
 int32_t sys_ipc_sendv(void);
+int32_t sys_sched_setscheduler(void);
+int32_t sys_sched_getparam(void);
+int32_t sys_nice(void);
+int32_t sys_sched_setaffinity(void);
+int32_t sys_sched_getaffinity(void);
+int32_t sys_futex(void);
+int32_t sys_clone(void);
+int32_t sys_thread_exit(void);
 
 #endif  // !__KERNEL_INCLUDE_KERNEL_SYSCALL_H__
@@ -64,4 +64,30 @@ timespec2ticks(const struct timespec *ts)
   return ts->tv_sec * TICKS_PER_SECOND + ts->tv_nsec / NS_PER_TICK;
 }
 
+static inline unsigned long long
+timespec2ns(const struct timespec *ts)
+{
+  return ts->tv_sec * 1000000000ULL + ts->tv_nsec;
+}
+
+static inline void
+ns2timespec(unsigned long long ns, struct timespec *ts)
+{
+  ts->tv_sec  = ns / 1000000000ULL;
+  ts->tv_nsec = ns % 1000000000ULL;
+}
+
+static inline unsigned long long
+timeval2ns(const struct timeval *tv)
+{
+  return tv->tv_sec * 1000000000ULL + tv->tv_usec * 1000ULL;
+}
+
+static inline void
+ns2timeval(unsigned long long ns, struct timeval *tv)
+{
+  tv->tv_sec  = ns / 1000000000ULL;
+  tv->tv_usec = (ns % 1000000000ULL) / 1000;
+}
+
 #endif  // !__KERNEL_INCLUDE_KERNEL_TIME_H__
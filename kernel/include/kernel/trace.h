@@ -0,0 +1,46 @@
+#ifndef __KERNEL_INCLUDE_KERNEL_TRACE_H__
+#define __KERNEL_INCLUDE_KERNEL_TRACE_H__
+
+#ifndef __ARGENTUM_KERNEL__
+#error "This is a kernel header; user programs should not #include it"
+#endif
+
+/**
+ * @file include/kernel/trace.h
+ *
+ * Static tracepoints.
+ *
+ * Each CPU records events into its own ring buffer with interrupts disabled,
+ * so no locks are taken on the recording path. The buffers are drained by
+ * reading the /dev/trace device. All events are disabled by default, in which
+ * case a tracepoint costs a single load and a branch.
+ */
+
+#include <stdint.h>
+#include <sys/trace.h>
+
+#include <kernel/core/task.h>
+
+/** Mask of the enabled events */
+extern volatile unsigned long trace_events;
+
+void trace_init(void);
+void trace_record(struct KTask *, int, uintptr_t, uintptr_t);
+
+/**
+ * Record an event on behalf of the given task if the event is enabled.
+ */
+#define TRACE_TASK(task, event, arg0, arg1)                       \
+  do {                                                            \
+    if (trace_events & (1UL << (event)))                          \
+      trace_record((task), (event), (uintptr_t) (arg0),           \
+                   (uintptr_t) (arg1));                           \
+  } while (0)
+
+/**
+ * Record an event on behalf of the current task if the event is enabled.
+ */
+#define TRACE(event, arg0, arg1) \
+  TRACE_TASK(k_task_current(), event, arg0, arg1)
+
+#endif  // !__KERNEL_INCLUDE_KERNEL_TRACE_H__
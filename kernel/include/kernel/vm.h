@@ -21,7 +21,7 @@
 #define VM_PAGE       (1 << 6)
 
 struct Page;
-struct Process;
+struct Thread;
 
 void        *arch_vm_create(void);
 void         arch_vm_destroy(void *);
@@ -36,7 +36,7 @@ void         arch_vm_init(void);
 void         arch_vm_init_percpu(void);
 void         arch_vm_load_kernel(void);
 void         arch_vm_load(void *);
-void         arch_vm_switch(struct Process *);
+void         arch_vm_switch(struct Thread *);
 void         arch_vm_map_fixed(uintptr_t, uint32_t, size_t, int);
 void         arch_vm_unmap_fixed(uintptr_t, size_t);
 
@@ -56,6 +56,7 @@ int          vm_user_check_str(void *, uintptr_t, size_t *, int);
 int          vm_user_check_ptr(void *, uintptr_t, int);
 int          vm_user_check_buf(void *, uintptr_t, size_t, int);
 int          vm_user_check_args(void *, uintptr_t, size_t *, int);
+int          vm_user_get_word(void *, uintptr_t, struct Page **, int *);
 
 int          vm_handle_fault(void *, uintptr_t);
 
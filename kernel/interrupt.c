@@ -1,75 +1,135 @@
 #include <kernel/console.h>
+#include <kernel/cpu_stat.h>
 #include <kernel/interrupt.h>
 #include <kernel/trap.h>
 #include <kernel/core/cpu.h>
 #include <kernel/core/irq.h>
+#include <kernel/core/percpu.h>
+#include <kernel/core/spinlock.h>
 #include <kernel/core/task.h>
-#include <kernel/object_pool.h>
 #include <kernel/page.h>
+#include <kernel/trace.h>
 
 static int  interrupt_handler_call(int);
-static void interrupt_task_entry(void *);
-static int  interrupt_task_notify(int, void *);
-
-// TODO: should be architecture-specific?
-#define INTERRUPT_HANDLER_MAX       64
-
-struct InterruptTask {
-  struct KTask        task;
-  void              (*handler)(int, void *);
-  void               *handler_arg;
-  int                 irq;
+static void interrupt_worker_entry(void *);
+
+// Number of worker tasks per CPU running the bottom halves
+#define INTERRUPT_WORKERS_PER_CPU  3
+
+// Bottom halves are run by a small pool of worker tasks per CPU instead of a
+// separate task (and stack) per interrupt line. Since each interrupt is routed
+// to the CPU it was attached on, only the pool of that CPU is ever notified.
+// Each worker takes one line at a time, so a bottom half that sleeps does not
+// hold up the other lines, as long as there are idle workers.
+struct InterruptWorker {
+  struct KTask        tasks[INTERRUPT_WORKERS_PER_CPU];
   struct KSemaphore   semaphore;
+  struct KSpinLock    lock;
+  uint64_t            pending;    // Lines with a pending bottom half
+  uint64_t            running;    // Lines whose bottom half is running
+  int                 idle;       // Number of workers waiting for work
+  int                 started;
 };
 
+K_PERCPU_DEFINE_STATIC(struct InterruptWorker, interrupt_workers);
+
 static struct {
   interrupt_handler_t handler;
+  void (*thread_handler)(int, void *);
   void *handler_arg;
+  int cpu;
 } interrupt_handlers[INTERRUPT_HANDLER_MAX];
 
+// Start the bottom half workers of the current CPU if not yet running
+static void
+interrupt_worker_start(void)
+{
+  struct InterruptWorker *worker;
+  struct Page *stack_page;
+  int cpu = k_cpu_id();
+  int i;
+
+  worker = &K_PERCPU_GET(interrupt_workers, cpu);
+  if (worker->started)
+    return;
+
+  k_semaphore_create(&worker->semaphore, 0);
+  k_spinlock_init(&worker->lock, "irq_worker");
+  worker->pending = 0;
+  worker->running = 0;
+  worker->idle    = 0;
+  worker->started = 1;
+
+  for (i = 0; i < INTERRUPT_WORKERS_PER_CPU; i++) {
+    struct KTask *task = &worker->tasks[i];
+
+    if ((stack_page = page_alloc_one(0, PAGE_TAG_KSTACK)) == NULL)
+      k_panic("cannot create IRQ worker");
+    stack_page->ref_count++;
+
+    if (k_task_create(task, NULL, interrupt_worker_entry, worker,
+                      page2kva(stack_page), PAGE_SIZE, 0) != 0)
+      k_panic("cannot create IRQ worker");
+
+    // Keep the data touched by the drivers in the cache of the CPU that
+    // handles their interrupts
+    k_task_set_affinity(task, K_CPU_MASK(cpu));
+
+    k_task_resume(task);
+  }
+}
+
+/**
+ * Attach a threaded interrupt handler.
+ *
+ * The top half is called from the interrupt context with the line masked. Its
+ * return value is a combination of INTERRUPT_UNMASK to unmask the line
+ * immediately and INTERRUPT_WAKE_THREAD to schedule the bottom half. The
+ * bottom half is run by one of the worker tasks of the current CPU and may
+ * sleep. Bottom halves of different lines may run concurrently, but the bottom
+ * half of one line never runs in parallel with itself. If the line is left
+ * masked, the bottom half must unmask it when done.
+ *
+ * @param irq            The interrupt line.
+ * @param handler        The top half, or NULL to always run the bottom half
+ *                       with the line masked.
+ * @param thread_handler The bottom half.
+ * @param handler_arg    Argument passed to both handlers.
+ */
 void
-interrupt_attach(int irq, interrupt_handler_t handler, void *handler_arg)
+interrupt_attach_threaded(int irq, interrupt_handler_t handler,
+                          void (*thread_handler)(int, void *),
+                          void *handler_arg)
 {
   if ((irq < 0) || (irq >= INTERRUPT_HANDLER_MAX))
     k_panic("invalid interrupt id %d", irq);
 
-  if (interrupt_handlers[irq].handler != NULL)
+  if ((interrupt_handlers[irq].handler != NULL) ||
+      (interrupt_handlers[irq].thread_handler != NULL))
     k_panic("interrupt handler %d already attached", irq);
 
-  interrupt_handlers[irq].handler     = handler;
-  interrupt_handlers[irq].handler_arg = handler_arg;
+  if (thread_handler != NULL)
+    interrupt_worker_start();
+
+  interrupt_handlers[irq].handler        = handler;
+  interrupt_handlers[irq].thread_handler = thread_handler;
+  interrupt_handlers[irq].handler_arg    = handler_arg;
+  interrupt_handlers[irq].cpu            = k_cpu_id();
 
   arch_interrupt_enable(irq, k_cpu_id());
   arch_interrupt_unmask(irq);
 }
 
 void
-interrupt_attach_task(int irq, void (*handler)(int, void *), void *handler_arg)
+interrupt_attach(int irq, interrupt_handler_t handler, void *handler_arg)
 {
-  struct Page *stack_page;
-  struct InterruptTask *isr;
-  uint8_t *stack;
-
-  if ((isr = k_malloc(sizeof(struct InterruptTask))) == NULL)
-    k_panic("cannot allocate IRQ task strucure");
-
-  if ((stack_page = page_alloc_one(0, PAGE_TAG_KSTACK)) == NULL)
-    k_panic("cannot create IRQ task");
-
-  stack = (uint8_t *) page2kva(stack_page);
-  stack_page->ref_count++;
-
-  if (k_task_create(&isr->task, NULL, interrupt_task_entry, isr, stack, PAGE_SIZE, 0) != 0)
-    k_panic("cannot create IRQ task");
-
-  k_semaphore_create(&isr->semaphore, 0);
-  isr->irq         = irq;
-  isr->handler     = handler;
-  isr->handler_arg = handler_arg;
-
-  interrupt_attach(irq, interrupt_task_notify, isr);
+  interrupt_attach_threaded(irq, handler, NULL, handler_arg);
+}
 
-  k_task_resume(&isr->task);
+void
+interrupt_attach_task(int irq, void (*handler)(int, void *), void *handler_arg)
+{
+  interrupt_attach_threaded(irq, NULL, handler, handler_arg);
 }
 
 void
@@ -80,6 +140,9 @@ interrupt_dispatch(struct TrapFrame *tf)
 
   k_irq_handler_begin();
 
+  TRACE(TRACE_IRQ_ENTER, irq, 0);
+  K_PERCPU_THIS(cpu_stats).irqs[irq]++;
+
   arch_interrupt_mask(irq);
 
   arch_interrupt_eoi(irq);
@@ -88,45 +151,98 @@ interrupt_dispatch(struct TrapFrame *tf)
   if (should_unmask)
     arch_interrupt_unmask(irq);
 
+  // Record before a possible switch to another task
+  TRACE(TRACE_IRQ_EXIT, irq, 0);
+
   k_irq_handler_end();
 }
 
+// Schedule the bottom half of the given interrupt
+static void
+interrupt_wake_thread(int irq)
+{
+  struct InterruptWorker *worker;
+  uint64_t mask = 1ULL << irq;
+  int wake = 0;
+
+  worker = &K_PERCPU_GET(interrupt_workers, interrupt_handlers[irq].cpu);
+
+  k_spinlock_acquire(&worker->lock);
+
+  // If the line is already pending or running, the worker that takes it (or
+  // finishes it) runs the bottom half again, so notify an idle worker only
+  // when there is new work for it
+  if (!(worker->pending & mask) && !(worker->running & mask) &&
+      (worker->idle > 0)) {
+    worker->idle--;
+    wake = 1;
+  }
+  worker->pending |= mask;
+
+  k_spinlock_release(&worker->lock);
+
+  if (wake)
+    k_semaphore_put(&worker->semaphore);
+}
+
 static int
 interrupt_handler_call(int irq)
 {
-  if (interrupt_handlers[irq].handler)
-    return interrupt_handlers[irq].handler(irq,
-                                           interrupt_handlers[irq].handler_arg);
- 
-  // TODO: warn
-  k_warn("Unexpected IRQ %d from CPU %d\n", irq, k_cpu_id());
+  int r;
 
-  return 1;
+  if (interrupt_handlers[irq].handler != NULL)
+    r = interrupt_handlers[irq].handler(irq,
+                                        interrupt_handlers[irq].handler_arg);
+  else if (interrupt_handlers[irq].thread_handler != NULL)
+    r = INTERRUPT_WAKE_THREAD;
+  else {
+    // TODO: warn
+    k_warn("Unexpected IRQ %d from CPU %d\n", irq, k_cpu_id());
+    return INTERRUPT_UNMASK;
+  }
+
+  if ((r & INTERRUPT_WAKE_THREAD) && (interrupt_handlers[irq].thread_handler != NULL))
+    interrupt_wake_thread(irq);
+
+  return r & INTERRUPT_UNMASK;
 }
 
 static void
-interrupt_task_entry(void *arg)
+interrupt_worker_entry(void *arg)
 {
-  struct InterruptTask *isr = (struct InterruptTask *) arg;
+  struct InterruptWorker *worker = (struct InterruptWorker *) arg;
+  uint64_t available;
+  int irq;
 
+  // Keep running the bottom halves of the lines that fired in the meantime
+  // without going to sleep
   for (;;) {
-    if (k_semaphore_get(&isr->semaphore, K_SLEEP_UNWAKEABLE) < 0)
-      k_panic("k_semaphore_get");
+    k_spinlock_acquire(&worker->lock);
 
-    isr->handler(isr->irq, isr->handler_arg);
-  }
-}
+    // Skip the lines whose bottom half is being run by another worker, it
+    // will pick them up again when done
+    available = worker->pending & ~worker->running;
 
-static int
-interrupt_task_notify(int irq, void *arg)
-{
-  struct InterruptTask *isr = (struct InterruptTask *) arg;
+    if (available == 0) {
+      worker->idle++;
+      k_spinlock_release(&worker->lock);
 
-  (void) irq;
-  k_semaphore_put(&isr->semaphore);
+      if (k_semaphore_get(&worker->semaphore, K_SLEEP_UNWAKEABLE) < 0)
+        k_panic("k_semaphore_get");
+      continue;
+    }
 
-  // Do not re-enable the interrupt now, the handler task will do it
-  return 0;
-}
+    irq = __builtin_ctzll(available);
+    worker->pending &= ~(1ULL << irq);
+    worker->running |= 1ULL << irq;
 
-// TODO: detach
+    k_spinlock_release(&worker->lock);
+
+    interrupt_handlers[irq].thread_handler(irq,
+                                           interrupt_handlers[irq].handler_arg);
+
+    k_spinlock_acquire(&worker->lock);
+    worker->running &= ~(1ULL << irq);
+    k_spinlock_release(&worker->lock);
+  }
+}
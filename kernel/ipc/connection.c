@@ -8,11 +8,13 @@
 
 #include <kernel/core/assert.h>
 #include <kernel/console.h>
+#include <kernel/cpu_stat.h>
 #include <kernel/ipc.h>
 #include <kernel/fs/fs.h>
 #include <kernel/object_pool.h>
 #include <kernel/core/spinlock.h>
 #include <kernel/net.h>
+#include <kernel/trace.h>
 #include <kernel/pipe.h>
 #include <kernel/process.h>
 #include <kernel/time.h>
@@ -38,8 +40,8 @@ connection_alloc(struct Connection **fstore)
     return -ENOMEM;
 
   f->type      = 0;
-  f->ref_count = 0;
   f->flags     = 0;
+  k_refcount_init(&f->ref_count, 0);
   f->node      = NULL;
   f->endpoint  = NULL;
 
@@ -52,9 +54,7 @@ connection_alloc(struct Connection **fstore)
 struct Connection *
 connection_ref(struct Connection *connection)
 {
-  k_spinlock_acquire(&connection_lock);
-  connection->ref_count++;
-  k_spinlock_release(&connection_lock);
+  k_refcount_get(&connection->ref_count);
 
   return connection;
 }
@@ -86,30 +86,22 @@ connection_set_flags(struct Connection *connection, int flags)
 void
 connection_unref(struct Connection *connection)
 {
+  struct IpcMessage msg;
   int ref_count;
-  
-  k_spinlock_acquire(&connection_lock);
-
-  if (connection->ref_count < 1)
-    k_panic("bad ref_count %d", ref_count);
-
-  if (connection->ref_count == 1) {
-    struct IpcMessage msg;
-
-    k_spinlock_release(&connection_lock);
-
-    msg.type = IPC_MSG_CLOSE;
-    connection_send(connection, &msg, sizeof(msg), NULL, 0);
 
-    k_spinlock_acquire(&connection_lock);
-  };
+  // Fast path: other references remain, so the connection stays open
+  if (k_refcount_put_above(&connection->ref_count, 0))
+    return;
 
-  ref_count = --connection->ref_count;
+  // This is the last reference, so nobody else can drop or take one
+  // concurrently
+  if ((ref_count = k_refcount_read(&connection->ref_count)) != 1)
+    k_panic("bad ref_count %d", ref_count);
 
-  k_spinlock_release(&connection_lock);
+  msg.type = IPC_MSG_CLOSE;
+  connection_send(connection, &msg, sizeof(msg), NULL, 0);
 
-  if (ref_count > 0)
-    return;
+  k_refcount_put(&connection->ref_count);
 
   if (connection->node != NULL) {
     fs_path_node_unref(connection->node);
@@ -226,7 +218,10 @@ connection_send(struct Connection *connection, void *smsg, size_t sbytes, void *
 
   request_dup(req);
 
-  if (k_mailbox_timed_send(&connection->endpoint->mbox, &req, timeout, K_SLEEP_UNWAKEABLE) < 0) {
+  TRACE(TRACE_IPC_SEND_BEGIN, req, connection->endpoint);
+  cpu_stat_inc(CPU_STAT_IPC_MESSAGES);
+
+  if (endpoint_send(connection->endpoint, req, timeout) < 0) {
     k_panic("fail send:\n");
     request_destroy(req);
     request_destroy(req);
@@ -246,6 +241,8 @@ connection_send(struct Connection *connection, void *smsg, size_t sbytes, void *
 
   r = req->r;
 
+  TRACE(TRACE_IPC_SEND_END, req, r);
+
   request_destroy(req);
 
   return r;
@@ -288,7 +285,10 @@ connection_sendv(struct Connection *connection,
 
   request_dup(req);
 
-  if (k_mailbox_timed_send(&connection->endpoint->mbox, &req, timeout, K_SLEEP_UNWAKEABLE) < 0) {
+  TRACE(TRACE_IPC_SEND_BEGIN, req, connection->endpoint);
+  cpu_stat_inc(CPU_STAT_IPC_MESSAGES);
+
+  if (endpoint_send(connection->endpoint, req, timeout) < 0) {
     k_panic("fail send:\n");
     request_destroy(req);
     request_destroy(req);
@@ -304,6 +304,8 @@ connection_sendv(struct Connection *connection,
 
   r = req->r;
 
+  TRACE(TRACE_IPC_SEND_END, req, r);
+
   request_destroy(req);
 
   return r;
@@ -1,16 +1,289 @@
+#include <kernel/core/assert.h>
+#include <kernel/core/cpu.h>
+#include <kernel/core/task.h>
 #include <kernel/ipc.h>
+#include <kernel/object_pool.h>
+#include <kernel/page.h>
+#include <kernel/time.h>
+#include <kernel/trace.h>
 
+// Idle workers (except for the last one) exit after this many ticks without
+// requests
+#define ENDPOINT_IDLE_TIMEOUT   (5 * TICKS_PER_SECOND)
+
+struct EndpointWorker {
+  struct KTask     task;
+  struct Endpoint *endpoint;
+};
+
+static void endpoint_worker_entry(void *);
+
+// All endpoints, for the statistics
+static K_LIST_DECLARE(endpoint_list);
+static struct KSpinLock endpoint_list_lock =
+  K_SPINLOCK_INITIALIZER("endpoint_list");
+
+// Workers that have exited but whose stacks are not freed yet
+static K_LIST_DECLARE(endpoint_dead_workers);
+static struct KSpinLock endpoint_dead_lock =
+  K_SPINLOCK_INITIALIZER("endpoint_dead");
+
+// Start a new worker task. The caller must have already accounted for it in
+// endpoint->workers
+static int
+endpoint_worker_create(struct Endpoint *endpoint)
+{
+  struct EndpointWorker *worker;
+  struct Page *kstack;
+
+  if ((worker = k_malloc(sizeof(struct EndpointWorker))) == NULL)
+    return -ENOMEM;
+
+  if ((kstack = page_alloc_one(0, PAGE_TAG_KSTACK)) == NULL) {
+    k_free(worker);
+    return -ENOMEM;
+  }
+
+  kstack->ref_count++;
+
+  worker->endpoint = endpoint;
+
+  k_task_create(&worker->task, NULL, endpoint_worker_entry, worker,
+                page2kva(kstack), PAGE_SIZE, 0);
+  k_task_set_affinity(&worker->task, endpoint->cpus);
+  k_task_resume(&worker->task);
+
+  return 0;
+}
+
+/**
+ * Initialize an endpoint and start its first worker task.
+ *
+ * More workers are started when requests are queued and no worker is idle,
+ * up to the given limit. Idle workers above one exit after a timeout.
+ *
+ * @param endpoint    The endpoint to initialize.
+ * @param name        Name displayed in the statistics.
+ * @param handler     Function to handle each received request.
+ * @param handler_arg Argument passed to the handler.
+ * @param cpus        Mask of CPUs to run the workers on.
+ * @param workers_max The maximum number of workers.
+ */
 void
-endpoint_init(struct Endpoint *endpoint)
+endpoint_init(struct Endpoint *endpoint, const char *name,
+              endpoint_handler_t handler, void *handler_arg,
+              unsigned long cpus, int workers_max)
 {
+  size_t capacity;
+
+  k_assert(workers_max > 0);
+
+  // Leave room for a backlog while the pool is growing. The mailbox capacity
+  // must be a power of two.
+  for (capacity = 1; capacity < 2 * (size_t) workers_max; capacity <<= 1)
+    ;
+
+  endpoint->mbox_buf = k_malloc(K_MAILBOX_BUF_SIZE(capacity, sizeof(void *)));
+  if (endpoint->mbox_buf == NULL)
+    k_panic("cannot allocate endpoint mailbox");
+
   k_mailbox_create(&endpoint->mbox,
                    sizeof(void *),
-                   &endpoint->mbox_buf,
-                   sizeof endpoint->mbox_buf);
+                   endpoint->mbox_buf,
+                   K_MAILBOX_BUF_SIZE(capacity, sizeof(void *)));
+
+  k_spinlock_init(&endpoint->lock, "endpoint");
+  endpoint->name        = name;
+  endpoint->handler     = handler;
+  endpoint->handler_arg = handler_arg;
+  endpoint->cpus        = cpus;
+  endpoint->workers_max = workers_max;
+  endpoint->workers     = 1;
+  endpoint->idle        = 0;
+  endpoint->queued      = 0;
+  endpoint->queued_max  = 0;
+
+  k_spinlock_acquire(&endpoint_list_lock);
+  k_list_add_back(&endpoint_list, &endpoint->link);
+  k_spinlock_release(&endpoint_list_lock);
+
+  if (endpoint_worker_create(endpoint) != 0)
+    k_panic("cannot create endpoint worker");
+}
+
+/**
+ * Send a request to an endpoint.
+ *
+ * If there are more queued requests than idle workers, a new worker is
+ * started (unless the limit is reached).
+ *
+ * @param endpoint The endpoint to send to.
+ * @param req      The request.
+ * @param timeout  Maximum time to wait for room in the queue, in ticks.
+ *
+ * @return 0 on success, or a negative error code.
+ */
+int
+endpoint_send(struct Endpoint *endpoint, struct Request *req,
+              k_tick_t timeout)
+{
+  int grow, r;
+
+  k_spinlock_acquire(&endpoint->lock);
+
+  if (++endpoint->queued > endpoint->queued_max)
+    endpoint->queued_max = endpoint->queued;
+
+  grow = (endpoint->queued > endpoint->idle) &&
+         (endpoint->workers < endpoint->workers_max);
+  if (grow)
+    endpoint->workers++;
+
+  k_spinlock_release(&endpoint->lock);
+
+  // If out of memory, the request will be handled by one of the existing
+  // workers
+  if (grow && (endpoint_worker_create(endpoint) != 0)) {
+    k_spinlock_acquire(&endpoint->lock);
+    endpoint->workers--;
+    k_spinlock_release(&endpoint->lock);
+  }
+
+  r = k_mailbox_timed_send(&endpoint->mbox, &req, timeout, K_SLEEP_UNWAKEABLE);
+
+  if (r < 0) {
+    k_spinlock_acquire(&endpoint->lock);
+    endpoint->queued--;
+    k_spinlock_release(&endpoint->lock);
+  }
+
+  return r;
+}
+
+static void
+endpoint_worker_entry(void *arg)
+{
+  struct EndpointWorker *worker = (struct EndpointWorker *) arg;
+  struct Endpoint *endpoint = worker->endpoint;
+  struct Request *req;
+  int r;
+
+  for (;;) {
+    k_spinlock_acquire(&endpoint->lock);
+    endpoint->idle++;
+    k_spinlock_release(&endpoint->lock);
+
+    r = k_mailbox_timed_receive(&endpoint->mbox, &req, ENDPOINT_IDLE_TIMEOUT,
+                                K_SLEEP_UNWAKEABLE);
+
+    k_spinlock_acquire(&endpoint->lock);
+
+    endpoint->idle--;
+
+    if (r == 0) {
+      endpoint->queued--;
+    } else if ((endpoint->workers > 1) &&
+               (endpoint->queued <= endpoint->idle)) {
+      // Nobody is counting on this worker to handle a queued request
+      endpoint->workers--;
+      k_spinlock_release(&endpoint->lock);
+
+      k_task_exit();
+    }
+
+    k_spinlock_release(&endpoint->lock);
+
+    if (r != 0)
+      continue;
+
+    TRACE(TRACE_IPC_RECEIVE, req, endpoint);
+
+    endpoint->handler(endpoint->handler_arg, req);
+  }
 }
 
+/**
+ * Called when a task is destroyed. If it is an endpoint worker, its memory is
+ * freed later, once the task no longer runs on its stack.
+ */
+void
+endpoint_on_task_destroy(struct KTask *task)
+{
+  if (task->entry != endpoint_worker_entry)
+    return;
+
+  k_spinlock_acquire(&endpoint_dead_lock);
+  k_list_add_back(&endpoint_dead_workers, &task->link);
+  k_spinlock_release(&endpoint_dead_lock);
+}
+
+/**
+ * Free the memory of the exited worker tasks.
+ */
+void
+endpoint_idle(void)
+{
+  k_spinlock_acquire(&endpoint_dead_lock);
+
+  while (!k_list_is_empty(&endpoint_dead_workers)) {
+    struct EndpointWorker *worker;
+    struct Page *kstack;
+
+    worker = K_CONTAINER_OF(endpoint_dead_workers.next, struct EndpointWorker,
+                            task.link);
+    k_list_remove(&worker->task.link);
+
+    k_spinlock_release(&endpoint_dead_lock);
+
+    kstack = kva2page(worker->task.kstack);
+    page_assert(kstack, 0, PAGE_TAG_KSTACK);
+
+    kstack->ref_count--;
+    page_free_one(kstack);
+
+    k_free(worker);
+
+    k_spinlock_acquire(&endpoint_dead_lock);
+  }
+
+  k_spinlock_release(&endpoint_dead_lock);
+}
+
+/**
+ * Get the statistics of all endpoints.
+ *
+ * @param info Array to store the statistics.
+ * @param max  The maximum number of entries to store.
+ *
+ * @return The number of entries stored.
+ */
 int
-endpoint_receive(struct Endpoint *endpoint, struct Request **req_store)
+endpoint_stat(struct EndpointInfo *info, int max)
 {
-  return k_mailbox_receive(&endpoint->mbox, req_store, K_SLEEP_UNWAKEABLE);
+  struct KListLink *l;
+  int n = 0;
+
+  k_spinlock_acquire(&endpoint_list_lock);
+
+  K_LIST_FOREACH(&endpoint_list, l) {
+    struct Endpoint *endpoint = K_CONTAINER_OF(l, struct Endpoint, link);
+
+    if (n >= max)
+      break;
+
+    k_spinlock_acquire(&endpoint->lock);
+    info[n].name        = endpoint->name;
+    info[n].workers     = endpoint->workers;
+    info[n].workers_max = endpoint->workers_max;
+    info[n].idle        = endpoint->idle;
+    info[n].queued      = endpoint->queued;
+    info[n].queued_max  = endpoint->queued_max;
+    k_spinlock_release(&endpoint->lock);
+
+    n++;
+  }
+
+  k_spinlock_release(&endpoint_list_lock);
+
+  return n;
 }
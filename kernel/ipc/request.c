@@ -1,6 +1,7 @@
 #include <kernel/ipc.h>
 #include <kernel/vmspace.h>
 #include <kernel/object_pool.h>
+#include <kernel/trace.h>
 
 struct Request *
 request_create(void)
@@ -11,7 +12,6 @@ request_create(void)
     return NULL;
 
   k_semaphore_create(&req->sem, 0);
-  k_spinlock_init(&req->lock, "req");
   
   req->process = NULL;
   req->connection = NULL;
@@ -26,7 +26,7 @@ request_create(void)
   req->recv_idx = 0;
   req->recv_pos = 0;
   
-  req->ref_count = 1;
+  k_refcount_init(&req->ref_count, 1);
 
   return req;
 }
@@ -34,20 +34,10 @@ request_create(void)
 void
 request_destroy(struct Request *req)
 {
-  int count;
-
-  k_assert(req->ref_count > 0);
-
-  k_spinlock_acquire(&req->lock);
-
   req->connection = NULL;
   req->process = NULL;
 
-  count = --req->ref_count;
-
-  k_spinlock_release(&req->lock);
-
-  if (count == 0) {
+  if (k_refcount_put(&req->ref_count)) {
     if (req->send_iov != NULL)
       k_free(req->send_iov);
     if (req->recv_iov != NULL)
@@ -60,15 +50,15 @@ request_destroy(struct Request *req)
 void
 request_dup(struct Request *req)
 {
-  k_spinlock_acquire(&req->lock);
-  req->ref_count++;
-  k_spinlock_release(&req->lock);
+  k_refcount_get(&req->ref_count);
 }
 
 
 void
 request_reply(struct Request *req, intptr_t r)
 {
+  TRACE(TRACE_IPC_REPLY, req, r);
+
   req->r = r;
 
   k_semaphore_put(&req->sem);
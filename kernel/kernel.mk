@@ -14,13 +14,50 @@ ifdef PROCESS_NAME
 	KERNEL_MAIN_CFLAGS := -DPROCESS_NAME=$(PROCESS_NAME)
 endif
 
+# Run the spinlock contention benchmark at boot
+ifdef LOCKBENCH
+	KERNEL_MAIN_CFLAGS += -DLOCKBENCH
+endif
+
+# Collect lock contention statistics (see the `lockstat` monitor command)
+ifdef LOCKSTAT
+	KERNEL_CFLAGS += -DLOCKSTAT
+endif
+
+# Collect latency statistics (see the `latstat` monitor command)
+ifdef LATSTAT
+	KERNEL_CFLAGS += -DLATSTAT
+endif
+
+# Partition the service tasks onto dedicated CPUs, e.g. `make FS_CPUS=0x2`
+ifdef FS_CPUS
+	KERNEL_CFLAGS += -DFS_SERVICE_CPUS=$(FS_CPUS)
+endif
+ifdef PIPE_CPUS
+	KERNEL_CFLAGS += -DPIPE_SERVICE_CPUS=$(PIPE_CPUS)
+endif
+ifdef NET_CPUS
+	KERNEL_CFLAGS += -DNET_SERVICE_CPUS=$(NET_CPUS)
+endif
+
+# Limit the number of service tasks, e.g. `make FS_WORKERS=8`
+ifdef FS_WORKERS
+	KERNEL_CFLAGS += -DFS_SERVICE_WORKERS_MAX=$(FS_WORKERS)
+endif
+ifdef PIPE_WORKERS
+	KERNEL_CFLAGS += -DPIPE_SERVICE_WORKERS_MAX=$(PIPE_WORKERS)
+endif
+
 KERNEL_SRCFILES := \
   kernel/core/condvar.c \
  	kernel/core/cpu.c \
 	kernel/core/irq.c \
+	kernel/core/latency_stat.c \
+	kernel/core/lock_stat.c \
 	kernel/core/mutex.c \
 	kernel/core/semaphore.c \
 	kernel/core/mailbox.c \
+	kernel/core/rcu.c \
 	kernel/core/timer.c \
 	kernel/core/task.c \
 	kernel/core/sched.c \
@@ -57,14 +94,19 @@ KERNEL_SRCFILES := \
 	kernel/process/signal.c \
 	kernel/process/vmspace.c \
 	kernel/console.c \
+	kernel/cpu_stat.c \
 	kernel/dev.c \
+	kernel/futex.c \
 	kernel/hooks.c \
+	kernel/hrtimer.c \
 	kernel/interrupt.c \
 	kernel/kdebug.c \
+	kernel/lockbench.c \
 	kernel/monitor.c \
 	kernel/pipe.c \
 	kernel/syscall.c \
 	kernel/time.c \
+	kernel/trace.c \
 	kernel/tty.c \
 	kernel/main.c
 
@@ -0,0 +1,173 @@
+/*
+ * Spinlock contention microbenchmark.
+ *
+ * For each number of CPUs from 1 up to K_CPU_MAX, start that many worker tasks
+ * hammering a single spinlock for a fixed period and report the throughput and
+ * the spread of acquisitions between the workers. The workers never block, so
+ * idle CPUs steal them and each one ends up running on a separate CPU (as long
+ * as there are enough CPUs online).
+ *
+ * Build the kernel with `make LOCKBENCH=1` to run the benchmark at boot.
+ */
+
+#include <kernel/console.h>
+#include <kernel/core/cpu.h>
+#include <kernel/core/semaphore.h>
+#include <kernel/core/spinlock.h>
+#include <kernel/core/task.h>
+#include <kernel/hrtimer.h>
+#include <kernel/lockbench.h>
+#include <kernel/page.h>
+#include <kernel/time.h>
+
+// Measurement period for each round
+#define LOCKBENCH_TICKS   TICKS_PER_SECOND
+
+static struct KSpinLock lockbench_lock = K_SPINLOCK_INITIALIZER("lockbench");
+static unsigned long long lockbench_shared;
+
+static struct {
+  struct KTask       task;
+  struct KSemaphore  start;
+  unsigned long long count;
+} lockbench_workers[K_CPU_MAX];
+
+static struct KTask      lockbench_task;
+static struct KSemaphore lockbench_done;
+
+static volatile int lockbench_ready;
+static volatile int lockbench_go;
+static volatile int lockbench_stop;
+
+static void
+lockbench_worker(void *arg)
+{
+  int id = (int) arg;
+
+  for (;;) {
+    unsigned long long count = 0;
+
+    k_semaphore_get(&lockbench_workers[id].start, K_SLEEP_UNWAKEABLE);
+
+    k_spinlock_acquire(&lockbench_lock);
+    lockbench_ready++;
+    k_spinlock_release(&lockbench_lock);
+
+    while (!lockbench_go)
+      ;
+
+    while (!lockbench_stop) {
+      k_spinlock_acquire(&lockbench_lock);
+      lockbench_shared++;
+      k_spinlock_release(&lockbench_lock);
+
+      count++;
+    }
+
+    lockbench_workers[id].count = count;
+
+    k_semaphore_put(&lockbench_done);
+  }
+}
+
+static void
+lockbench_round(int ncpus)
+{
+  unsigned long long total, min, max;
+  uint64_t start, elapsed;
+  struct KSemaphore delay;
+  int i;
+
+  lockbench_ready = 0;
+  lockbench_go    = 0;
+  lockbench_stop  = 0;
+
+  k_semaphore_create(&delay, 0);
+
+  for (i = 0; i < ncpus; i++)
+    k_semaphore_put(&lockbench_workers[i].start);
+
+  // Let the workers migrate to idle CPUs
+  while (lockbench_ready < ncpus)
+    k_semaphore_timed_get(&delay, 1, K_SLEEP_UNWAKEABLE);
+
+  start = hrtimer_now();
+  lockbench_go = 1;
+
+  k_semaphore_timed_get(&delay, LOCKBENCH_TICKS, K_SLEEP_UNWAKEABLE);
+
+  lockbench_stop = 1;
+  elapsed = hrtimer_now() - start;
+
+  k_semaphore_destroy(&delay);
+
+  for (i = 0; i < ncpus; i++)
+    k_semaphore_get(&lockbench_done, K_SLEEP_UNWAKEABLE);
+
+  total = 0;
+  min = max = lockbench_workers[0].count;
+
+  for (i = 0; i < ncpus; i++) {
+    unsigned long long count = lockbench_workers[i].count;
+
+    total += count;
+    if (count < min)
+      min = count;
+    if (count > max)
+      max = count;
+  }
+
+  cprintf("lockbench: %d cpu(s): %llu ops/s, %llu ns/op, min %llu max %llu\n",
+          ncpus,
+          total * 1000000000ULL / elapsed,
+          total != 0 ? elapsed / total : 0,
+          min, max);
+}
+
+static void
+lockbench_main(void *)
+{
+  int ncpus;
+
+  for (ncpus = 1; ncpus <= K_CPU_MAX; ncpus++)
+    lockbench_round(ncpus);
+
+  k_task_exit();
+}
+
+static void *
+lockbench_stack_alloc(void)
+{
+  struct Page *page;
+
+  if ((page = page_alloc_one(0, 0)) == NULL)
+    k_panic("out of memory");
+
+  page->ref_count++;
+
+  return page2kva(page);
+}
+
+/**
+ * Start the spinlock contention benchmark.
+ */
+void
+lockbench_init(void)
+{
+  int i;
+
+  k_semaphore_create(&lockbench_done, 0);
+
+  // Workers have a lower priority, so they cannot delay the controlling task
+  for (i = 0; i < K_CPU_MAX; i++) {
+    k_semaphore_create(&lockbench_workers[i].start, 0);
+
+    k_task_create(&lockbench_workers[i].task, NULL, lockbench_worker,
+                  (void *) i, lockbench_stack_alloc(), PAGE_SIZE, NZERO);
+    k_task_resume(&lockbench_workers[i].task);
+  }
+
+  k_task_create(&lockbench_task, NULL, lockbench_main, NULL,
+                lockbench_stack_alloc(), PAGE_SIZE, 0);
+  k_task_resume(&lockbench_task);
+}
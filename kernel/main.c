@@ -9,6 +9,7 @@
 #include <kernel/tty.h>
 #include <kernel/fs/buf.h>
 #include <kernel/ipc.h>
+#include <kernel/lockbench.h>
 #include <kernel/core/irq.h>
 #include <kernel/core/mailbox.h>
 #include <kernel/core/mutex.h>
@@ -23,6 +24,8 @@
 #include <kernel/net.h>
 #include <kernel/interrupt.h>
 #include <kernel/time.h>
+#include <kernel/trace.h>
+#include <kernel/futex.h>
 
 // For uname()
 struct utsname utsname = {
@@ -80,10 +83,13 @@ main(void)
   arch_init_devices();
 
   // Initialize the remaining kernel services
+  page_reclaim_init();  // Memory reclaim
   buf_init();           // Buffer cache
   connection_init();          // File table
   vm_space_init();      // Virtual memory manager
   pipe_init_system();          // Pipes
+  trace_init();         // Tracepoints
+  futex_init();         // Futexes
   process_init();       // Process table
   //net_init();           // Networking
 
@@ -93,6 +99,10 @@ main(void)
 
   arch_init_smp();
 
+#ifdef LOCKBENCH
+  lockbench_init();
+#endif
+
   // struct KTask *t1, *t2;
 
   // t1 = k_task_create(NULL, test_task, "AAAA", 1);
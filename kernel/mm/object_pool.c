@@ -3,6 +3,9 @@
 #include <string.h>
 
 #include <kernel/core/assert.h>
+#include <kernel/core/cpu.h>
+#include <kernel/core/irq.h>
+#include <kernel/core/percpu.h>
 #include <kernel/core/types.h>
 
 #include <kernel/console.h>
@@ -22,7 +25,9 @@
  * reducing the allocation time.
  * 
  * General-purpose allocation routines ('k_malloc' and 'k_free') are implemented
- * using an internal set of "anonymous" pools of various predefined sizes.
+ * using an internal set of "anonymous" pools of various predefined sizes. There
+ * are four size classes per each power of two (except for the smallest sizes),
+ * so no more than 20% of each allocated block is wasted.
  * 
  * Implementation
  * --------------
@@ -41,6 +46,17 @@
  *    the corresponding page descriptor so given an object pointer we can easily
  *    determine the slab (and the pool) this object belongs to. This eliminates
  *    the need to have a per-cache hash table for mapping objects to bufctls.
+ * 4. Following the paper "Magazines and Vmem" by Jeff Bonwick and Jonathan
+ *    Adams, each pool has a per-CPU layer of two magazines (stacks of free
+ *    constructed objects), backed by a depot of full and empty magazines.
+ *    Most allocations and deallocations just pop or push an object on the
+ *    loaded magazine of the current CPU with interrupts disabled, without
+ *    taking the pool lock. The lock is taken only to exchange magazines with
+ *    the depot, or to go to the slab layer. Objects cached in the depot are
+ *    returned to the slabs when the pool is reaped.
+ *
+ * Unused slabs are not freed immediately. Instead, all pools are reaped by a
+ * shrinker when the page allocator runs low on memory.
  *
  * For more info on the slab allocator, see the original paper.
  */
@@ -53,6 +69,8 @@ static struct KObjectSlab *k_object_pool_slab_create(struct KObjectPool *);
 static void                k_object_pool_slab_destroy(struct KObjectSlab *);
 static void               *k_object_pool_slab_get(struct KObjectSlab *);
 static void                k_object_pool_slab_put(struct KObjectSlab *, void *);                            
+static void               *k_object_pool_slabs_get(struct KObjectPool *);
+static void                k_object_pool_slabs_put(struct KObjectPool *, void *);
 
 /** Linked list to keep track of all object pools in the system */
 static struct {
@@ -65,11 +83,53 @@ static struct {
 
 /** Pool of pool descriptors */
 static struct KObjectPool pool_of_pools;
+/** Pool of magazines (doesn't use magazines itself) */
+static struct KObjectPool magazine_pool;
+
+static unsigned k_object_pool_shrink(unsigned);
+
+static struct PageShrinker k_object_pool_shrinker = {
+  .name   = "object_pools",
+  .shrink = k_object_pool_shrink,
+};
+
+/** Size classes of the anonymous pools */
+static const size_t anon_sizes[] = {
+  8,    16,    24,    32,
+  40,   48,    56,    64,
+  80,   96,    112,   128,
+  160,  192,   224,   256,
+  320,  384,   448,   512,
+  640,  768,   896,   1024,
+  1280, 1536,  1792,  2048,
+  2560, 3072,  3584,  4096,
+  5120, 6144,  7168,  8192,
+  10240, 12288, 14336, 16384,
+};
+
+#define ANON_POOLS_LENGTH     ARRAY_SIZE(anon_sizes)
+#define ANON_POOLS_MAX_SIZE   16384U
+
+// Size-to-class lookup tables. Sizes up to ANON_SMALL_MAX are looked up with
+// 8-byte granularity, larger ones with 128-byte granularity (all classes above
+// ANON_SMALL_MAX are multiples of 256)
+#define ANON_SMALL_MAX        1024U
+#define ANON_SMALL_SHIFT      3
+#define ANON_LARGE_SHIFT      7
+
+static uint8_t anon_small_index[(ANON_SMALL_MAX >> ANON_SMALL_SHIFT) + 1];
+static uint8_t anon_large_index[(ANON_POOLS_MAX_SIZE >> ANON_LARGE_SHIFT) + 1];
+
+struct KMallocCpu {
+  struct {
+    unsigned long      allocs;
+    unsigned long      frees;
+    unsigned long long requested;
+  } classes[ANON_POOLS_LENGTH];
+};
 
-// TODO: maybe there is a better sequence of sizes rather than just powers of 2
-#define ANON_POOLS_LENGTH     12
-#define ANON_POOLS_MIN_SIZE   8U
-#define ANON_POOLS_MAX_SIZE   (ANON_POOLS_MIN_SIZE << (ANON_POOLS_LENGTH - 1))
+/** Per-class k_malloc statistics */
+K_PERCPU_DEFINE_STATIC(struct KMallocCpu, k_malloc_cpus);
 
 /** Set of anonymous pools to be used by k_malloc */
 static struct KObjectPool *anon_pools[ANON_POOLS_LENGTH];
@@ -114,24 +174,39 @@ k_object_pool_create(const char *name,
 int
 k_object_pool_destroy(struct KObjectPool *pool)
 {
-  if (pool == &pool_of_pools)
-    k_panic("trying to destroy the pool of pools");
+  int i;
+
+  if ((pool == &pool_of_pools) || (pool == &magazine_pool))
+    k_panic("trying to destroy %s", pool->name);
 
+  // Nobody should be using the pool anymore, so move the magazines of all CPUs
+  // into the depot, and then destroy all slabs
   k_spinlock_acquire(&pool->lock);
 
-  if (!k_list_is_empty(&pool->slabs_empty) || !k_list_is_empty(&pool->slabs_partial)) {
-    k_spinlock_release(&pool->lock);
-    return -EBUSY;
+  for (i = 0; i < K_CPU_MAX; i++) {
+    struct KObjectPoolCpu *cpu = &pool->cpus[i];
+
+    if (cpu->loaded != NULL) {
+      cpu->loaded->next = pool->depot_full;
+      pool->depot_full  = cpu->loaded;
+    }
+    if (cpu->previous != NULL) {
+      cpu->previous->next = pool->depot_full;
+      pool->depot_full    = cpu->previous;
+    }
+
+    cpu->loaded = cpu->previous = NULL;
   }
 
-  // Destroy all slabs
-  while (!k_list_is_empty(&pool->slabs_full)) {
-    struct KObjectSlab *slab;
+  k_spinlock_release(&pool->lock);
 
-    slab = K_CONTAINER_OF(pool->slabs_full.next, struct KObjectSlab, link);
-    k_list_remove(&slab->link);
+  k_object_pool_reap(pool);
 
-    k_object_pool_slab_destroy(slab);
+  k_spinlock_acquire(&pool->lock);
+
+  if (!k_list_is_empty(&pool->slabs_empty) || !k_list_is_empty(&pool->slabs_partial)) {
+    k_spinlock_release(&pool->lock);
+    return -EBUSY;
   }
 
   k_spinlock_release(&pool->lock);
@@ -145,6 +220,100 @@ k_object_pool_destroy(struct KObjectPool *pool)
   return 0;
 }
 
+// Exchange the loaded and the previous magazines of a CPU
+static void
+k_object_pool_magazine_swap(struct KObjectPoolCpu *cpu)
+{
+  struct KObjectMagazine *tmp = cpu->loaded;
+
+  cpu->loaded   = cpu->previous;
+  cpu->previous = tmp;
+}
+
+// Try to allocate an object from the magazines of the current CPU, exchanging
+// an empty magazine for a full one from the depot, if necessary. The previous
+// magazine is always either full or empty
+static void *
+k_object_pool_magazine_get(struct KObjectPool *pool, struct KObjectPoolCpu *cpu)
+{
+  struct KObjectMagazine *mag;
+
+  if ((cpu->loaded != NULL) && (cpu->loaded->rounds > 0))
+    return cpu->loaded->objs[--cpu->loaded->rounds];
+
+  if ((cpu->previous != NULL) && (cpu->previous->rounds > 0)) {
+    k_object_pool_magazine_swap(cpu);
+    return cpu->loaded->objs[--cpu->loaded->rounds];
+  }
+
+  k_spinlock_acquire(&pool->lock);
+
+  if ((mag = pool->depot_full) != NULL) {
+    pool->depot_full = mag->next;
+
+    if (cpu->previous != NULL) {
+      cpu->previous->next = pool->depot_empty;
+      pool->depot_empty   = cpu->previous;
+    }
+
+    cpu->previous = cpu->loaded;
+    cpu->loaded   = mag;
+  }
+
+  k_spinlock_release(&pool->lock);
+
+  if (mag == NULL)
+    return NULL;
+
+  return cpu->loaded->objs[--cpu->loaded->rounds];
+}
+
+// Free an object into the magazines of the current CPU, exchanging a full
+// magazine for an empty one from the depot (or a newly allocated one), if
+// necessary. Returns -1 if out of memory
+static int
+k_object_pool_magazine_put(struct KObjectPool *pool, struct KObjectPoolCpu *cpu,
+                           void *obj)
+{
+  struct KObjectMagazine *mag;
+
+  if ((cpu->loaded != NULL) && (cpu->loaded->rounds < K_OBJECT_MAGAZINE_SIZE)) {
+    cpu->loaded->objs[cpu->loaded->rounds++] = obj;
+    return 0;
+  }
+
+  if ((cpu->previous != NULL) && (cpu->previous->rounds == 0)) {
+    k_object_pool_magazine_swap(cpu);
+    cpu->loaded->objs[cpu->loaded->rounds++] = obj;
+    return 0;
+  }
+
+  k_spinlock_acquire(&pool->lock);
+  if ((mag = pool->depot_empty) != NULL)
+    pool->depot_empty = mag->next;
+  k_spinlock_release(&pool->lock);
+
+  if (mag == NULL) {
+    if ((mag = k_object_pool_get(&magazine_pool)) == NULL)
+      return -1;
+    mag->rounds = 0;
+  }
+
+  if (cpu->previous != NULL) {
+    k_spinlock_acquire(&pool->lock);
+    cpu->previous->next = pool->depot_full;
+    pool->depot_full    = cpu->previous;
+    k_spinlock_release(&pool->lock);
+  }
+
+  cpu->previous = cpu->loaded;
+  cpu->loaded   = mag;
+
+  cpu->loaded->objs[cpu->loaded->rounds++] = obj;
+
+  return 0;
+}
+
 /**
  * Allocate an object from the pool.
  * 
@@ -154,33 +323,29 @@ k_object_pool_destroy(struct KObjectPool *pool)
 void *
 k_object_pool_get(struct KObjectPool *pool)
 {
-  struct KObjectSlab *slab;
-  void *obj;
-  
-  k_spinlock_acquire(&pool->lock);
+  void *obj = NULL;
 
-  // First, try to use partially full slabs
-  if (!k_list_is_empty(&pool->slabs_partial)) {
-    slab = K_CONTAINER_OF(pool->slabs_partial.next, struct KObjectSlab, link);
-  } else {
-    // Then full slabs
-    if (!k_list_is_empty(&pool->slabs_full)) {
-      slab = K_CONTAINER_OF(pool->slabs_full.next, struct KObjectSlab, link);
-    // Then try to allocate a new slab
-    } else if ((slab = k_object_pool_slab_create(pool)) == NULL) {
-      k_spinlock_release(&pool->lock);
-      k_panic("%s: out of memory\n", pool->name);
-      return NULL;
-    }
+  if (!(pool->flags & K_OBJECT_POOL_NO_MAGAZINES)) {
+    struct KObjectPoolCpu *cpu;
 
-    // Put the selected slab into the partial list. k_object_pool_slab_get() will
-    // put it into the empty list later, if necessary
-    k_list_remove(&slab->link);
-    k_list_add_back(&pool->slabs_partial, &slab->link);
-  } 
+    // Keep running on the same CPU
+    k_irq_state_save();
+
+    cpu = &pool->cpus[k_cpu_id()];
 
-  obj = k_object_pool_slab_get(slab);
+    if ((obj = k_object_pool_magazine_get(pool, cpu)) != NULL)
+      cpu->hits++;
+    else
+      cpu->misses++;
 
+    k_irq_state_restore();
+
+    if (obj != NULL)
+      return obj;
+  }
+
+  k_spinlock_acquire(&pool->lock);
+  obj = k_object_pool_slabs_get(pool);
   k_spinlock_release(&pool->lock);
 
   return obj;
@@ -195,18 +360,163 @@ k_object_pool_get(struct KObjectPool *pool)
 void
 k_object_pool_put(struct KObjectPool *pool, void *obj)
 {
-  struct Page *page;
-  struct KObjectSlab *slab;
+  if (!(pool->flags & K_OBJECT_POOL_NO_MAGAZINES)) {
+    struct Page *page;
+    int r;
+
+    page = kva2page(ROUND_DOWN(obj, PAGE_SIZE << pool->slab_page_order));
+    page_assert(page, pool->slab_page_order, PAGE_TAG_SLAB);
+
+    if (page->slab->pool != pool)
+      k_panic("%s: object %p belongs to %s", pool->name, obj,
+              page->slab->pool->name);
+
+    k_irq_state_save();
+    r = k_object_pool_magazine_put(pool, &pool->cpus[k_cpu_id()], obj);
+    k_irq_state_restore();
+
+    if (r == 0)
+      return;
+  }
 
   k_spinlock_acquire(&pool->lock);
+  k_object_pool_slabs_put(pool, obj);
+  k_spinlock_release(&pool->lock);
+}
 
-  page = kva2page(ROUND_DOWN(obj, PAGE_SIZE << pool->slab_page_order));
-  page_assert(page, pool->slab_page_order, PAGE_TAG_SLAB);
-  slab = page->slab;
+/**
+ * Return the objects cached in the depot to the slabs and free all unused
+ * slabs.
+ *
+ * The magazines loaded by each CPU are left intact.
+ *
+ * @param pool Pointer to the pool descriptor
+ *
+ * @return The number of pages freed.
+ */
+unsigned
+k_object_pool_reap(struct KObjectPool *pool)
+{
+  struct KObjectMagazine *full, *empty, *mag;
+  unsigned count = 0;
+
+  k_spinlock_acquire(&pool->lock);
+
+  full  = pool->depot_full;
+  empty = pool->depot_empty;
+
+  pool->depot_full = pool->depot_empty = NULL;
+
+  for (mag = full; mag != NULL; mag = mag->next)
+    while (mag->rounds > 0)
+      k_object_pool_slabs_put(pool, mag->objs[--mag->rounds]);
+
+  while (!k_list_is_empty(&pool->slabs_full)) {
+    struct KObjectSlab *slab;
+
+    slab = K_CONTAINER_OF(pool->slabs_full.next, struct KObjectSlab, link);
+    k_list_remove(&slab->link);
+
+    k_object_pool_slab_destroy(slab);
 
-  k_object_pool_slab_put(slab, obj);
+    count += 1U << pool->slab_page_order;
+  }
 
   k_spinlock_release(&pool->lock);
+
+  while ((mag = full) != NULL) {
+    full = mag->next;
+    k_object_pool_put(&magazine_pool, mag);
+  }
+
+  while ((mag = empty) != NULL) {
+    empty = mag->next;
+    k_object_pool_put(&magazine_pool, mag);
+  }
+
+  return count;
+}
+
+// Reap all pools under memory pressure
+static unsigned
+k_object_pool_shrink(unsigned)
+{
+  struct KListLink *l;
+  unsigned count = 0;
+
+  k_spinlock_acquire(&pool_list.lock);
+
+  K_LIST_FOREACH(&pool_list.head, l) {
+    struct KObjectPool *pool = K_CONTAINER_OF(l, struct KObjectPool, link);
+
+    count += k_object_pool_reap(pool);
+  }
+
+  k_spinlock_release(&pool_list.lock);
+
+  return count;
+}
+
+/**
+ * Get the statistics of all object pools.
+ *
+ * @param info Array to store the statistics.
+ * @param max  The maximum number of entries to store.
+ *
+ * @return The number of entries stored.
+ */
+int
+k_object_pool_stat(struct KObjectPoolInfo *info, int max)
+{
+  struct KListLink *l, *sl;
+  int i, n = 0;
+
+  k_spinlock_acquire(&pool_list.lock);
+
+  K_LIST_FOREACH(&pool_list.head, l) {
+    struct KObjectPool *pool = K_CONTAINER_OF(l, struct KObjectPool, link);
+    struct KListLink *lists[] = {
+      &pool->slabs_empty, &pool->slabs_partial, &pool->slabs_full,
+    };
+
+    if (n >= max)
+      break;
+
+    strncpy(info[n].name, pool->name, K_OBJECT_POOL_NAME_MAX);
+    info[n].name[K_OBJECT_POOL_NAME_MAX] = '\0';
+
+    info[n].obj_size   = pool->obj_size;
+    info[n].slabs      = 0;
+    info[n].objs_used  = 0;
+    info[n].hits       = 0;
+    info[n].misses     = 0;
+
+    k_spinlock_acquire(&pool->lock);
+
+    for (i = 0; i < 3; i++) {
+      K_LIST_FOREACH(lists[i], sl) {
+        struct KObjectSlab *slab = K_CONTAINER_OF(sl, struct KObjectSlab, link);
+
+        info[n].slabs++;
+        info[n].objs_used += slab->used_count;
+      }
+    }
+
+    k_spinlock_release(&pool->lock);
+
+    info[n].objs_total = info[n].slabs * pool->slab_capacity;
+
+    for (i = 0; i < K_CPU_MAX; i++) {
+      info[n].hits   += pool->cpus[i].hits;
+      info[n].misses += pool->cpus[i].misses;
+    }
+
+    n++;
+  }
+
+  k_spinlock_release(&pool_list.lock);
+
+  return n;
 }
 
 /**
@@ -216,17 +526,25 @@ k_object_pool_put(struct KObjectPool *pool, void *obj)
 void
 k_object_pool_system_init(void)
 { 
-  int i;
+  int i, j;
 
   // First, solve the "chicken and egg" problem by initializing the static
   // pool of pool descriptors
   if (k_object_pool_init(&pool_of_pools, "pool_of_pools",
-                       sizeof(struct KObjectPool), 0, NULL, NULL) < 0)
+                       sizeof(struct KObjectPool), K_CACHE_LINE_SIZE,
+                       NULL, NULL) < 0)
     k_panic("cannot initialize pool_of_pools");
 
+  // Magazines are allocated when freeing objects into other pools, so the
+  // magazine pool itself goes straight to the slabs
+  if (k_object_pool_init(&magazine_pool, "magazines",
+                       sizeof(struct KObjectMagazine), 0, NULL, NULL) < 0)
+    k_panic("cannot initialize magazine pool");
+  magazine_pool.flags |= K_OBJECT_POOL_NO_MAGAZINES;
+
   // Then, initialize the set of anonymous pools used by k_malloc and k_free
-  for (i = 0; i < ANON_POOLS_LENGTH; i++) {
-    size_t size = ANON_POOLS_MIN_SIZE << i;
+  for (i = 0; i < (int) ANON_POOLS_LENGTH; i++) {
+    size_t size = anon_sizes[i];
     char name[K_OBJECT_POOL_NAME_MAX];
 
     snprintf(name, sizeof(name), "anon(%u)", (unsigned) size);
@@ -235,6 +553,33 @@ k_object_pool_system_init(void)
     if (anon_pools[i] == NULL)
       k_panic("cannot initialize %s", name);
   }
+
+  // Fill in the size-to-class lookup tables
+  for (i = 0, j = 0; i < (int) ARRAY_SIZE(anon_small_index); i++) {
+    while (anon_sizes[j] < ((size_t) i << ANON_SMALL_SHIFT))
+      j++;
+    anon_small_index[i] = j;
+  }
+  for (i = 0, j = 0; i < (int) ARRAY_SIZE(anon_large_index); i++) {
+    while (anon_sizes[j] < ((size_t) i << ANON_LARGE_SHIFT))
+      j++;
+    anon_large_index[i] = j;
+  }
+
+  page_shrinker_register(&k_object_pool_shrinker);
+}
+
+// Get the index of the smallest anonymous pool that fits the given size
+static int
+k_malloc_class(size_t size)
+{
+  if (size <= ANON_SMALL_MAX)
+    return anon_small_index[ROUND_UP(size, 1U << ANON_SMALL_SHIFT) >>
+                            ANON_SMALL_SHIFT];
+  if (size <= ANON_POOLS_MAX_SIZE)
+    return anon_large_index[ROUND_UP(size, 1U << ANON_LARGE_SHIFT) >>
+                            ANON_LARGE_SHIFT];
+  return -1;
 }
 
 /**
@@ -248,17 +593,25 @@ k_object_pool_system_init(void)
 void *
 k_malloc(size_t size)
 {
+  struct KMallocCpu *stat;
+  void *ptr;
   int i;
 
-  // Search the anonymous pool of smallest suitable size
-  for (i = 0; i < ANON_POOLS_LENGTH; i++) {
-    size_t pool_size = ANON_POOLS_MIN_SIZE << i;
+  if ((i = k_malloc_class(size)) < 0)
+    return NULL;
+
+  if ((ptr = k_object_pool_get(anon_pools[i])) == NULL)
+    return NULL;
+
+  k_irq_state_save();
 
-    if (size <= pool_size)
-      return k_object_pool_get(anon_pools[i]);
-  }
+  stat = &K_PERCPU_THIS(k_malloc_cpus);
+  stat->classes[i].allocs++;
+  stat->classes[i].requested += size;
 
-  return NULL;
+  k_irq_state_restore();
+
+  return ptr;
 }
 
 /**
@@ -269,14 +622,57 @@ k_malloc(size_t size)
 void
 k_free(void *ptr)
 {
+  struct KObjectPool *pool;
   struct Page *page;
+  int i;
 
   // Determine the slab (and the pool) this pointer belongs to
   page = kva2page(ptr);
   if (page->slab == NULL)
     k_panic("bad pointer");
 
-  k_object_pool_put(page->slab->pool, ptr);
+  pool = page->slab->pool;
+
+  // Only count the blocks allocated by k_malloc
+  i = k_malloc_class(pool->obj_size);
+  if ((i >= 0) && (anon_pools[i] == pool)) {
+    k_irq_state_save();
+    K_PERCPU_THIS(k_malloc_cpus).classes[i].frees++;
+    k_irq_state_restore();
+  }
+
+  k_object_pool_put(pool, ptr);
+}
+
+/**
+ * Get the per-class statistics of the general-purpose allocator.
+ *
+ * @param info Array to store the statistics.
+ * @param max  The maximum number of entries to store.
+ *
+ * @return The number of entries stored.
+ */
+int
+k_malloc_stat(struct KMallocInfo *info, int max)
+{
+  int cpu, n;
+
+  for (n = 0; (n < max) && (n < (int) ANON_POOLS_LENGTH); n++) {
+    info[n].size      = anon_sizes[n];
+    info[n].allocs    = 0;
+    info[n].frees     = 0;
+    info[n].requested = 0;
+
+    for (cpu = 0; cpu < K_CPU_MAX; cpu++) {
+      struct KMallocCpu *stat = &K_PERCPU_GET(k_malloc_cpus, cpu);
+
+      info[n].allocs    += stat->classes[n].allocs;
+      info[n].frees     += stat->classes[n].frees;
+      info[n].requested += stat->classes[n].requested;
+    }
+  }
+
+  return n;
 }
 
 /**
@@ -302,7 +698,7 @@ k_object_pool_init(struct KObjectPool *pool,
 {
   size_t wastage, block_size;
   unsigned slab_page_order, slab_capacity;
-  int flags;
+  int flags, i;
 
   if (size < align)
     return -EINVAL;
@@ -358,6 +754,15 @@ k_object_pool_init(struct KObjectPool *pool,
   pool->obj_dtor        = dtor;
   pool->color_max       = wastage;
   pool->color_next      = 0;
+  pool->depot_full      = NULL;
+  pool->depot_empty     = NULL;
+
+  for (i = 0; i < K_CPU_MAX; i++) {
+    pool->cpus[i].loaded   = NULL;
+    pool->cpus[i].previous = NULL;
+    pool->cpus[i].hits     = 0;
+    pool->cpus[i].misses   = 0;
+  }
 
   k_spinlock_acquire(&pool_list.lock);
   k_list_add_back(&pool_list.head, &pool->link);
@@ -383,6 +788,59 @@ tag_to_object(struct KObjectSlab *slab, struct KObjectTag *tag)
   return (uint8_t *) slab->data + slab->pool->block_size * i;
 }
 
+/**
+ * Allocate an object from the slab layer of the pool.
+ *
+ * @param pool Pointer to the pool descriptor
+ * @return The allocated object of NULL if out of memory.
+ */
+static void *
+k_object_pool_slabs_get(struct KObjectPool *pool)
+{
+  struct KObjectSlab *slab;
+
+  k_assert(k_spinlock_holding(&pool->lock));
+
+  // First, try to use partially full slabs
+  if (!k_list_is_empty(&pool->slabs_partial)) {
+    slab = K_CONTAINER_OF(pool->slabs_partial.next, struct KObjectSlab, link);
+  } else {
+    // Then full slabs
+    if (!k_list_is_empty(&pool->slabs_full)) {
+      slab = K_CONTAINER_OF(pool->slabs_full.next, struct KObjectSlab, link);
+    // Then try to allocate a new slab
+    } else if ((slab = k_object_pool_slab_create(pool)) == NULL) {
+      return NULL;
+    }
+
+    // Put the selected slab into the partial list. k_object_pool_slab_get() will
+    // put it into the empty list later, if necessary
+    k_list_remove(&slab->link);
+    k_list_add_back(&pool->slabs_partial, &slab->link);
+  } 
+
+  return k_object_pool_slab_get(slab);
+}
+
+/**
+ * Return an object to the slab layer of the pool.
+ *
+ * @param pool Pointer to the pool descriptor
+ * @param obj  Pointer to the object to be deallocated
+ */
+static void
+k_object_pool_slabs_put(struct KObjectPool *pool, void *obj)
+{
+  struct Page *page;
+
+  k_assert(k_spinlock_holding(&pool->lock));
+
+  page = kva2page(ROUND_DOWN(obj, PAGE_SIZE << pool->slab_page_order));
+  page_assert(page, pool->slab_page_order, PAGE_TAG_SLAB);
+
+  k_object_pool_slab_put(page->slab, obj);
+}
+
 /**
  * Create a new slab for the given object pool.
  * 
@@ -1,10 +1,18 @@
 #include <string.h>
 
+#include <kernel/core/atomic.h>
+#include <kernel/core/irq.h>
+#include <kernel/core/percpu.h>
+#include <kernel/core/rcu.h>
+#include <kernel/core/semaphore.h>
 #include <kernel/core/spinlock.h>
+#include <kernel/core/task.h>
 #include <kernel/core/types.h>
 
 #include <kernel/console.h>
+#include <kernel/cpu_stat.h>
 #include <kernel/page.h>
+#include <kernel/trace.h>
 #include <kernel/types.h>
 
 /**
@@ -27,6 +35,35 @@
  * When the block is later freed, the allocator checks whether the buddy of the
  * deallocated block is free, in which case two blocks are merged to form a
  * higher order block and placed on the higher free list.
+ *
+ * Per-CPU Page Caches
+ * -------------------
+ *
+ * Most allocations are single pages, so each CPU keeps a small cache of free
+ * order-0 pages in front of the buddy free lists. The cache is refilled from
+ * and drained to the free lists in batches, thus most single page allocations
+ * and deallocations never touch the global page lock. Freed pages are placed
+ * at the front of the cache and allocated first, since they are likely still
+ * hot in the CPU cache; the coldest pages at the back are drained first.
+ *
+ * If the free lists run out of memory, the caches of all CPUs are drained
+ * before giving up.
+ *
+ * Each cache also holds a few pre-zeroed pages, which are prepared while the
+ * CPU is idle. Single page allocations with `PAGE_ALLOC_ZERO` take them first,
+ * and zero a page synchronously only if none are left.
+ *
+ * Memory Reclaim
+ * --------------
+ *
+ * Subsystems that keep unused memory around for caching (object pools, the
+ * buffer cache, etc.) register shrinkers, i.e. callbacks that give some of
+ * that memory back. Once the number of free pages drops below the low
+ * watermark, a background task calls the shrinkers one after another until
+ * the number of free pages reaches the high watermark again. If an allocation
+ * fails, the reclaim task is woken up and NULL is returned: the allocation may
+ * happen in an interrupt handler or with spinlocks held, so it cannot wait for
+ * the shrinkers.
  * 
  * Initialization
  * --------------
@@ -43,7 +80,7 @@
 struct Page *pages;
 /** The maximum number of available physical pages */
 unsigned page_count;
-/** The number of free physical pages */
+/** The number of free physical pages (not counting the per-CPU caches) */
 unsigned page_free_count = 0;
 
 /** The list of free pages, grouped by block order */
@@ -57,6 +94,52 @@ static struct KSpinLock page_lock;
 static int page_initialized = 0;
 // static int high = 0;
 
+/** Number of pages moved between a per-CPU cache and the free lists at once */
+#define PAGE_CACHE_BATCH  16
+/** The maximum number of pages in a per-CPU cache */
+#define PAGE_CACHE_HIGH   (4 * PAGE_CACHE_BATCH)
+/** The maximum number of pre-zeroed pages in a per-CPU cache */
+#define PAGE_ZERO_HIGH    16
+/** The maximum number of pages zeroed each time the CPU becomes idle */
+#define PAGE_ZERO_BATCH   4
+
+struct PageCache {
+  /** Protects the cache against draining by other CPUs */
+  struct KSpinLock lock;
+  /** Free order-0 pages, from the hottest to the coldest */
+  struct KListLink list;
+  /** The number of pages in the list */
+  unsigned         count;
+  /** Pre-zeroed order-0 pages */
+  struct KListLink zeroed;
+  /** The number of pages in the zeroed list */
+  unsigned         zeroed_count;
+};
+
+K_PERCPU_DEFINE_STATIC(struct PageCache, page_caches);
+
+/** Wake up the reclaim task when fewer pages are free */
+static unsigned page_wmark_low;
+/** The reclaim task stops when this many pages are free */
+static unsigned page_wmark_high;
+
+/** Registered shrinkers (never removed) */
+static K_LIST_DECLARE(page_shrinkers);
+static struct KSpinLock page_shrinkers_lock =
+  K_SPINLOCK_INITIALIZER("page_shrinkers");
+
+static struct KTask       page_reclaim_task;
+static struct KSemaphore  page_reclaim_sema;
+static k_atomic_t         page_reclaim_pending;
+static int                page_reclaim_started;
+
+static unsigned page_cache_shrink(unsigned);
+
+static struct PageShrinker page_cache_shrinker = {
+  .name   = "page_cache",
+  .shrink = page_cache_shrink,
+};
+
 #define BITS_PER_BYTE     8
 #define BITS_PER_WORD     (sizeof(unsigned long) * BITS_PER_BYTE)
 #define BITMAP_OFFSET(n)  ((n) / BITS_PER_WORD)
@@ -65,6 +148,8 @@ static int page_initialized = 0;
 
 static void        *boot_alloc(size_t);
 
+static struct Page *page_buddy_alloc(unsigned);
+static void         page_buddy_free(struct Page *, unsigned);
 static struct Page *page_buddy(struct Page *, unsigned);
 static void         page_list_add(struct Page *, unsigned);
 static void         page_k_list_remove(struct Page *, unsigned);
@@ -95,6 +180,18 @@ page_init_low(void)
     page_free_list[i].bitmap = (unsigned long *) boot_alloc(bitmap_len);
   }
 
+  for (i = 0; i < K_CPU_MAX; i++) {
+    struct PageCache *cache = &K_PERCPU_GET(page_caches, i);
+
+    k_spinlock_init(&cache->lock, "page_cache");
+    k_list_init(&cache->list);
+    cache->count = 0;
+    k_list_init(&cache->zeroed);
+    cache->zeroed_count = 0;
+  }
+
+  page_shrinker_register(&page_cache_shrinker);
+
   // Place pages mapped by 'entry_pgdir' to the free list.
   // FIXME: add low memory to region
   page_free_region(KVA2PA(boot_alloc(0)), PHYS_ENTRY_LIMIT);
@@ -111,6 +208,9 @@ page_init_high(void)
   // TODO: detect the actual amount of physical memory!
   page_free_region(PHYS_ENTRY_LIMIT, PHYS_LIMIT);
   // high = 1;
+
+  page_wmark_low  = page_count / 64;
+  page_wmark_high = page_count / 32;
 }
 
 /**
@@ -156,6 +256,185 @@ boot_alloc(size_t n)
   return ret;
 }
 
+// Move up to n of the coldest pages from the cache back to the free lists
+static void
+page_cache_drain(struct PageCache *cache, unsigned n)
+{
+  k_assert(k_spinlock_holding(&cache->lock));
+
+  k_spinlock_acquire(&page_lock);
+
+  while ((n-- > 0) && (cache->count > 0)) {
+    struct Page *page = K_CONTAINER_OF(cache->list.prev, struct Page, link);
+
+    k_list_remove(&page->link);
+    cache->count--;
+
+    page_buddy_free(page, 0);
+  }
+
+  k_spinlock_release(&page_lock);
+}
+
+// Return the pages cached by all CPUs to the free lists
+static unsigned
+page_cache_drain_all(void)
+{
+  unsigned count = 0;
+  int i;
+
+  for (i = 0; i < K_CPU_MAX; i++) {
+    struct PageCache *cache = &K_PERCPU_GET(page_caches, i);
+
+    k_spinlock_acquire(&cache->lock);
+
+    // The zeroed pages have to go as well
+    while (cache->zeroed_count > 0) {
+      struct Page *page = K_CONTAINER_OF(cache->zeroed.next, struct Page, link);
+
+      k_list_remove(&page->link);
+      cache->zeroed_count--;
+
+      k_list_add_back(&cache->list, &page->link);
+      cache->count++;
+    }
+
+    count += cache->count;
+    page_cache_drain(cache, cache->count);
+
+    k_spinlock_release(&cache->lock);
+  }
+
+  return count;
+}
+
+// The cached pages are not counted as free, so give them back under pressure
+static unsigned
+page_cache_shrink(unsigned)
+{
+  return page_cache_drain_all();
+}
+
+// Move a batch of pages from the free lists into the cache
+static void
+page_cache_refill(struct PageCache *cache)
+{
+  unsigned i;
+
+  k_assert(k_spinlock_holding(&cache->lock));
+
+  k_spinlock_acquire(&page_lock);
+
+  for (i = 0; i < PAGE_CACHE_BATCH; i++) {
+    struct Page *page;
+
+    if ((page = page_buddy_alloc(0)) == NULL)
+      break;
+
+    k_list_add_back(&cache->list, &page->link);
+    cache->count++;
+  }
+
+  k_spinlock_release(&page_lock);
+
+  cpu_stat_inc(CPU_STAT_PAGE_REFILLS);
+}
+
+// Allocate a single page from the cache of the current CPU
+static struct Page *
+page_cache_alloc(void)
+{
+  struct PageCache *cache;
+  struct Page *page = NULL;
+
+  // Keep running on the same CPU
+  k_irq_state_save();
+
+  cache = &K_PERCPU_THIS(page_caches);
+
+  k_spinlock_acquire(&cache->lock);
+
+  if (cache->count == 0)
+    page_cache_refill(cache);
+
+  if (cache->count > 0) {
+    page = K_CONTAINER_OF(cache->list.next, struct Page, link);
+
+    k_list_remove(&page->link);
+    cache->count--;
+  }
+
+  k_spinlock_release(&cache->lock);
+
+  k_irq_state_restore();
+
+  return page;
+}
+
+// Allocate a pre-zeroed page from the cache of the current CPU
+static struct Page *
+page_cache_alloc_zeroed(void)
+{
+  struct PageCache *cache;
+  struct Page *page = NULL;
+
+  k_irq_state_save();
+
+  cache = &K_PERCPU_THIS(page_caches);
+
+  k_spinlock_acquire(&cache->lock);
+
+  if (cache->zeroed_count > 0) {
+    page = K_CONTAINER_OF(cache->zeroed.next, struct Page, link);
+
+    k_list_remove(&page->link);
+    cache->zeroed_count--;
+  }
+
+  k_spinlock_release(&cache->lock);
+
+  k_irq_state_restore();
+
+  return page;
+}
+
+// Free a single page into the cache of the current CPU
+static void
+page_cache_free(struct Page *page)
+{
+  struct PageCache *cache;
+
+  k_irq_state_save();
+
+  cache = &K_PERCPU_THIS(page_caches);
+
+  k_spinlock_acquire(&cache->lock);
+
+  k_list_add_front(&cache->list, &page->link);
+  if (++cache->count > PAGE_CACHE_HIGH)
+    page_cache_drain(cache, PAGE_CACHE_BATCH);
+
+  k_spinlock_release(&cache->lock);
+
+  k_irq_state_restore();
+}
+
+// Try to allocate a block from the per-CPU cache or the free lists
+static struct Page *
+page_alloc_try(unsigned order)
+{
+  struct Page *page;
+
+  if (order == 0)
+    return page_cache_alloc();
+
+  k_spinlock_acquire(&page_lock);
+  page = page_buddy_alloc(order);
+  k_spinlock_release(&page_lock);
+
+  return page;
+}
+
 /**
  * Allocate a block of the given order.
  * 
@@ -167,41 +446,32 @@ boot_alloc(size_t n)
 struct Page *
 page_alloc_block(unsigned order, int flags, int debug_tag)
 {
-  struct Page *page;
+  struct Page *page = NULL;
   unsigned o;
 
-  k_spinlock_acquire(&page_lock);
-
-  for (o = order; o <= PAGE_ORDER_MAX; o++)
-    if (!k_list_is_empty(&page_free_list[o].link))
-      break;
-
-  if (o > PAGE_ORDER_MAX) {
-    // TODO: try to reclaim pages from the slab allocator
-    k_spinlock_release(&page_lock);
-    k_panic("out of memory\n");
-    return NULL;
+  if ((order == 0) && (flags & PAGE_ALLOC_ZERO)) {
+    if ((page = page_cache_alloc_zeroed()) != NULL) {
+      flags &= ~PAGE_ALLOC_ZERO;
+      cpu_stat_inc(CPU_STAT_PAGE_ZERO_HITS);
+    } else {
+      cpu_stat_inc(CPU_STAT_PAGE_ZERO_MISSES);
+    }
   }
 
-  page = K_CONTAINER_OF(page_free_list[o].link.next, struct Page, link);
+  if ((page == NULL) && ((page = page_alloc_try(order)) == NULL)) {
+    // Free pages may be sitting in the caches of other CPUs
+    page_cache_drain_all();
 
-  page_k_list_remove(page, o);
-  page_free_count -= 1U << order;
-
-  // Split
-  while (o > order) {
-    o--;
-    page_list_add(page, o);
-    page += (1U << o);
+    if ((page = page_alloc_try(order)) == NULL) {
+      page_reclaim_wakeup();
+      return NULL;
+    }
   }
 
-  k_assert(page->ref_count == 0);
-  k_assert(!page_list_contains(page, order));
+  if (page_free_count < page_wmark_low)
+    page_reclaim_wakeup();
 
-  // if (high)
-  //   cprintf(" %d\n", page_free_count);
-
-  k_spinlock_release(&page_lock);
+  k_assert(page->ref_count == 0);
 
   if (flags & PAGE_ALLOC_ZERO)
     memset(page2kva(page), 0, PAGE_SIZE << order);
@@ -211,6 +481,9 @@ page_alloc_block(unsigned order, int flags, int debug_tag)
     page[o].debug_tag = debug_tag;
   }
 
+  TRACE(TRACE_PAGE_ALLOC, order, page2pa(page));
+  cpu_stat_inc(CPU_STAT_PAGE_ALLOCS);
+
   return page;
 }
 
@@ -223,7 +496,6 @@ page_alloc_block(unsigned order, int flags, int debug_tag)
 void
 page_free_block(struct Page *page, unsigned order)
 {
-  struct Page *buddy;
   unsigned o;
 
   if (page->ref_count != 0)
@@ -233,24 +505,182 @@ page_free_block(struct Page *page, unsigned order)
     page[o].debug_tag = 0;
   }
 
+  if (order == 0) {
+    page_cache_free(page);
+    return;
+  }
+
   k_spinlock_acquire(&page_lock);
+  page_buddy_free(page, order);
+  k_spinlock_release(&page_lock);
+}
 
-  for (o = order ; o < PAGE_ORDER_MAX; o++) {
-    buddy = page_buddy(page, o);
+/**
+ * Replenish the pre-zeroed pages of the current CPU. Called when the CPU
+ * becomes idle, so only a small batch of pages is zeroed each time.
+ */
+void
+page_zero_idle(void)
+{
+  int i;
 
-    if (!page_list_contains(buddy, o))
+  for (i = 0; i < PAGE_ZERO_BATCH; i++) {
+    struct PageCache *cache;
+    struct Page *page;
+    unsigned count;
+
+    // Don't hold back the pages that are about to be reclaimed
+    if (page_free_count < page_wmark_high)
       break;
 
-    // Combine with buddy
-    page_k_list_remove(buddy, o);
-    if (buddy < page)
-      page = buddy;
+    k_irq_state_save();
+    count = K_PERCPU_THIS(page_caches).zeroed_count;
+    k_irq_state_restore();
+
+    if (count >= PAGE_ZERO_HIGH)
+      break;
+
+    if ((page = page_cache_alloc()) == NULL)
+      break;
+
+    memset(page2kva(page), 0, PAGE_SIZE);
+
+    k_irq_state_save();
+
+    cache = &K_PERCPU_THIS(page_caches);
+
+    k_spinlock_acquire(&cache->lock);
+    k_list_add_front(&cache->zeroed, &page->link);
+    cache->zeroed_count++;
+    k_spinlock_release(&cache->lock);
+
+    k_irq_state_restore();
   }
+}
 
-  page_list_add(page, o);
-  page_free_count += 1U << order;
+/**
+ * Register a shrinker to be called under memory pressure.
+ *
+ * Shrinkers are called from the reclaim task, so they may sleep, and should
+ * try to free at least the requested number of pages (or as many as possible).
+ *
+ * @param shrinker The shrinker to register. Cannot be unregistered.
+ */
+void
+page_shrinker_register(struct PageShrinker *shrinker)
+{
+  k_list_null(&shrinker->link);
+  shrinker->calls = 0;
+  shrinker->freed = 0;
 
-  k_spinlock_release(&page_lock);
+  k_spinlock_acquire(&page_shrinkers_lock);
+  k_list_add_back_rcu(&page_shrinkers, &shrinker->link);
+  k_spinlock_release(&page_shrinkers_lock);
+}
+
+/**
+ * Wake up the reclaim task. Can be called from any context.
+ */
+void
+page_reclaim_wakeup(void)
+{
+  if (!page_reclaim_started)
+    return;
+
+  if (k_atomic_cmpxchg(&page_reclaim_pending, 0, 1) == 0)
+    k_semaphore_put(&page_reclaim_sema);
+}
+
+// Call the shrinkers until the number of free pages reaches the high watermark
+static void
+page_reclaim(void)
+{
+  struct KListLink *l;
+
+  // Shrinkers are never removed, so the list can be traversed without locking
+  // (and with interrupts enabled)
+  K_LIST_FOREACH_RCU(&page_shrinkers, l) {
+    struct PageShrinker *shrinker;
+    unsigned free_count;
+
+    if ((free_count = page_free_count) >= page_wmark_high)
+      break;
+
+    shrinker = K_CONTAINER_OF(l, struct PageShrinker, link);
+
+    shrinker->calls++;
+    shrinker->freed += shrinker->shrink(page_wmark_high - free_count);
+  }
+}
+
+static void
+page_reclaim_entry(void *)
+{
+  for (;;) {
+    if (k_semaphore_get(&page_reclaim_sema, K_SLEEP_UNWAKEABLE) < 0)
+      k_panic("k_semaphore_get");
+
+    // Clear the flag before the pass, so that a wakeup arriving after the pass
+    // has already called the shrinker that could help queues another pass. A
+    // read-modify-write is a full barrier, so the pass sees the free page count
+    // that triggered such a wakeup
+    k_atomic_cmpxchg(&page_reclaim_pending, 1, 0);
+
+    page_reclaim();
+  }
+}
+
+/**
+ * Start the reclaim task. Must be called after the scheduler is initialized.
+ */
+void
+page_reclaim_init(void)
+{
+  struct Page *stack_page;
+
+  k_semaphore_create(&page_reclaim_sema, 0);
+  k_atomic_set(&page_reclaim_pending, 0);
+
+  if ((stack_page = page_alloc_one(0, PAGE_TAG_KSTACK)) == NULL)
+    k_panic("cannot create the reclaim task");
+  stack_page->ref_count++;
+
+  if (k_task_create(&page_reclaim_task, NULL, page_reclaim_entry, NULL,
+                    page2kva(stack_page), PAGE_SIZE, 0) != 0)
+    k_panic("cannot create the reclaim task");
+
+  k_task_resume(&page_reclaim_task);
+
+  page_reclaim_started = 1;
+}
+
+/**
+ * Get the statistics of all registered shrinkers.
+ *
+ * @param info Array to store the statistics.
+ * @param max  The maximum number of entries to store.
+ *
+ * @return The number of entries stored.
+ */
+int
+page_shrinker_stat(struct PageShrinkerInfo *info, int max)
+{
+  struct KListLink *l;
+  int n = 0;
+
+  K_LIST_FOREACH_RCU(&page_shrinkers, l) {
+    struct PageShrinker *shrinker = K_CONTAINER_OF(l, struct PageShrinker, link);
+
+    if (n >= max)
+      break;
+
+    info[n].name  = shrinker->name;
+    info[n].calls = shrinker->calls;
+    info[n].freed = shrinker->freed;
+    n++;
+  }
+
+  return n;
 }
 
 /**
@@ -282,12 +712,84 @@ page_free_region(physaddr_t start, physaddr_t end)
       blk_order--;
     }
 
-    page_free_block(&pages[page_idx], blk_order);
+    k_spinlock_acquire(&page_lock);
+    page_buddy_free(&pages[page_idx], blk_order);
+    k_spinlock_release(&page_lock);
 
     page_idx += blk_length;
   }
 }
 
+/**
+ * Remove a block of the given order from the free lists.
+ *
+ * @param order The allocation order.
+ *
+ * @return Pointer to a page structure or NULL if out of memory.
+ */
+static struct Page *
+page_buddy_alloc(unsigned order)
+{
+  struct Page *page;
+  unsigned o;
+
+  k_assert(k_spinlock_holding(&page_lock));
+
+  for (o = order; o <= PAGE_ORDER_MAX; o++)
+    if (!k_list_is_empty(&page_free_list[o].link))
+      break;
+
+  if (o > PAGE_ORDER_MAX)
+    return NULL;
+
+  page = K_CONTAINER_OF(page_free_list[o].link.next, struct Page, link);
+
+  page_k_list_remove(page, o);
+  page_free_count -= 1U << order;
+
+  // Split
+  while (o > order) {
+    o--;
+    page_list_add(page, o);
+    page += (1U << o);
+  }
+
+  k_assert(page->ref_count == 0);
+  k_assert(!page_list_contains(page, order));
+
+  return page;
+}
+
+/**
+ * Return a block to the free lists, merging it with its free buddies.
+ *
+ * @param page  Pointer to the page structure corresponding to the block.
+ * @param order The order of the page block.
+ */
+static void
+page_buddy_free(struct Page *page, unsigned order)
+{
+  struct Page *buddy;
+  unsigned o;
+
+  k_assert(k_spinlock_holding(&page_lock));
+
+  for (o = order ; o < PAGE_ORDER_MAX; o++) {
+    buddy = page_buddy(page, o);
+
+    if (!page_list_contains(buddy, o))
+      break;
+
+    // Combine with buddy
+    page_k_list_remove(buddy, o);
+    if (buddy < page)
+      page = buddy;
+  }
+
+  page_list_add(page, o);
+  page_free_count += 1U << order;
+}
+
 /**
  * Get the buddy of a page block.
  * 
@@ -1,5 +1,6 @@
 #include <errno.h>
 #include <kernel/console.h>
+#include <kernel/cpu_stat.h>
 #include <kernel/page.h>
 #include <kernel/vm.h>
 #include <kernel/types.h>
@@ -543,12 +544,63 @@ vm_user_check_buf(void *pgtab, uintptr_t start_va, size_t n, int flags)
   return 0;
 }
 
+/**
+ * Read an aligned word from user memory and find the physical page holding it.
+ *
+ * Copy-on-write sharing is broken first, so that the page stays the same for
+ * all tasks accessing the word through this mapping, until it is unmapped.
+ *
+ * @param pgtab       Pointer to the page table
+ * @param va          The virtual address of the word
+ * @param page_store  Pointer to the memory location to store the page
+ * @param value_store Pointer to the memory location to store the value (may
+ *                    be NULL)
+ *
+ * @retval 0       Success
+ * @retval -EFAULT The address is not mapped for user read access
+ * @retval -ENOMEM Out of memory
+ */
+int
+vm_user_get_word(void *pgtab, uintptr_t va, struct Page **page_store,
+                 int *value_store)
+{
+  struct Page *page;
+  int r, curr_flags;
+
+  if ((va >= VIRT_KERNEL_BASE) || (va % sizeof(int) != 0))
+    return -EFAULT;
+
+  k_spinlock_acquire(&vm_lock);
+
+  if ((r = vm_page_lookup_cow(pgtab, va, &page, &curr_flags)) < 0) {
+    k_spinlock_release(&vm_lock);
+    return r;
+  }
+
+  if (!vm_flags_check(curr_flags, VM_READ | VM_USER)) {
+    k_spinlock_release(&vm_lock);
+    return -EFAULT;
+  }
+
+  if (value_store != NULL)
+    *value_store = *(volatile int *) ((uint8_t *) page2kva(page) +
+                                      va % PAGE_SIZE);
+
+  k_spinlock_release(&vm_lock);
+
+  *page_store = page;
+
+  return 0;
+}
+
 int
 vm_handle_fault(void *pgtab, uintptr_t va)
 {
   struct Page *fault_page;
   int flags;
 
+  cpu_stat_inc(CPU_STAT_PAGE_FAULTS);
+
   if ((va < PAGE_SIZE) || (va >= VIRT_KERNEL_BASE))
     return -EFAULT;
 
@@ -1,10 +1,17 @@
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
-
 #include <kernel/tty.h>
 #include <kernel/console.h>
+#include <kernel/cpu_stat.h>
+#include <kernel/core/latency_stat.h>
+#include <kernel/core/lock_stat.h>
+#include <kernel/ipc.h>
 #include <kernel/kdebug.h>
 #include <kernel/object_pool.h>
+#include <kernel/page.h>
+#include <kernel/process.h>
 #include <kernel/mm/memlayout.h>
 #include <kernel/monitor.h>
 #include <kernel/trap.h>
@@ -89,7 +96,11 @@ static struct Command commands[] = {
   { "help", "Print this list of commands", mon_help },
   { "kerninfo", "Print this list of commands", mon_kerninfo },
   { "backtrace", "Display a list of function call frames", mon_backtrace },
-  { "kmeminfo", "Display the list of object caches", mon_kmeminfo },
+  { "kmeminfo", "Display the object pools, shrinkers and k_malloc classes", mon_kmeminfo },
+  { "lockstat", "Display the most contended locks", mon_lockstat },
+  { "cpustat", "Display the per-CPU event counters", mon_cpustat },
+  { "ipcstat", "Display the service endpoint queues", mon_ipcstat },
+  { "latstat", "Display the interrupt and scheduling latencies", mon_latstat },
 };
 
 #define MAXARGS 16
@@ -195,12 +206,325 @@ mon_backtrace(int argc, char **argv, struct TrapFrame *tf)
   return 0;
 }
 
+#define KMEMINFO_MAX            128
+#define KMEMINFO_SHRINKERS_MAX  16
+
 int
 mon_kmeminfo(int argc, char **argv, struct TrapFrame *tf)
 {
+  static struct KObjectPoolInfo info[KMEMINFO_MAX];
+  static struct PageShrinkerInfo shrinkers[KMEMINFO_SHRINKERS_MAX];
+  static struct KMallocInfo classes[KMEMINFO_MAX];
+
+  unsigned long long requested = 0, allocated = 0;
+
+  int i, n;
+
+  (void) argc;
+  (void) argv;
+  (void) tf;
+
+  n = k_object_pool_stat(info, KMEMINFO_MAX);
+
+  cprintf("%-20s %6s %6s %8s %8s %10s %10s %5s\n",
+          "pool", "size", "slabs", "objs", "used", "hits", "misses", "hit%");
+
+  for (i = 0; i < n; i++) {
+    unsigned long total = info[i].hits + info[i].misses;
+
+    cprintf("%-20s %6u %6u %8u %8u %10lu %10lu %4lu%%\n",
+            info[i].name,
+            (unsigned) info[i].obj_size,
+            info[i].slabs,
+            info[i].objs_total,
+            info[i].objs_used,
+            info[i].hits,
+            info[i].misses,
+            total ? info[i].hits * 100 / total : 0);
+  }
+
+  n = page_shrinker_stat(shrinkers, KMEMINFO_SHRINKERS_MAX);
+
+  cprintf("\n%-20s %10s %10s\n", "shrinker", "calls", "freed");
+
+  for (i = 0; i < n; i++)
+    cprintf("%-20s %10lu %10lu\n",
+            shrinkers[i].name,
+            shrinkers[i].calls,
+            shrinkers[i].freed);
+
+  n = k_malloc_stat(classes, KMEMINFO_MAX);
+
+  cprintf("\n%-20s %10s %10s %12s %12s %6s\n",
+          "k_malloc", "allocs", "live", "requested", "allocated", "waste");
+
+  for (i = 0; i < n; i++) {
+    unsigned long long bytes = (unsigned long long) classes[i].allocs *
+                               classes[i].size;
+
+    if (classes[i].allocs == 0)
+      continue;
+
+    cprintf("%-20u %10lu %10lu %12llu %12llu %5llu%%\n",
+            (unsigned) classes[i].size,
+            classes[i].allocs,
+            classes[i].allocs - classes[i].frees,
+            classes[i].requested,
+            bytes,
+            (bytes - classes[i].requested) * 100 / bytes);
+
+    requested += classes[i].requested;
+    allocated += bytes;
+  }
+
+  if (allocated != 0)
+    cprintf("%-20s %10s %10s %12llu %12llu %5llu%%\n",
+            "total", "", "", requested, allocated,
+            (allocated - requested) * 100 / allocated);
+
+  return 0;
+}
+
+#define LOCKSTAT_DEFAULT_TOP  10
+
+int
+mon_lockstat(int argc, char **argv, struct TrapFrame *tf)
+{
+  static struct KLockStatInfo stats[K_LOCK_STAT_MAX];
+
+  int i, j, n, top = LOCKSTAT_DEFAULT_TOP;
+
+  (void) tf;
+
+  if (argc > 1) {
+    if (strcmp(argv[1], "reset") == 0) {
+      k_lock_stat_reset();
+      return 0;
+    }
+
+    if ((top = strtol(argv[1], NULL, 10)) <= 0) {
+      cprintf("Usage: lockstat [N|reset]\n");
+      return 0;
+    }
+  }
+
+  if ((n = k_lock_stat_get(stats, K_LOCK_STAT_MAX)) == 0) {
+    cprintf("No lock statistics (build the kernel with LOCKSTAT=1)\n");
+    return 0;
+  }
+
+  // Sort by the total wait time, in descending order
+  for (i = 1; i < n; i++) {
+    struct KLockStatInfo tmp = stats[i];
+
+    for (j = i; j > 0 && stats[j - 1].wait_total < tmp.wait_total; j--)
+      stats[j] = stats[j - 1];
+    stats[j] = tmp;
+  }
+
+  cprintf("%-16s %10s %10s %14s %12s %12s\n",
+          "name", "acquired", "contended", "wait-total", "wait-max", "hold-max");
+
+  for (i = 0; i < n && i < top; i++)
+    cprintf("%-16s %10lu %10lu %14llu %12llu %12llu\n",
+            stats[i].name,
+            stats[i].acquired,
+            stats[i].contended,
+            stats[i].wait_total,
+            stats[i].wait_max,
+            stats[i].hold_max);
+
+  cprintf("(all times in nanoseconds)\n");
+
+  return 0;
+}
+
+static void
+cpustat_print_row(const char *name, unsigned long *values)
+{
+  unsigned long total = 0;
+  int cpu;
+
+  cprintf("%-14s", name);
+  for (cpu = 0; cpu < K_CPU_MAX; cpu++) {
+    cprintf(" %10lu", values[cpu]);
+    total += values[cpu];
+  }
+  cprintf(" %12lu\n", total);
+}
+
+int
+mon_cpustat(int argc, char **argv, struct TrapFrame *tf)
+{
+  unsigned long values[K_CPU_MAX];
+  char name[16];
+  int cpu, i;
+
+  (void) tf;
+
+  if (argc > 1) {
+    if (strcmp(argv[1], "reset") != 0) {
+      cprintf("Usage: cpustat [reset]\n");
+      return 0;
+    }
+
+    cpu_stat_reset();
+    return 0;
+  }
+
+  cprintf("%-14s", "event");
+  for (cpu = 0; cpu < K_CPU_MAX; cpu++) {
+    snprintf(name, sizeof(name), "cpu%d", cpu);
+    cprintf(" %10s", name);
+  }
+  cprintf(" %12s\n", "total");
+
+  for (i = 0; i < CPU_STAT_MAX; i++) {
+    for (cpu = 0; cpu < K_CPU_MAX; cpu++)
+      values[cpu] = K_PERCPU_GET(cpu_stats, cpu).counters[i];
+    cpustat_print_row(cpu_stat_name(i), values);
+  }
+
+  // Display only the interrupt lines that have fired
+  for (i = 0; i < INTERRUPT_HANDLER_MAX; i++) {
+    unsigned long any = 0;
+
+    for (cpu = 0; cpu < K_CPU_MAX; cpu++)
+      any |= values[cpu] = K_PERCPU_GET(cpu_stats, cpu).irqs[i];
+
+    if (any) {
+      snprintf(name, sizeof(name), "irq%d", i);
+      cpustat_print_row(name, values);
+    }
+  }
+
+  return 0;
+}
+
+#define IPCSTAT_MAX  32
+
+int
+mon_ipcstat(int argc, char **argv, struct TrapFrame *tf)
+{
+  static struct EndpointInfo info[IPCSTAT_MAX];
+
+  int i, n;
+
   (void) argc;
   (void) argv;
   (void) tf;
 
+  n = endpoint_stat(info, IPCSTAT_MAX);
+
+  cprintf("%-16s %8s %8s %8s %8s %8s\n",
+          "endpoint", "workers", "max", "idle", "queued", "peak");
+
+  for (i = 0; i < n; i++)
+    cprintf("%-16s %8d %8d %8d %8d %8d\n",
+            info[i].name,
+            info[i].workers,
+            info[i].workers_max,
+            info[i].idle,
+            info[i].queued,
+            info[i].queued_max);
+
+  return 0;
+}
+
+#define LATSTAT_THREADS_MAX   256
+#define LATSTAT_DEFAULT_TOP   10
+
+static const char *latstat_names[K_LATENCY_MAX] = {
+  [K_LATENCY_IRQS_OFF]    = "irqs-off",
+  [K_LATENCY_PREEMPT_OFF] = "preempt-off",
+  [K_LATENCY_WAKEUP]      = "wakeup",
+};
+
+static void
+latstat_print(int type, struct KLatencyStatInfo *info)
+{
+  struct PcDebugInfo debug;
+  int i;
+
+  cprintf("%s: %lu events, avg %llu, max %llu (cpu %u)\n",
+          latstat_names[type],
+          info->count,
+          info->count ? info->total / info->count : 0,
+          info->max,
+          info->max_cpu);
+
+  // Display only the non-empty buckets
+  for (i = 0; i < K_LATENCY_HIST_MAX; i++) {
+    if (info->hist[i] == 0)
+      continue;
+
+    if (i < K_LATENCY_HIST_MAX - 1)
+      cprintf("  <%-8lu us %10lu\n", 1UL << i, info->hist[i]);
+    else
+      cprintf("  >=%-7lu us %10lu\n", 1UL << (i - 1), info->hist[i]);
+  }
+
+  if (info->max == 0)
+    return;
+
+  cprintf("  %s:\n", type == K_LATENCY_WAKEUP ? "slowest task" : "longest at");
+
+  for (i = 0; i < K_SPINLOCK_MAX_PCS && info->max_pcs[i]; i++) {
+    debug_info_pc(info->max_pcs[i], &debug);
+    cprintf("    [%p] %s (%s at line %d)\n",
+            info->max_pcs[i], debug.fn_name, debug.file, debug.line);
+  }
+}
+
+int
+mon_latstat(int argc, char **argv, struct TrapFrame *tf)
+{
+  static struct ThreadLatencyInfo threads[LATSTAT_THREADS_MAX];
+
+  struct KLatencyStatInfo info;
+  int i, j, n;
+
+  (void) tf;
+
+  if (argc > 1) {
+    if (strcmp(argv[1], "reset") != 0) {
+      cprintf("Usage: latstat [reset]\n");
+      return 0;
+    }
+
+    k_latency_stat_reset();
+    return 0;
+  }
+
+  for (i = 0; i < K_LATENCY_MAX; i++) {
+    if (k_latency_stat_get(i, &info) != 0) {
+      cprintf("No latency statistics (build the kernel with LATSTAT=1)\n");
+      return 0;
+    }
+
+    latstat_print(i, &info);
+  }
+
+  n = process_latency_stat(threads, LATSTAT_THREADS_MAX);
+
+  // Sort by the worst wakeup latency, in descending order
+  for (i = 1; i < n; i++) {
+    struct ThreadLatencyInfo tmp = threads[i];
+
+    for (j = i; j > 0 && threads[j - 1].wakeup_max < tmp.wakeup_max; j--)
+      threads[j] = threads[j - 1];
+    threads[j] = tmp;
+  }
+
+  cprintf("%8s %8s %14s\n", "pid", "tid", "wakeup-max");
+
+  for (i = 0; i < n && i < LATSTAT_DEFAULT_TOP; i++)
+    cprintf("%8d %8d %14llu\n",
+            threads[i].pid,
+            threads[i].tid,
+            threads[i].wakeup_max);
+
+  cprintf("(all times in nanoseconds unless noted)\n");
+
   return 0;
 }
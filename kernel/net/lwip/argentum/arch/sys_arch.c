@@ -13,6 +13,11 @@
 #include "cc.h"
 #include "sys_arch.h"
 
+// CPUs to run the network stack tasks on
+#ifndef NET_SERVICE_CPUS
+#define NET_SERVICE_CPUS  K_CPU_MASK_ALL
+#endif
+
 /* Mutex functions: */
 err_t
 sys_mutex_new(sys_mutex_t *mutex)
@@ -180,7 +185,7 @@ void
 sys_mbox_free(sys_mbox_t *mbox)
 {
   k_mailbox_destroy(*mbox);
-  k_free((*mbox)->buf_start);
+  k_free((*mbox)->buf);
   k_free(*mbox);
 }
 
@@ -219,6 +224,7 @@ sys_thread_new(const char *name, void (*thread)(void *), void *arg,
     k_panic("cannot create IRQ task");
 
   k_task_create(task, NULL, thread, arg, stack, PAGE_SIZE, 0);
+  k_task_set_affinity(task, NET_SERVICE_CPUS);
   k_task_resume(task);
 
   return task;
@@ -40,7 +40,10 @@ eth_netif_output(struct netif *netif, struct pbuf *p)
 {
   (void) netif;
 
-  struct Page *page = page_alloc_one(0, PAGE_TAG_ETH_TX);
+  struct Page *page;
+
+  if ((page = page_alloc_one(0, PAGE_TAG_ETH_TX)) == NULL)
+    return ERR_MEM;
 
   pbuf_copy_partial(p, page2kva(page), p->tot_len, 0);
   arch_eth_write(page2kva(page), p->tot_len);
@@ -143,7 +146,7 @@ net_set_connection_endpoint(struct SocketEndpoint *endpoint,
   k_list_null(&endpoint->hash_link);
 
   connection->type = CONNECTION_TYPE_SOCKET;
-  connection->ref_count++;
+  k_refcount_get(&connection->ref_count);
 
   k_spinlock_acquire(&socket_hash.lock);
   HASH_PUT(socket_hash.table, &endpoint->hash_link, (uintptr_t) connection);
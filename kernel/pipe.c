@@ -2,6 +2,7 @@
 #include <fcntl.h>
 
 #include <kernel/console.h>
+#include <kernel/hrtimer.h>
 #include <kernel/ipc.h>
 #include <kernel/object_pool.h>
 #include <kernel/page.h>
@@ -10,6 +11,17 @@
 #include <kernel/vmspace.h>
 #include <kernel/time.h>
 #include <kernel/hash.h>
+#include <kernel/core/cpu.h>
+
+// CPUs to run the pipe service tasks on
+#ifndef PIPE_SERVICE_CPUS
+#define PIPE_SERVICE_CPUS   K_CPU_MASK_ALL
+#endif
+
+// Maximum number of pipe service tasks
+#ifndef PIPE_SERVICE_WORKERS_MAX
+#define PIPE_SERVICE_WORKERS_MAX  (2 * ENDPOINT_WORKERS_MAX)
+#endif
 
 static struct KObjectPool *pipe_cache;
 
@@ -73,38 +85,26 @@ pipe_dispatch_table[] = {
 };
 
 struct Endpoint pipe_endpoint;
-struct KTask    pipe_tasks[ENDPOINT_MBOX_CAPACITY];
 
 #define PIPE_DISPATCH_TABLE_SIZE (int)(sizeof(pipe_dispatch_table) / sizeof(pipe_dispatch_table[0]))
 
-void
-pipe_service_task(void *)
+static void
+pipe_service_handle(void *arg, struct Request *req)
 {
-  struct Request *req;
-
-  //cprintf("[worker %p] waits\n", arg);
-  while (endpoint_receive(&pipe_endpoint, &req) >= 0) {
-    struct IpcMessage msg;
-
-    //cprintf("[worker %p] msg from %#x\n", arg, req->process->pid);
+  struct IpcMessage msg;
 
-    if (request_read(req, &msg, sizeof(msg)) < 0) {
-      request_reply(req, -EFAULT);
-    } else if (msg.type >= 0 && msg.type < PIPE_DISPATCH_TABLE_SIZE && pipe_dispatch_table[msg.type] != NULL) {
-      pipe_dispatch_table[msg.type](req, &msg);
-    } else {
-      k_warn("unsupported msg type %d\n", msg.type);
-      request_reply(req, -ENOSYS);
-    }
+  (void) arg;
 
-    //cprintf("[worker %p] waits\n", arg);
+  if (request_read(req, &msg, sizeof(msg)) < 0) {
+    request_reply(req, -EFAULT);
+  } else if (msg.type >= 0 && msg.type < PIPE_DISPATCH_TABLE_SIZE && pipe_dispatch_table[msg.type] != NULL) {
+    pipe_dispatch_table[msg.type](req, &msg);
+  } else {
+    k_warn("unsupported msg type %d\n", msg.type);
+    request_reply(req, -ENOSYS);
   }
-
-  k_panic("error");
 }
 
-
-
 #define NBUCKET   256
 
 static struct {
@@ -148,7 +148,7 @@ pipe_set_connection_endpoint(struct PipeEndpoint *endpoint,
   k_list_null(&endpoint->hash_link);
 
   connection->type = CONNECTION_TYPE_PIPE;
-  connection->ref_count++;
+  k_refcount_get(&connection->ref_count);
   connection->endpoint = &pipe_endpoint;
 
   k_spinlock_acquire(&pipe_hash.lock);
@@ -159,8 +159,6 @@ pipe_set_connection_endpoint(struct PipeEndpoint *endpoint,
 void
 pipe_init_system(void)
 {
-  int i;
-
   pipe_cache = k_object_pool_create("pipe", sizeof(struct Pipe), 0, NULL, NULL);
   if (pipe_cache == NULL)
     k_panic("cannot allocate pipe cache");
@@ -168,19 +166,10 @@ pipe_init_system(void)
   HASH_INIT(pipe_hash.table);
   k_spinlock_init(&pipe_hash.lock, "pipe_hash");
 
-  endpoint_init(&pipe_endpoint);
-
-  for (i = 0; i < ENDPOINT_MBOX_CAPACITY; i++) {
-    struct Page *kstack;
-
-    if ((kstack = page_alloc_one(0, 0)) == NULL)
-      k_panic("out of memory");
-
-    kstack->ref_count++;
-
-    k_task_create(&pipe_tasks[i], NULL, pipe_service_task, (void *) i, page2kva(kstack), PAGE_SIZE, 0);
-    k_task_resume(&pipe_tasks[i]);
-  }
+  // Pipe reads wait for writes handled by the same pool, so the pool must be
+  // large enough for all concurrently blocked readers
+  endpoint_init(&pipe_endpoint, "pipe", pipe_service_handle, NULL,
+                PIPE_SERVICE_CPUS, PIPE_SERVICE_WORKERS_MAX);
 }
 
 static struct Pipe *
@@ -336,24 +325,26 @@ pipe_select(struct Connection *connection, struct timeval *timeout)
 {
   struct PipeEndpoint *endpoint = pipe_get_connection_endpoint(connection);
   struct Pipe *pipe = endpoint->pipe;
+  uint64_t deadline = 0;
   int r;
 
+  if (timeout != NULL)
+    deadline = hrtimer_now() + timeval2ns(timeout);
+
   if ((r = k_mutex_lock(&pipe->mutex)) < 0)
     return r;
 
   while (pipe->size == 0) {
-    unsigned long t = 0;
-
     if (timeout != NULL) {
-      t = timeval2ticks(timeout);
-      k_mutex_unlock(&pipe->mutex);
-      return 0;
+      r = hrtimer_condvar_timed_wait(&pipe->read_cond, &pipe->mutex, deadline);
+    } else {
+      //cprintf("[k] proc #%x wait %p\n", process_current()->pid, &pipe->read_cond);
+      r = k_condvar_timed_wait(&pipe->read_cond, &pipe->mutex, 0, 0);
     }
 
-    //cprintf("[k] proc #%x wait %p\n", process_current()->pid, &pipe->read_cond);
-    if ((r = k_condvar_timed_wait(&pipe->read_cond, &pipe->mutex, t, 0)) < 0) {
+    if (r < 0) {
       k_mutex_unlock(&pipe->mutex);
-      return r;
+      return r == -ETIMEDOUT ? 0 : r;
     }
   }
 
@@ -414,6 +414,10 @@ process_exec(const char *path, uintptr_t argv_va, uintptr_t envp_va)
   if ((r = load_elf(&ctx)) != 0)
     goto out5;
 
+  // Other threads cannot survive replacing the address space
+  if ((r = _process_exit_threads()) != 0)
+    goto out5;
+
   fs_close(ctx.file);
 
   sys_free_args(envp);
@@ -430,6 +434,9 @@ process_exec(const char *path, uintptr_t argv_va, uintptr_t envp_va)
   old_vm = proc->vm;
   proc->vm = ctx.vm;
 
+  // The address is not valid in the new program image
+  proc->thread->clear_tid = 0;
+
   signal_reset(proc);
 
   arch_vm_load(ctx.vm->pgtab);
@@ -441,7 +448,7 @@ process_exec(const char *path, uintptr_t argv_va, uintptr_t envp_va)
   k_free(ctx.envp);
   k_free(ctx.argv);
 
-  return arch_trap_frame_init(proc, ctx.entry_va, ctx.argc,
+  return arch_trap_frame_init(proc->thread, ctx.entry_va, ctx.argc,
                               ctx.argv_va, 
                               ctx.env_va,
                               ctx.sp_va);
@@ -1,6 +1,7 @@
 #include <kernel/core/assert.h>
 #include <errno.h>
 #include <limits.h>
+#include <sched.h>
 #include <string.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
@@ -11,6 +12,7 @@
 #include <kernel/elf.h>
 #include <kernel/fd.h>
 #include <kernel/fs/fs.h>
+#include <kernel/futex.h>
 #include <kernel/hash.h>
 #include <kernel/object_pool.h>
 #include <kernel/vm.h>
@@ -23,6 +25,7 @@
 #include <kernel/core/tick.h>
 #include <kernel/core/semaphore.h>
 #include <kernel/core/irq.h>
+#include <kernel/core/latency_stat.h>
 #include <kernel/signal.h>
 #include <kernel/time.h>
 
@@ -35,7 +38,7 @@ struct KObjectPool *k_task_cache;
 // Size of PID hash table
 #define NBUCKET   256
 
-// Process ID hash table
+// Process ID hash table. Lookups are lock-free, the lock serializes updates
 static struct {
   struct KListLink table[NBUCKET];
   struct KSpinLock lock;
@@ -61,6 +64,7 @@ process_ctor(void *buf, size_t)
   struct Process *proc = (struct Process *) buf;
 
   k_waitqueue_init(&proc->wait_queue);
+  k_waitqueue_init(&proc->thread_queue);
   k_list_init(&proc->children);
 }
 
@@ -100,10 +104,12 @@ process_init(void)
 
 pid_t next_pid;
 
-struct Process *
-process_alloc(void)
+static void thread_free(struct Thread *);
+
+// Allocate a new thread of the given process along with its kernel stack
+static struct Thread *
+thread_alloc(struct Process *process)
 {
-  struct Process *process;
   struct Thread *thread;
   struct Page *stack_page;
   uint8_t *stack;
@@ -111,30 +117,28 @@ process_alloc(void)
   if ((thread = (struct Thread *) k_object_pool_get(thread_cache)) == NULL)
     return NULL;
 
-  if ((process = (struct Process *) k_object_pool_get(process_cache)) == NULL) {
-    k_object_pool_put(thread_cache, thread);
-    return NULL;
-  }
-
   if ((stack_page = page_alloc_one(0, PAGE_TAG_KSTACK)) == NULL) {
     k_object_pool_put(thread_cache, thread);
-    k_object_pool_put(process_cache, process);
     return NULL;
   }
 
   stack = (uint8_t *) page2kva(stack_page);
   stack_page->ref_count++;
 
-  process->thread = thread;
-  thread->process = process;
+  thread->process   = process;
+  thread->tid       = 0;
+  thread->clear_tid = 0;
+  k_list_null(&thread->process_link);
+
+  sigemptyset(&thread->signal_mask);
+  memset(thread->signal_pending, 0, sizeof(thread->signal_pending));
 
   // Leave space for trap frame
   thread->tf = (struct TrapFrame *) (stack + PAGE_SIZE - sizeof(struct TrapFrame));
   memset(thread->tf, 0, sizeof(struct TrapFrame));
 
-  if (k_task_create(&thread->task, thread, process_run, process, stack, PAGE_SIZE - sizeof(struct TrapFrame), NZERO)) {
+  if (k_task_create(&thread->task, thread, process_run, thread, stack, PAGE_SIZE - sizeof(struct TrapFrame), NZERO)) {
     k_object_pool_put(thread_cache, thread);
-    k_object_pool_put(process_cache, process);
 
     stack_page->ref_count--;
     page_free_one(stack_page);
@@ -142,6 +146,62 @@ process_alloc(void)
     return NULL;
   }
 
+  return thread;
+}
+
+// Copy the scheduling policy, the nice value and the CPU affinity
+static void
+thread_inherit_sched(struct Thread *thread, struct Thread *parent)
+{
+  int policy, priority;
+
+  k_task_get_policy(&parent->task, &policy, &priority);
+  k_task_set_policy(&thread->task, policy, priority);
+  k_task_set_nice(&thread->task, k_task_get_nice(&parent->task));
+  k_task_set_affinity(&thread->task, k_task_get_affinity(&parent->task));
+}
+
+// Wake up all threads of the process (except the given one) if they are
+// sleeping or suspended, so they recheck the process state on their way back
+// to user mode
+static void
+process_interrupt_threads(struct Process *process, struct Thread *except)
+{
+  struct KListLink *l;
+
+  k_assert(k_spinlock_holding(&__process_lock));
+
+  K_LIST_FOREACH(&process->threads, l) {
+    struct Thread *thread = K_CONTAINER_OF(l, struct Thread, process_link);
+
+    if (thread == except)
+      continue;
+
+    k_task_wake(&thread->task);
+    k_task_resume(&thread->task);
+  }
+}
+
+struct Process *
+process_alloc(void)
+{
+  struct Process *process;
+  struct Thread *thread;
+
+  if ((process = (struct Process *) k_object_pool_get(process_cache)) == NULL)
+    return NULL;
+
+  if ((thread = thread_alloc(process)) == NULL) {
+    k_object_pool_put(process_cache, process);
+    return NULL;
+  }
+
+  process->thread = thread;
+
+  k_list_init(&process->threads);
+  k_list_add_back(&process->threads, &thread->process_link);
+  process->nthreads = 1;
+
   k_list_init(&process->children);
   k_list_null(&process->pid_link);
   k_list_null(&process->link);
@@ -160,19 +220,22 @@ process_alloc(void)
   process->times.tms_cutime = 0;
   process->times.tms_cstime = 0;
 
-  k_timer_create(&process->itimers[ITIMER_PROF].timer, process_itimer, (void *) process->pid, 0, 0);
-  k_timer_create(&process->itimers[ITIMER_REAL].timer, process_itimer, (void *) process->pid, 0, 0);
-  k_timer_create(&process->itimers[ITIMER_VIRTUAL].timer, process_itimer, (void *) process->pid, 0, 0);
-
   k_spinlock_acquire(&pid_hash.lock);
 
   if ((process->pid = ++next_pid) < 0)
     k_panic("pid overflow");
 
-  HASH_PUT(pid_hash.table, &process->pid_link, process->pid);
+  HASH_PUT_RCU(pid_hash.table, &process->pid_link, process->pid);
 
   k_spinlock_release(&pid_hash.lock);
 
+  // The main thread shares its ID with the process
+  thread->tid = process->pid;
+
+  hrtimer_create(&process->itimers[ITIMER_PROF], process_itimer, (void *) process->pid);
+  hrtimer_create(&process->itimers[ITIMER_REAL], process_itimer, (void *) process->pid);
+  hrtimer_create(&process->itimers[ITIMER_VIRTUAL], process_itimer, (void *) process->pid);
+
   fd_init(process);
 
   return process;
@@ -225,7 +288,7 @@ process_load_binary(struct Process *proc, const void *binary)
   if (addr != (VIRT_USTACK_TOP - USTACK_SIZE))
     return (int) addr;
 
-  return arch_trap_frame_init(proc, elf->entry, 0, 0, 0, VIRT_USTACK_TOP);
+  return arch_trap_frame_init(proc->thread, elf->entry, 0, 0, 0, VIRT_USTACK_TOP);
 }
 
 int
@@ -269,6 +332,17 @@ fail1:
   return r;
 }
 
+static void
+process_free_rcu(struct KRcuHead *head)
+{
+  struct Process *process = K_CONTAINER_OF(head, struct Process, rcu);
+
+  k_list_null(&process->pid_link);
+
+  // Return the process descriptor to the cache
+  k_object_pool_put(process_cache, process);
+}
+
 /**
  * Free all resources associated with a process.
  * 
@@ -282,31 +356,40 @@ process_free(struct Process *process)
   process_unlock();
 
   k_spinlock_acquire(&pid_hash.lock);
-  k_list_remove(&process->pid_link);
+  HASH_REMOVE_RCU(&process->pid_link);
   k_spinlock_release(&pid_hash.lock);
 
-  // Return the process descriptor to the cache
   k_assert(process->thread == NULL);
-  k_object_pool_put(process_cache, process);
+
+  // A concurrent pid_lookup() may still be looking at the descriptor
+  k_rcu_call(&process->rcu, process_free_rcu);
 }
 
+/**
+ * Find a process by its ID.
+ *
+ * The caller must be inside an RCU read-side critical section (or hold the
+ * process lock) to make sure the descriptor is not freed while it is being
+ * used. The process may still be exiting, so the caller should check its state
+ * under the process lock.
+ */
 struct Process *
 pid_lookup(pid_t pid)
 {
   struct KListLink *l;
   struct Process *proc;
 
-  k_spinlock_acquire(&pid_hash.lock);
+  k_rcu_read_lock();
 
-  HASH_FOREACH_ENTRY(pid_hash.table, l, pid) {
+  HASH_FOREACH_ENTRY_RCU(pid_hash.table, l, pid) {
     proc = K_CONTAINER_OF(l, struct Process, pid_link);
     if (proc->pid == pid) {
-      k_spinlock_release(&pid_hash.lock);
+      k_rcu_read_unlock();
       return proc;
     }
   }
 
-  k_spinlock_release(&pid_hash.lock);
+  k_rcu_read_unlock();
   return NULL;
 }
 
@@ -321,10 +404,14 @@ process_destroy(int status)
   // if(status)
   //   cprintf("[k] process #%d destroyed with code 0x%x\n", current->pid, status);
 
+  // Another thread is already terminating the process
+  if (_process_exit_threads() != 0)
+    process_thread_exit();
+
   // Remove the pid hash link
   // TODO: place this code somewhere else?
   k_spinlock_acquire(&pid_hash.lock);
-  HASH_REMOVE(&current->pid_link);
+  HASH_REMOVE_RCU(&current->pid_link);
   k_spinlock_release(&pid_hash.lock);
 
   fd_close_all(current);
@@ -335,6 +422,11 @@ process_destroy(int status)
 
   k_assert(init_process != NULL);
 
+  // The timer callbacks acquire the process lock
+  hrtimer_stop(&current->itimers[ITIMER_PROF]);
+  hrtimer_stop(&current->itimers[ITIMER_REAL]);
+  hrtimer_stop(&current->itimers[ITIMER_VIRTUAL]);
+
   process_lock();
 
   vm = current->vm;
@@ -343,10 +435,6 @@ process_destroy(int status)
   // Switch to the kernel page table since vm will be destroyed shortly
   arch_vm_load_kernel();
 
-  k_timer_destroy(&current->itimers[ITIMER_PROF].timer);
-  k_timer_destroy(&current->itimers[ITIMER_REAL].timer);
-  k_timer_destroy(&current->itimers[ITIMER_VIRTUAL].timer);
-
   // Move children to the init process
   has_zombies = 0;
   while (!k_list_is_empty(&current->children)) {
@@ -372,6 +460,11 @@ process_destroy(int status)
 
   _signal_state_change_to_parent(current);
 
+  _signal_thread_exit(current->thread);
+
+  k_list_remove(&current->thread->process_link);
+  current->nthreads = 0;
+
   current->thread->process = NULL;
   current->thread = NULL;
 
@@ -421,6 +514,10 @@ process_copy(int share_vm)
 
   process_unlock();
 
+  // The child inherits the scheduling policy, the nice value and the CPU
+  // affinity of the calling thread
+  thread_inherit_sched(child->thread, thread_current());
+
   // cprintf("[k] process #%x created\n", child->pid);
 
   k_assert(child->thread != NULL);
@@ -429,6 +526,158 @@ process_copy(int share_vm)
   return child->pid;
 }
 
+/**
+ * Create a new thread in the current process.
+ *
+ * The new thread shares the address space, the open connections, the working
+ * directory and the signal actions with the calling thread, and inherits its
+ * signal mask and scheduling parameters.
+ *
+ * @param entry     User address to start the thread execution at.
+ * @param arg       Argument to be passed to the entry point.
+ * @param stack     Top of the user stack of the new thread.
+ * @param clear_tid User address to store the new thread ID at (or 0). When the
+ *                  thread exits, this location is cleared and the futex
+ *                  waiters on it are woken up.
+ *
+ * @return The ID of the new thread, or a negative error code.
+ */
+pid_t
+process_thread_create(uintptr_t entry, uintptr_t arg, uintptr_t stack,
+                      uintptr_t clear_tid)
+{
+  struct Thread *thread, *current = thread_current();
+  struct Process *process = current->process;
+  pid_t tid;
+  int r;
+
+  if ((thread = thread_alloc(process)) == NULL)
+    return -ENOMEM;
+
+  k_spinlock_acquire(&pid_hash.lock);
+
+  if ((tid = thread->tid = ++next_pid) < 0)
+    k_panic("pid overflow");
+
+  k_spinlock_release(&pid_hash.lock);
+
+  arch_trap_frame_init(thread, entry, arg, 0, 0, stack);
+
+  // Store the ID before the thread starts, so it can be joined right away
+  if (clear_tid != 0) {
+    if ((r = vm_copy_out(process->vm->pgtab, &tid, clear_tid, sizeof tid)) < 0)
+      goto fail;
+    thread->clear_tid = clear_tid;
+  }
+
+  thread->signal_mask = current->signal_mask;
+  thread_inherit_sched(thread, current);
+
+  process_lock();
+
+  if (process->flags & PROCESS_STATUS_EXITING) {
+    process_unlock();
+    r = -EINTR;
+    goto fail;
+  }
+
+  k_list_add_back(&process->threads, &thread->process_link);
+  process->nthreads++;
+
+  process_unlock();
+
+  k_task_resume(&thread->task);
+
+  return tid;
+
+fail:
+  thread_free(thread);
+  return r;
+}
+
+/**
+ * Terminate the calling thread.
+ *
+ * If this is the last thread of the process, the process exits with status 0.
+ */
+void
+process_thread_exit(void)
+{
+  struct Thread *current = thread_current();
+  struct Process *process = current->process;
+  int zero = 0;
+
+  // The address space is still there, since the process cannot exit until
+  // this thread is removed from the list
+  if (current->clear_tid != 0) {
+    vm_copy_out(process->vm->pgtab, &zero, current->clear_tid, sizeof zero);
+    futex_wake(current->clear_tid, INT_MAX);
+  }
+
+  process_lock();
+
+  if (process->nthreads == 1) {
+    process_unlock();
+    process_destroy(0);
+    return;
+  }
+
+  k_list_remove(&current->process_link);
+  process->nthreads--;
+
+  if (process->thread == current)
+    process->thread = K_CONTAINER_OF(process->threads.next, struct Thread,
+                                     process_link);
+
+  _signal_thread_exit(current);
+
+  k_waitqueue_wakeup_all(&process->thread_queue);
+
+  current->process = NULL;
+
+  process_unlock();
+
+  k_task_exit();
+}
+
+/*
+ * Terminate all threads of the current process except the calling one, and
+ * wait until they exit. The calling thread becomes the main thread.
+ *
+ * Returns 0 on success, or -EINTR if another thread is already terminating
+ * the process (the caller must exit as soon as possible then).
+ */
+int
+_process_exit_threads(void)
+{
+  struct Thread *current = thread_current();
+  struct Process *process = current->process;
+
+  process_lock();
+
+  if (process->flags & PROCESS_STATUS_EXITING) {
+    process_unlock();
+    return -EINTR;
+  }
+
+  if (process->nthreads > 1) {
+    process->flags |= PROCESS_STATUS_EXITING;
+    process->thread = current;
+
+    // The other threads check the flag before returning to user mode
+    process_interrupt_threads(process, current);
+
+    while (process->nthreads > 1)
+      k_waitqueue_sleep(&process->thread_queue, &__process_lock);
+
+    process->flags &= ~PROCESS_STATUS_EXITING;
+  }
+
+  process_unlock();
+
+  return 0;
+}
+
 /**
  * Check whether the given process ID or group ID matches the given argument.
  * 
@@ -546,7 +795,8 @@ process_run(void *arg)
 {
   static int first;
 
-  struct Process *process = (struct Process *) arg;
+  struct Thread *thread = (struct Thread *) arg;
+  struct Process *process = thread->process;
 
   if (!first) {
     first = 1;
@@ -561,8 +811,7 @@ process_run(void *arg)
   k_irq_disable();
 
   // "Return" to the user space.
-  k_assert(process->thread != NULL);
-  arch_trap_frame_pop(process->thread->tf);
+  arch_trap_frame_pop(thread->tf);
 }
 
 void *
@@ -627,6 +876,244 @@ process_set_gid(pid_t pid, pid_t pgid)
   return r;
 }
 
+// Check whether the current process may change the scheduling parameters of
+// the given one
+static int
+process_may_schedule(struct Process *process)
+{
+  struct Process *current = process_current();
+
+  k_assert(k_spinlock_holding(&__process_lock));
+
+  return (current->euid == 0) || (current->euid == process->euid);
+}
+
+// Select the thread whose scheduling parameters are accessed through the given
+// process ID: the calling thread for the calling process, and the main thread
+// for other processes
+static struct Thread *
+process_sched_thread(pid_t pid)
+{
+  struct Process *process;
+
+  k_assert(k_spinlock_holding(&__process_lock));
+
+  if ((pid == 0) || (pid == process_current()->pid))
+    return thread_current();
+
+  // Zombie processes have no thread
+  if ((process = pid_lookup(pid)) == NULL)
+    return NULL;
+
+  return process->thread;
+}
+
+int
+process_set_scheduler(pid_t pid, int policy, const struct sched_param *param)
+{
+  struct Thread *thread;
+  int task_policy, old_policy, priority;
+  int r;
+
+  // Real-time priorities 1..NZERO-1 are mapped to the kernel priorities above
+  // K_TASK_FAIR_PRIORITY (a lower number means a higher priority)
+  switch (policy) {
+  case SCHED_OTHER:
+    if (param->sched_priority != 0)
+      return -EINVAL;
+    task_policy = K_TASK_POLICY_FAIR;
+    priority    = K_TASK_FAIR_PRIORITY;
+    break;
+  case SCHED_FIFO:
+  case SCHED_RR:
+    if ((param->sched_priority < 1) ||
+        (param->sched_priority >= K_TASK_FAIR_PRIORITY))
+      return -EINVAL;
+    task_policy = policy == SCHED_FIFO ? K_TASK_POLICY_FIFO : K_TASK_POLICY_RR;
+    priority    = K_TASK_FAIR_PRIORITY - param->sched_priority;
+    break;
+  default:
+    return -EINVAL;
+  }
+
+  if (pid < 0)
+    return -EINVAL;
+
+  process_lock();
+
+  thread = process_sched_thread(pid);
+
+  if (thread == NULL) {
+    r = -ESRCH;
+  } else if (!process_may_schedule(thread->process) ||
+             ((task_policy != K_TASK_POLICY_FAIR) &&
+              (process_current()->euid != 0))) {
+    r = -EPERM;
+  } else {
+    k_task_get_policy(&thread->task, &old_policy, NULL);
+    r = k_task_set_policy(&thread->task, task_policy, priority);
+
+    if (r == 0) {
+      switch (old_policy) {
+      case K_TASK_POLICY_FIFO:
+        r = SCHED_FIFO;
+        break;
+      case K_TASK_POLICY_RR:
+        r = SCHED_RR;
+        break;
+      default:
+        r = SCHED_OTHER;
+        break;
+      }
+    }
+  }
+
+  process_unlock();
+
+  return r;
+}
+
+int
+process_get_param(pid_t pid, struct sched_param *param)
+{
+  struct Thread *thread;
+  int policy, priority;
+  int r;
+
+  if (pid < 0)
+    return -EINVAL;
+
+  process_lock();
+
+  thread = process_sched_thread(pid);
+
+  if (thread == NULL) {
+    r = -ESRCH;
+  } else {
+    k_task_get_policy(&thread->task, &policy, &priority);
+
+    param->sched_priority = (policy == K_TASK_POLICY_FAIR)
+                          ? 0
+                          : K_TASK_FAIR_PRIORITY - priority;
+    r = 0;
+  }
+
+  process_unlock();
+
+  return r;
+}
+
+int
+process_nice(int incr)
+{
+  struct Process *current = process_current();
+  struct KTask *task = &thread_current()->task;
+  int nice;
+
+  // Only a privileged process may increase its priority
+  if ((incr < 0) && (current->euid != 0))
+    return -EPERM;
+
+  nice = k_task_get_nice(task) + incr;
+  if (nice < K_TASK_NICE_MIN)
+    nice = K_TASK_NICE_MIN;
+  if (nice > K_TASK_NICE_MAX)
+    nice = K_TASK_NICE_MAX;
+
+  k_task_set_nice(task, nice);
+
+  // Return a non-negative value, so it cannot be confused with an error code
+  return nice + NZERO;
+}
+
+int
+process_set_affinity(pid_t pid, unsigned long mask)
+{
+  struct Thread *thread;
+  int r;
+
+  if (pid < 0)
+    return -EINVAL;
+
+  process_lock();
+
+  thread = process_sched_thread(pid);
+
+  if (thread == NULL) {
+    r = -ESRCH;
+  } else if (!process_may_schedule(thread->process)) {
+    r = -EPERM;
+  } else {
+    r = k_task_set_affinity(&thread->task, mask);
+  }
+
+  process_unlock();
+
+  return r;
+}
+
+int
+process_get_affinity(pid_t pid, unsigned long *mask)
+{
+  struct Thread *thread;
+  int r;
+
+  if (pid < 0)
+    return -EINVAL;
+
+  process_lock();
+
+  thread = process_sched_thread(pid);
+
+  if (thread == NULL) {
+    r = -ESRCH;
+  } else {
+    *mask = k_task_get_affinity(&thread->task);
+    r = 0;
+  }
+
+  process_unlock();
+
+  return r;
+}
+
+/**
+ * Get the longest wakeup latency of each thread of all processes.
+ *
+ * @param info Array to store the statistics.
+ * @param max  The maximum number of entries to store.
+ *
+ * @return The number of entries stored.
+ */
+int
+process_latency_stat(struct ThreadLatencyInfo *info, int max)
+{
+  struct KListLink *pl, *tl;
+  int n = 0;
+
+  process_lock();
+
+  K_LIST_FOREACH(&__process_list, pl) {
+    struct Process *process = K_CONTAINER_OF(pl, struct Process, link);
+
+    K_LIST_FOREACH(&process->threads, tl) {
+      struct Thread *thread = K_CONTAINER_OF(tl, struct Thread, process_link);
+
+      if (n >= max)
+        break;
+
+      info[n].pid        = process->pid;
+      info[n].tid        = thread->tid;
+      info[n].wakeup_max = k_latency_stat_task_max(&thread->task);
+      n++;
+    }
+  }
+
+  process_unlock();
+
+  return n;
+}
+
 void
 process_update_times(struct Process *process, clock_t user, clock_t system)
 {
@@ -646,7 +1133,7 @@ _process_continue(struct Process *process)
     process->state = PROCESS_STATE_ACTIVE;
     k_assert(process->flags != 0);
     k_assert(process->thread != NULL);
-    k_task_wake(&process->thread->task);
+    process_interrupt_threads(process, NULL);
 
     _signal_state_change_to_parent(process);
   }
@@ -672,28 +1159,28 @@ int
 process_set_itimer(int which, struct itimerval *value, struct itimerval *ovalue)
 {
   struct Process *process = process_current();
+  struct HRTimer *timer;
+  uint64_t remaining;
 
   if (which != ITIMER_REAL) {
     cprintf("TODO: itimer %d\n", which);
     return -EINVAL;
   }
 
-  process_lock();
+  timer = &process->itimers[which];
 
-  // TODO: reimplement using timers
-  k_timer_stop(&process->itimers[which].timer);
+  // Do not hold the process lock, since the timer callback acquires it
+  remaining = hrtimer_stop(timer);
 
-  if (value->it_value.tv_sec != 0 || value->it_value.tv_usec != 0) {
-    k_timer_create(&process->itimers[which].timer,
-      process_itimer, (void *) process->pid,
-      timeval2ticks(&value->it_value), timeval2ticks(&value->it_interval));
-    k_timer_start(&process->itimers[which].timer);
+  if (ovalue != NULL) {
+    ns2timeval(remaining, &ovalue->it_value);
+    ns2timeval(remaining != 0 ? timer->period : 0, &ovalue->it_interval);
   }
 
-  if (ovalue != NULL)
-    *ovalue = process->itimers[which].value;
-
-  process_unlock();
+  if (value->it_value.tv_sec != 0 || value->it_value.tv_usec != 0)
+    hrtimer_start(timer,
+                  hrtimer_now() + timeval2ns(&value->it_value),
+                  timeval2ns(&value->it_interval));
 
   return 0;
 }
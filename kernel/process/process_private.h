@@ -1,18 +1,25 @@
 #ifndef __PROCESS_PRIVATE_H
 #define __PROCESS_PRIVATE_H
 
+#include <sys/types.h>
+
 #include <kernel/core/list.h>
 #include <kernel/core/spinlock.h>
 
 struct Process;
+struct Thread;
 
 extern struct KSpinLock __process_lock;
 extern struct KListLink __process_list;
 
 void _process_continue(struct Process *);
 void _process_stop(struct Process *);
+int  _process_exit_threads(void);
+
+struct Process *pid_lookup(pid_t);
 
 void _signal_state_change_to_parent(struct Process *);
+void _signal_thread_exit(struct Thread *);
 
 static inline void
 process_lock(void)
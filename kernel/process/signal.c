@@ -7,6 +7,7 @@
 #include <kernel/process.h>
 #include <kernel/signal.h>
 #include <kernel/vmspace.h>
+#include <kernel/core/rcu.h>
 #include <kernel/core/task.h>
 #include <kernel/console.h>
 
@@ -16,8 +17,9 @@ static struct Signal *signal_create(int, int, uintptr_t);
 static void           signal_free(struct Signal *);
 static int            signal_action_default(struct Process *, struct Signal *, struct sigaction *);
 static int            signal_action_custom(struct Process *, struct Signal *, struct sigaction *);
-static struct Signal *signal_dequeue(struct Process *);
-static int            signal_generate_one(struct Process *, int, int);
+static struct Signal *signal_dequeue(struct Process *, struct Thread *);
+static int            signal_generate_one(struct Process *, struct Thread *, int, int);
+static int            signal_generate_pid(pid_t, int, int);
 static void           signal_ctor(void *, size_t);
 static void           signal_dtor(void *, size_t);
 
@@ -104,7 +106,7 @@ signal_clone(struct Process *parent, struct Process *child)
 
   // process->signal_queue initialized in process_ctor
   child->signal_stub = parent->signal_stub;
-  child->thread->signal_mask = parent->thread->signal_mask;
+  child->thread->signal_mask = thread_current()->signal_mask;
 
   for (i = 0; i < NSIG; i++) {
     child->signal_actions[i] = parent->signal_actions[i];
@@ -146,23 +148,45 @@ signal_can_be_ignored(int signo)
 static void
 signal_discard(struct Process *process, int signo)
 {
+  struct KListLink *l;
+
   k_assert(process->thread != NULL);
 
-  struct Signal *s = process->thread->signal_pending[SIGNAL_INDEX(signo)];
-  if (s != NULL) {
-    process->thread->signal_pending[SIGNAL_INDEX(signo)] = NULL;
-    k_list_remove(&s->link);
+  K_LIST_FOREACH(&process->threads, l) {
+    struct Thread *thread = K_CONTAINER_OF(l, struct Thread, process_link);
+    struct Signal *s = thread->signal_pending[SIGNAL_INDEX(signo)];
+
+    if (s != NULL) {
+      thread->signal_pending[SIGNAL_INDEX(signo)] = NULL;
+      k_list_remove(&s->link);
+      signal_free(s);
+    }
   }
 }
 
 static int
-signal_is_blocked(struct Process *process, int signo)
+signal_is_blocked(struct Thread *thread, int signo)
 {
-  k_assert(process->thread != NULL);
-
   if (!signal_can_be_ignored(signo))
     return 0;
-  return sigismember(&process->thread->signal_mask, signo);
+  return sigismember(&thread->signal_mask, signo);
+}
+
+// Select the thread to deliver a process-directed signal to
+static struct Thread *
+signal_target(struct Process *process, int signo)
+{
+  struct KListLink *l;
+
+  K_LIST_FOREACH(&process->threads, l) {
+    struct Thread *thread = K_CONTAINER_OF(l, struct Thread, process_link);
+
+    if (!signal_is_blocked(thread, signo))
+      return thread;
+  }
+
+  // All threads block the signal, leave it pending for the main thread
+  return process->thread;
 }
 
 int
@@ -209,7 +233,7 @@ signal_action_change(int signo,
 int
 signal_pending(sigset_t *set)
 {
-  struct Process *process = process_current();
+  struct Thread *thread = thread_current();
   int i;
 
   if (set == NULL)
@@ -219,10 +243,8 @@ signal_pending(sigset_t *set)
 
   process_lock();
 
-  k_assert(process->thread != NULL);
-  
   for (i = 1; i <= NSIG; i++)
-    if (process->thread->signal_pending[SIGNAL_INDEX(i)] != NULL)
+    if (thread->signal_pending[SIGNAL_INDEX(i)] != NULL)
       sigaddset(set, i);
 
   process_unlock();
@@ -233,13 +255,11 @@ signal_pending(sigset_t *set)
 int
 signal_mask_change(int how, const sigset_t *set, sigset_t *old_set)
 {
-  struct Process *process = process_current();
+  struct Thread *thread = thread_current();
   int r = 0, i;
 
-  k_assert(process->thread != NULL);
-
   if (old_set != NULL)
-    *old_set = process->thread->signal_mask;
+    *old_set = thread->signal_mask;
 
   if (set == NULL)
     return r;
@@ -248,20 +268,20 @@ signal_mask_change(int how, const sigset_t *set, sigset_t *old_set)
 
   switch (how) {
   case SIG_SETMASK:
-    process->thread->signal_mask = *set;
-    sigdelset(&process->thread->signal_mask, SIGKILL);
+    thread->signal_mask = *set;
+    sigdelset(&thread->signal_mask, SIGKILL);
     break;
 
   case SIG_BLOCK:
     for (i = 1; i <= NSIG; i++)
       if ((i != SIGKILL) && sigismember(set, i))
-        sigaddset(&process->thread->signal_mask, i);
+        sigaddset(&thread->signal_mask, i);
     break;
 
   case SIG_UNBLOCK:
     for (i = 1; i <= NSIG; i++)
       if (sigismember(set, i))
-        sigdelset(&process->thread->signal_mask, i);
+        sigdelset(&thread->signal_mask, i);
     break;
 
   default:
@@ -277,7 +297,7 @@ signal_mask_change(int how, const sigset_t *set, sigset_t *old_set)
 int
 signal_suspend(const sigset_t *mask)
 {
-  struct Process *process = process_current();
+  struct Thread *thread = thread_current();
   struct KWaitQueue wait_chan;
   sigset_t saved_mask;
   int r;
@@ -287,17 +307,15 @@ signal_suspend(const sigset_t *mask)
 
   process_lock();
 
-  k_assert(process->thread != NULL);
-
-  saved_mask = process->thread->signal_mask;
+  saved_mask = thread->signal_mask;
 
-  process->thread->signal_mask = *mask;
-  sigdelset(&process->thread->signal_mask, SIGKILL);
+  thread->signal_mask = *mask;
+  sigdelset(&thread->signal_mask, SIGKILL);
 
   k_waitqueue_init(&wait_chan);
   r = k_waitqueue_sleep(&wait_chan, &__process_lock);
 
-  process->thread->signal_mask = saved_mask;
+  thread->signal_mask = saved_mask;
 
   process_unlock();
 
@@ -322,7 +340,7 @@ _signal_state_change_to_parent(struct Process *process)
       return;
   }
 
-  signal_generate_one(parent, SIGCHLD, 0);
+  signal_generate_one(parent, NULL, SIGCHLD, 0);
 
   k_waitqueue_wakeup_all(&parent->wait_queue);
 }
@@ -336,13 +354,11 @@ signal_return(void)
 
   process_lock();
 
-  k_assert(current->thread != NULL);
-
   if ((r = arch_signal_return(current, &frame, &ret)) != 0)
     return r;
 
-  current->thread->signal_mask = frame.ucontext.uc_sigmask;
-  sigdelset(&current->thread->signal_mask, SIGKILL);
+  thread_current()->signal_mask = frame.ucontext.uc_sigmask;
+  sigdelset(&thread_current()->signal_mask, SIGKILL);
 
   process_unlock();
 
@@ -355,6 +371,11 @@ signal_generate(pid_t pid, int signo, int code)
   struct KListLink *l;
   int r = 0;
 
+  // RCU readers need a current task (see kernel/core/rcu.h), so a timer
+  // callback on an idle CPU walks the process list instead
+  if ((pid > 0) && (k_task_current() != NULL))
+    return signal_generate_pid(pid, signo, code);
+
   process_lock();
 
   K_LIST_FOREACH(&__process_list, l) {
@@ -369,7 +390,7 @@ signal_generate(pid_t pid, int signo, int code)
     if (process->thread == NULL)
       continue;
 
-    if ((r = signal_generate_one(process, signo, code)) != 0)
+    if ((r = signal_generate_one(process, NULL, signo, code)) != 0)
       break;
   }
 
@@ -378,8 +399,58 @@ signal_generate(pid_t pid, int signo, int code)
   return r;
 }
 
+// Generate a signal for a single process. The process is looked up without
+// holding the process lock, which is only taken to queue the signal
 static int
-signal_generate_one(struct Process *process, int signo, int code)
+signal_generate_pid(pid_t pid, int signo, int code)
+{
+  struct Process *process;
+  int r = 0;
+
+  // Keep the descriptor from being freed until the process lock is taken
+  k_rcu_read_lock();
+
+  if (((process = pid_lookup(pid)) != NULL) && (signo != 0)) {
+    process_lock();
+
+    // Zombie processes have no thread
+    if (process->thread != NULL)
+      r = signal_generate_one(process, NULL, signo, code);
+
+    process_unlock();
+  }
+
+  k_rcu_read_unlock();
+
+  return r;
+}
+
+/**
+ * Generate a signal for the given thread, e.g. on a synchronous fault that
+ * must be handled by the thread that caused it.
+ *
+ * @param thread The target thread.
+ * @param signo  The signal number.
+ * @param code   The signal code.
+ *
+ * @return 0 on success, or a negative error code.
+ */
+int
+signal_generate_thread(struct Thread *thread, int signo, int code)
+{
+  int r;
+
+  process_lock();
+  r = signal_generate_one(thread->process, thread, signo, code);
+  process_unlock();
+
+  return r;
+}
+
+// Queue the signal for the given thread, or for the process if thread is NULL
+static int
+signal_generate_one(struct Process *process, struct Thread *thread, int signo,
+                    int code)
 {
   struct Signal *signal;
 
@@ -388,8 +459,11 @@ signal_generate_one(struct Process *process, int signo, int code)
 
   // TODO: check for permissions
 
+  if (thread == NULL)
+    thread = signal_target(process, signo);
+
   // Do not queue subsequent occurences of the same signal
-  if (process->thread->signal_pending[SIGNAL_INDEX(signo)])
+  if (thread->signal_pending[SIGNAL_INDEX(signo)])
     return 0;
 
   // If a stop signal is generated, discard all pending continue signals (and
@@ -412,12 +486,12 @@ signal_generate_one(struct Process *process, int signo, int code)
   if ((signal = signal_create(signo, code, 0)) == NULL)
     return -ENOMEM;
 
-  k_list_add_back(&process->thread->signal_queue, &signal->link);
-  process->thread->signal_pending[SIGNAL_INDEX(signo)] = signal;
+  k_list_add_back(&thread->signal_queue, &signal->link);
+  thread->signal_pending[SIGNAL_INDEX(signo)] = signal;
 
   // Blocked signals remain pending
-  if (!signal_is_blocked(process, signo)) {
-    k_task_wake(&process->thread->task);
+  if (!signal_is_blocked(thread, signo)) {
+    k_task_wake(&thread->task);
   }
 
   return 0;
@@ -441,14 +515,22 @@ signal_create(int signo, int code, uintptr_t value)
 void
 signal_deliver_pending(void)
 {
-  struct Process *process = process_current();
+  struct Thread *thread = thread_current();
+  struct Process *process = thread->process;
   struct Signal *signal;
   struct sigaction *sa;
   int exit_code = 0;
 
   process_lock();
 
-  if ((signal = signal_dequeue(process)) == NULL) {
+  // Another thread is terminating the process
+  if ((process->flags & PROCESS_STATUS_EXITING) && (process->thread != thread)) {
+    process_unlock();
+    process_thread_exit();
+    return;
+  }
+
+  if ((signal = signal_dequeue(process, thread)) == NULL) {
     process_unlock();
     return;
   }
@@ -473,16 +555,16 @@ signal_deliver_pending(void)
 }
 
 static struct Signal *
-signal_dequeue(struct Process *process)
+signal_dequeue(struct Process *process, struct Thread *thread)
 {
   struct KListLink *link;
 
-  K_LIST_FOREACH(&process->thread->signal_queue, link) {
+  K_LIST_FOREACH(&thread->signal_queue, link) {
     struct Signal *signal = K_CONTAINER_OF(link, struct Signal, link);
     int signo = signal->info.si_signo;
 
     // Blocked signals remain pending until either unblocked or accepted
-    if (signal_is_blocked(process, signo))
+    if (signal_is_blocked(thread, signo))
       continue;
 
     // If stopped, all signals except SIGKILL shall not be delivered until the
@@ -492,7 +574,7 @@ signal_dequeue(struct Process *process)
       continue;
 
     k_list_remove(&signal->link);
-    process->thread->signal_pending[SIGNAL_INDEX(signo)] = NULL;
+    thread->signal_pending[SIGNAL_INDEX(signo)] = NULL;
 
     return signal;
   }
@@ -570,12 +652,12 @@ signal_action_custom(struct Process *process,
 
   frame.info = signal->info;
   frame.handler = (uintptr_t) sa->sa_handler;
-  frame.ucontext.uc_sigmask = process->thread->signal_mask;
+  frame.ucontext.uc_sigmask = thread_current()->signal_mask;
 
   if (arch_signal_prepare(process, &frame) != 0)
     return SIGKILL;
     
-  process->thread->signal_mask |= sa->sa_mask;
+  thread_current()->signal_mask |= sa->sa_mask;
 
   if (sa->sa_flags & SA_RESETHAND)
     sa->sa_handler = SIG_DFL;
@@ -583,6 +665,41 @@ signal_action_custom(struct Process *process,
   return 0;
 }
 
+/*
+ * Hand the signals pending for an exiting thread over to the main thread, so
+ * that process-directed signals are not lost. If the exiting thread is the
+ * main one, the signals are discarded.
+ */
+void
+_signal_thread_exit(struct Thread *thread)
+{
+  struct Process *process = thread->process;
+  struct Thread *target = process->thread;
+
+  k_assert(k_spinlock_holding(&__process_lock));
+
+  while (!k_list_is_empty(&thread->signal_queue)) {
+    struct Signal *signal = K_CONTAINER_OF(thread->signal_queue.next,
+                                           struct Signal, link);
+    int signo = signal->info.si_signo;
+
+    k_list_remove(&signal->link);
+    thread->signal_pending[SIGNAL_INDEX(signo)] = NULL;
+
+    if ((target == thread) ||
+        (target->signal_pending[SIGNAL_INDEX(signo)] != NULL)) {
+      signal_free(signal);
+      continue;
+    }
+
+    k_list_add_back(&target->signal_queue, &signal->link);
+    target->signal_pending[SIGNAL_INDEX(signo)] = signal;
+
+    if (!signal_is_blocked(target, signo))
+      k_task_wake(&target->task);
+  }
+}
+
 static void
 signal_free(struct Signal *signal)
 {
@@ -3,19 +3,25 @@
 #include <limits.h>
 #include <stddef.h>
 #include <string.h>
+#include <sys/clone.h>
+#include <sys/futex.h>
 #include <sys/mman.h>
 #include <sys/syscall.h>
 #include <sys/stat.h>
 #include <sys/select.h>
 #include <sys/utsname.h>
 #include <netdb.h>
+#include <sched.h>
 #include <time.h>
 
 #include <kernel/console.h>
+#include <kernel/cpu_stat.h>
 #include <kernel/core/cpu.h>
 #include <kernel/fd.h>
 #include <kernel/ipc.h>
 #include <kernel/fs/fs.h>
+#include <kernel/futex.h>
+#include <kernel/hrtimer.h>
 #include <kernel/vmspace.h>
 #include <kernel/net.h>
 #include <kernel/pipe.h>
@@ -88,6 +94,14 @@ static int32_t (*syscalls[])(void) = {
   [__SYS_SYMLINK]     = sys_symlink,
   [__SYS_IPC_SEND]    = sys_ipc_send,
   [__SYS_IPC_SENDV]   = sys_ipc_sendv,
+  [__SYS_SCHED_SETSCHEDULER] = sys_sched_setscheduler,
+  [__SYS_SCHED_GETPARAM]     = sys_sched_getparam,
+  [__SYS_NICE]        = sys_nice,
+  [__SYS_SCHED_SETAFFINITY]  = sys_sched_setaffinity,
+  [__SYS_SCHED_GETAFFINITY]  = sys_sched_getaffinity,
+  [__SYS_FUTEX]       = sys_futex,
+  [__SYS_CLONE]       = sys_clone,
+  [__SYS_THREAD_EXIT] = sys_thread_exit,
 };
 
 int32_t
@@ -98,6 +112,8 @@ sys_dispatch(void)
   if ((num = sys_arch_get_num()) < 0)
     return num;
 
+  cpu_stat_inc(CPU_STAT_SYSCALLS);
+
   if ((num < (int) ARRAY_SIZE(syscalls)) && syscalls[num]) {
     int r = syscalls[num]();
 
@@ -352,6 +368,152 @@ sys_setpgid(void)
   return process_set_gid(pid, pgid);
 }
 
+int32_t
+sys_sched_setscheduler(void)
+{
+  struct sched_param *param;
+  pid_t pid;
+  int policy, r;
+
+  if ((r = sys_arg_int(0, &pid)) < 0)
+    return r;
+  if ((r = sys_arg_int(1, &policy)) < 0)
+    return r;
+  if ((r = sys_arg_buf(2, (void **) &param, sizeof *param, VM_READ)) < 0)
+    return r;
+
+  r = process_set_scheduler(pid, policy, param);
+
+  k_free(param);
+
+  return r;
+}
+
+int32_t
+sys_sched_getparam(void)
+{
+  struct sched_param param;
+  uintptr_t param_va;
+  pid_t pid;
+  int r;
+
+  if ((r = sys_arg_int(0, &pid)) < 0)
+    return r;
+  if ((r = sys_arg_va(1, &param_va, sizeof param, VM_WRITE, 0)) < 0)
+    return r;
+
+  if ((r = process_get_param(pid, &param)) < 0)
+    return r;
+
+  return sys_copy_out(&param, param_va, sizeof param);
+}
+
+int32_t
+sys_nice(void)
+{
+  int incr, r;
+
+  if ((r = sys_arg_int(0, &incr)) < 0)
+    return r;
+
+  return process_nice(incr);
+}
+
+int32_t
+sys_sched_setaffinity(void)
+{
+  unsigned long *mask, size;
+  pid_t pid;
+  int r;
+
+  if ((r = sys_arg_int(0, &pid)) < 0)
+    return r;
+  if ((r = sys_arg_ulong(1, &size)) < 0)
+    return r;
+
+  // The kernel supports at most as many CPUs as there are bits in a long
+  if (size < sizeof *mask)
+    return -EINVAL;
+
+  if ((r = sys_arg_buf(2, (void **) &mask, sizeof *mask, VM_READ)) < 0)
+    return r;
+
+  r = process_set_affinity(pid, *mask);
+
+  k_free(mask);
+
+  return r;
+}
+
+int32_t
+sys_sched_getaffinity(void)
+{
+  unsigned long mask, size;
+  uintptr_t mask_va;
+  pid_t pid;
+  int r;
+
+  if ((r = sys_arg_int(0, &pid)) < 0)
+    return r;
+  if ((r = sys_arg_ulong(1, &size)) < 0)
+    return r;
+
+  if (size < sizeof mask)
+    return -EINVAL;
+
+  if ((r = sys_arg_va(2, &mask_va, sizeof mask, VM_WRITE, 0)) < 0)
+    return r;
+
+  if ((r = process_get_affinity(pid, &mask)) < 0)
+    return r;
+
+  return sys_copy_out(&mask, mask_va, sizeof mask);
+}
+
+int32_t
+sys_futex(void)
+{
+  struct timespec *timeout;
+  uintptr_t va, va2;
+  int op, val, val2, r;
+
+  if ((r = sys_arg_va(0, &va, sizeof(int), VM_READ, 0)) < 0)
+    return r;
+  if ((r = sys_arg_int(1, &op)) < 0)
+    return r;
+  if ((r = sys_arg_int(2, &val)) < 0)
+    return r;
+
+  switch (op) {
+  case FUTEX_WAIT:
+    // A null timeout means sleeping indefinitely
+    if ((r = sys_arg_buf(3, (void **) &timeout, sizeof *timeout, VM_READ)) < 0)
+      return r;
+
+    r = futex_wait(va, val, timeout);
+
+    if (timeout != NULL)
+      k_free(timeout);
+
+    return r;
+
+  case FUTEX_WAKE:
+    return futex_wake(va, val);
+
+  case FUTEX_REQUEUE:
+    // val2 is passed in place of the timeout, as only five arguments are
+    // available on all architectures
+    if ((r = sys_arg_int(3, &val2)) < 0)
+      return r;
+    if ((r = sys_arg_va(4, &va2, sizeof(int), VM_READ, 0)) < 0)
+      return r;
+    return futex_requeue(va, val, val2, va2);
+
+  default:
+    return -ENOSYS;
+  }
+}
+
 int32_t
 sys_wait(void)
 {
@@ -395,6 +557,40 @@ sys_exit(void)
   return 0;
 }
 
+int32_t
+sys_clone(void)
+{
+  unsigned long arg, stack;
+  uintptr_t entry, ctid;
+  int flags, r;
+
+  if ((r = sys_arg_int(0, &flags)) < 0)
+    return r;
+
+  // Only threads sharing everything with the caller are supported so far
+  if (flags != CLONE_THREAD)
+    return -EINVAL;
+
+  if ((r = sys_arg_ptr(1, &entry, VM_READ, 0)) < 0)
+    return r;
+  if ((r = sys_arg_ulong(2, &arg)) < 0)
+    return r;
+  if ((r = sys_arg_ulong(3, &stack)) < 0)
+    return r;
+  if ((r = sys_arg_va(4, &ctid, sizeof(pid_t), VM_WRITE, 1)) < 0)
+    return r;
+
+  return process_thread_create(entry, arg, stack, ctid);
+}
+
+int32_t
+sys_thread_exit(void)
+{
+  process_thread_exit();
+  // Should not return
+  return 0;
+}
+
 int32_t
 sys_getpid(void)
 {
@@ -847,7 +1043,8 @@ sys_select(void)
 {
   int r, fd, nfds;
   fd_set *readfds, *writefds, *errorfds;
-  struct timeval *timeout;
+  struct timeval *timeout, remaining;
+  uint64_t deadline = 0;
 
   //cprintf("sys_select()\n");
 
@@ -862,6 +1059,9 @@ sys_select(void)
   if ((r = sys_arg_buf(4, (void *) &timeout, sizeof(*timeout), VM_READ)) < 0)
     goto out4;
 
+  if (timeout != NULL)
+    deadline = hrtimer_now() + timeval2ns(timeout);
+
   r = 0;
 
   for (fd = 0; fd < FD_SETSIZE; fd++) {
@@ -869,7 +1069,6 @@ sys_select(void)
 
     // TODO: writefds
     // TODO: errorfds
-    // TODO: timeout
 
     if ((readfds == NULL) || !FD_ISSET(fd, readfds))
       continue;
@@ -879,7 +1078,17 @@ sys_select(void)
       break;
     }
 
-    r += connection_select(file, timeout);
+    if (r > 0) {
+      // Some descriptor is already ready, only poll the remaining ones
+      remaining.tv_sec  = 0;
+      remaining.tv_usec = 0;
+    } else if (timeout != NULL) {
+      // All descriptors share the same deadline
+      uint64_t now = hrtimer_now();
+      ns2timeval(deadline > now ? deadline - now : 0, &remaining);
+    }
+
+    r += connection_select(file, (r > 0 || timeout != NULL) ? &remaining : NULL);
 
     connection_unref(file);
   }
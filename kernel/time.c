@@ -5,11 +5,12 @@
 #include <kernel/core/semaphore.h>
 #include <kernel/core/tick.h>
 #include <kernel/core/timer.h>
+#include <kernel/hrtimer.h>
 #include <kernel/process.h>
 #include <kernel/console.h>
 #include <kernel/time.h>
 
-static k_tick_t ticks_to_sync = 0;
+static k_tick_t next_sync_ticks = 0;
 
 #define TICKS_SYNC_PERIOD   TICKS_PER_SECOND
 
@@ -19,9 +20,11 @@ time_init(void)
   arch_time_init();
 
   if (k_cpu_id() == 0) {
+    hrtimer_init();
+
     k_tick_set(seconds2ticks(arch_get_time_seconds()));
     k_tick();
-    ticks_to_sync = TICKS_SYNC_PERIOD;
+    next_sync_ticks = k_tick_get() + TICKS_SYNC_PERIOD;
   }
 }
 
@@ -34,18 +37,23 @@ time_get_seconds(void)
 void
 time_tick(void)
 {
+  k_tick_t current_ticks;
+
   k_tick();
 
-  ticks_to_sync--;
+  if (k_cpu_id() != K_CPU_ID_MASTER)
+    return;
+
+  // Idle CPUs may skip ticks, so compare against the tick counter itself
+  current_ticks = k_tick_get();
 
-  if (ticks_to_sync == 0) {
+  if (current_ticks >= next_sync_ticks) {
     k_tick_t expected_ticks = seconds2ticks(arch_get_time_seconds());
-    k_tick_t current_ticks = k_tick_get();
 
     if (current_ticks != expected_ticks)
       k_tick_set(expected_ticks);
 
-    ticks_to_sync = TICKS_SYNC_PERIOD;
+    next_sync_ticks = expected_ticks + TICKS_SYNC_PERIOD;
   }
 }
 
@@ -63,36 +71,47 @@ time_get(clockid_t clock_id, struct timespec *tp)
   return 0;
 }
 
+static void
+time_nanosleep_wakeup(void *arg)
+{
+  k_semaphore_put((struct KSemaphore *) arg);
+}
+
 int
 time_nanosleep(struct timespec *rqtp, struct timespec *rmtp)
 {
-  k_tick_t req_ticks, elapsed_ticks;
+  uint64_t req_ns, remaining_ns;
   int r;
 
   if ((rqtp->tv_nsec < 0) || (rqtp->tv_nsec >= 1000000000L))
     return -EINVAL;
 
-  req_ticks = timespec2ticks(rqtp);
+  req_ns = timespec2ns(rqtp);
   
-  if (req_ticks == 0) {
-    elapsed_ticks = 0;
+  if (req_ns == 0) {
+    remaining_ns = 0;
     r = 0;
   } else {
-    k_tick_t start_ticks = k_tick_get();
     struct KSemaphore sem;
+    struct HRTimer timer;
 
     k_semaphore_create(&sem, 0);
-    r = k_semaphore_timed_get(&sem, req_ticks, 0);
 
-    elapsed_ticks = MIN(k_tick_get() - start_ticks, req_ticks);
+    hrtimer_create(&timer, time_nanosleep_wakeup, &sem);
+    hrtimer_start(&timer, hrtimer_now() + req_ns, 0);
+
+    r = k_semaphore_timed_get(&sem, 0, 0);
+
+    // Non-zero only if the sleep has been interrupted
+    remaining_ns = hrtimer_stop(&timer);
 
     k_semaphore_destroy(&sem);
   }
 
   if (rmtp != NULL)
-    ticks2timespec(elapsed_ticks, rmtp);
+    ns2timespec(remaining_ns, rmtp);
 
-  return r == -ETIMEDOUT ? 0 : r;
+  return r;
 }
 
 int
@@ -101,9 +120,7 @@ timer_irq(int, void *)
   struct Process *my_process = process_current();
 
   if (my_process != NULL) {
-    k_assert(my_process->thread != NULL);
-
-    if (arch_trap_is_user(my_process->thread->tf)) {
+    if (arch_trap_is_user(thread_current()->tf)) {
       process_update_times(my_process, 1, 0);
     } else {
       process_update_times(my_process, 0, 1);
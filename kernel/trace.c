@@ -0,0 +1,227 @@
+#include <errno.h>
+
+#include <kernel/core/assert.h>
+#include <kernel/core/cpu.h>
+#include <kernel/core/irq.h>
+#include <kernel/core/mutex.h>
+#include <kernel/dev.h>
+#include <kernel/hrtimer.h>
+#include <kernel/ipc.h>
+#include <kernel/process.h>
+#include <kernel/trace.h>
+
+// Number of records in each per-CPU buffer (must be a power of two)
+#define TRACE_BUFFER_SIZE   1024
+
+// Number of records copied to the reader at once
+#define TRACE_READ_BATCH    16
+
+#define TRACE_DEV_MAJOR     0x04
+
+// Single-producer single-consumer ring buffer. Only the owning CPU advances
+// head (with interrupts disabled), only the reader advances tail.
+struct TraceBuffer {
+  struct TraceRecord records[TRACE_BUFFER_SIZE];
+  unsigned           head;
+  unsigned           tail;
+  unsigned long      dropped;
+};
+
+static struct TraceBuffer trace_buffers[K_CPU_MAX];
+
+// Serializes the readers
+static struct KMutex trace_read_mutex;
+
+volatile unsigned long trace_events;
+
+static int     trace_dev_open(struct Request *, dev_t, int, mode_t);
+static ssize_t trace_dev_read(struct Request *, dev_t, size_t);
+static ssize_t trace_dev_write(struct Request *, dev_t, size_t);
+static int     trace_dev_ioctl(struct Request *, dev_t, int, int);
+static int     trace_dev_select(struct Request *, dev_t, struct timeval *);
+
+static struct CharDev trace_device = {
+  .open   = trace_dev_open,
+  .read   = trace_dev_read,
+  .write  = trace_dev_write,
+  .ioctl  = trace_dev_ioctl,
+  .select = trace_dev_select,
+};
+
+/**
+ * Initialize the tracing subsystem and register the /dev/trace device.
+ */
+void
+trace_init(void)
+{
+  k_mutex_init(&trace_read_mutex, "trace");
+  dev_register_char(TRACE_DEV_MAJOR, &trace_device);
+}
+
+/**
+ * Append a record to the trace buffer of the current CPU. If the buffer is
+ * full, the record is dropped.
+ *
+ * Use the TRACE() and TRACE_TASK() macros instead of calling this function
+ * directly.
+ *
+ * @param task  The task the event belongs to (may be NULL).
+ * @param event The event type.
+ * @param arg0  The first event-specific argument.
+ * @param arg1  The second event-specific argument.
+ */
+void
+trace_record(struct KTask *task, int event, uintptr_t arg0, uintptr_t arg1)
+{
+  struct TraceBuffer *tb;
+  struct TraceRecord *record;
+  struct Thread *thread;
+  unsigned cpu, head;
+
+  k_irq_state_save();
+
+  cpu  = k_cpu_id();
+  tb   = &trace_buffers[cpu];
+  head = tb->head;
+
+  if (head - __atomic_load_n(&tb->tail, __ATOMIC_ACQUIRE) >= TRACE_BUFFER_SIZE) {
+    tb->dropped++;
+    k_irq_state_restore();
+    return;
+  }
+
+  record = &tb->records[head & (TRACE_BUFFER_SIZE - 1)];
+
+  thread = task != NULL ? (struct Thread *) task->ext : NULL;
+
+  record->time   = hrtimer_now();
+  record->event  = event;
+  record->cpu    = cpu;
+  record->pid    = (thread != NULL) && (thread->process != NULL)
+                 ? thread->process->pid
+                 : 0;
+  record->task   = (uintptr_t) task;
+  record->arg[0] = arg0;
+  record->arg[1] = arg1;
+
+  // Publish the record to the reader
+  __atomic_store_n(&tb->head, head + 1, __ATOMIC_RELEASE);
+
+  k_irq_state_restore();
+}
+
+// Copy up to max records from the buffer of the given CPU, leaving them in the
+// buffer until trace_consume() is called
+static int
+trace_peek(int cpu, struct TraceRecord *records, int max)
+{
+  struct TraceBuffer *tb = &trace_buffers[cpu];
+  unsigned head, tail;
+  int n = 0;
+
+  k_assert(k_mutex_holding(&trace_read_mutex));
+
+  head = __atomic_load_n(&tb->head, __ATOMIC_ACQUIRE);
+  tail = tb->tail;
+
+  while ((tail != head) && (n < max))
+    records[n++] = tb->records[tail++ & (TRACE_BUFFER_SIZE - 1)];
+
+  return n;
+}
+
+// Remove n records delivered to the reader from the buffer of the given CPU
+static void
+trace_consume(int cpu, int n)
+{
+  struct TraceBuffer *tb = &trace_buffers[cpu];
+
+  k_assert(k_mutex_holding(&trace_read_mutex));
+
+  // Let the producer reuse the slots
+  __atomic_store_n(&tb->tail, tb->tail + n, __ATOMIC_RELEASE);
+}
+
+static int
+trace_dev_open(struct Request *, dev_t, int, mode_t)
+{
+  return 0;
+}
+
+// Drain the buffers of all CPUs. Does not block if there are no records.
+static ssize_t
+trace_dev_read(struct Request *req, dev_t, size_t nbytes)
+{
+  struct TraceRecord records[TRACE_READ_BATCH];
+  size_t max, total = 0;
+  int cpu, n;
+  ssize_t r;
+
+  k_mutex_lock(&trace_read_mutex);
+
+  for (cpu = 0; cpu < K_CPU_MAX; cpu++) {
+    while ((max = (nbytes - total) / sizeof(records[0])) > 0) {
+      if (max > TRACE_READ_BATCH)
+        max = TRACE_READ_BATCH;
+
+      if ((n = trace_peek(cpu, records, max)) == 0)
+        break;
+
+      // Records that could not be delivered remain in the buffer
+      if ((r = request_write(req, records, n * sizeof(records[0]))) < 0) {
+        k_mutex_unlock(&trace_read_mutex);
+        return r;
+      }
+
+      trace_consume(cpu, r / sizeof(records[0]));
+
+      total += r;
+
+      // No more space left in the reader's buffer
+      if ((size_t) r < n * sizeof(records[0]))
+        goto out;
+    }
+  }
+
+out:
+  k_mutex_unlock(&trace_read_mutex);
+
+  return total;
+}
+
+static ssize_t
+trace_dev_write(struct Request *, dev_t, size_t)
+{
+  return -EINVAL;
+}
+
+static int
+trace_dev_ioctl(struct Request *, dev_t, int request, int arg)
+{
+  unsigned long dropped;
+  int cpu;
+
+  switch (request) {
+  case TRACE_IOC_ENABLE:
+    __atomic_fetch_or(&trace_events, arg & TRACE_EVENTS_ALL,
+                      __ATOMIC_RELAXED);
+    return 0;
+  case TRACE_IOC_DISABLE:
+    __atomic_fetch_and(&trace_events, ~(unsigned long) arg,
+                       __ATOMIC_RELAXED);
+    return 0;
+  case TRACE_IOC_DROPPED:
+    dropped = 0;
+    for (cpu = 0; cpu < K_CPU_MAX; cpu++)
+      dropped += trace_buffers[cpu].dropped;
+    return dropped;
+  default:
+    return -EINVAL;
+  }
+}
+
+static int
+trace_dev_select(struct Request *, dev_t, struct timeval *)
+{
+  return -ENOSYS;
+}
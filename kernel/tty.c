@@ -15,6 +15,7 @@
 #include <kernel/fs/fs.h>
 #include <kernel/console.h>
 #include <kernel/time.h>
+#include <kernel/hrtimer.h>
 #include <kernel/dev.h>
 #include <kernel/signal.h>
 #include <kernel/core/condvar.h>
@@ -498,26 +499,26 @@ int
 tty_select(struct Request *req, dev_t dev, struct timeval *timeout)
 {
   struct Tty *tty = tty_from_dev(req->process, dev);
+  uint64_t deadline = 0;
   int r;
 
   if (tty == NULL)
     return -ENODEV;
 
+  if (timeout != NULL)
+    deadline = hrtimer_now() + timeval2ns(timeout);
+
   k_mutex_lock(&tty->in.mutex);
 
   while ((r = tty_try_select(req->process, tty)) == 0) {
-    unsigned long t = 0;
-
-    if (timeout != NULL) {
-      t = timeval2ticks(timeout);
-      k_mutex_unlock(&tty->in.mutex);
-      return 0;
-    }
+    if (timeout != NULL)
+      r = hrtimer_condvar_timed_wait(&tty->in.cond, &tty->in.mutex, deadline);
+    else
+      r = k_condvar_timed_wait(&tty->in.cond, &tty->in.mutex, 0, 0);
 
-    // FIXME: use timer to wakeup process
-    if ((r = k_condvar_timed_wait(&tty->in.cond, &tty->in.mutex, t, 0)) < 0) {
+    if (r < 0) {
       k_mutex_unlock(&tty->in.mutex);
-      return r;
+      return r == -ETIMEDOUT ? 0 : r;
     }
   }
 
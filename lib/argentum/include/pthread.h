@@ -0,0 +1,40 @@
+#ifndef _PTHREAD_H
+#define _PTHREAD_H
+
+#include <sys/cdefs.h>
+#include <sys/types.h>
+
+__BEGIN_DECLS
+
+// The types are provided by <sys/types.h>
+
+#define PTHREAD_MUTEX_INITIALIZER   _PTHREAD_MUTEX_INITIALIZER
+#define PTHREAD_COND_INITIALIZER    _PTHREAD_COND_INITIALIZER
+
+int       pthread_attr_init(pthread_attr_t *);
+int       pthread_attr_destroy(pthread_attr_t *);
+int       pthread_attr_getstacksize(const pthread_attr_t *, size_t *);
+int       pthread_attr_setstacksize(pthread_attr_t *, size_t);
+
+int       pthread_create(pthread_t *, const pthread_attr_t *,
+                         void *(*)(void *), void *);
+int       pthread_join(pthread_t, void **);
+void      pthread_exit(void *) __attribute__((__noreturn__));
+pthread_t pthread_self(void);
+int       pthread_equal(pthread_t, pthread_t);
+
+int       pthread_mutex_init(pthread_mutex_t *, const pthread_mutexattr_t *);
+int       pthread_mutex_destroy(pthread_mutex_t *);
+int       pthread_mutex_lock(pthread_mutex_t *);
+int       pthread_mutex_trylock(pthread_mutex_t *);
+int       pthread_mutex_unlock(pthread_mutex_t *);
+
+int       pthread_cond_init(pthread_cond_t *, const pthread_condattr_t *);
+int       pthread_cond_destroy(pthread_cond_t *);
+int       pthread_cond_wait(pthread_cond_t *, pthread_mutex_t *);
+int       pthread_cond_signal(pthread_cond_t *);
+int       pthread_cond_broadcast(pthread_cond_t *);
+
+__END_DECLS
+
+#endif  // !_PTHREAD_H
@@ -0,0 +1,17 @@
+#ifndef _SYS_CLONE_H
+#define _SYS_CLONE_H
+
+#include <sys/cdefs.h>
+#include <sys/types.h>
+
+__BEGIN_DECLS
+
+/** Share the address space, descriptors, working directory and signal actions */
+#define CLONE_THREAD    (1 << 0)
+
+int  clone(int, void (*)(void *), void *, void *, pid_t *);
+void __thread_exit(void) __attribute__((__noreturn__));
+
+__END_DECLS
+
+#endif  // !_SYS_CLONE_H
@@ -0,0 +1,27 @@
+#ifndef _SYS_CPUSET_H
+#define _SYS_CPUSET_H
+
+#include <sys/cdefs.h>
+#include <sys/types.h>
+
+__BEGIN_DECLS
+
+// Set of CPUs a process is allowed to run on
+typedef struct {
+  unsigned long __bits;
+} cpu_set_t;
+
+#define CPU_SETSIZE       (int) (sizeof(unsigned long) * 8)
+
+#define CPU_ZERO(set)     ((set)->__bits = 0)
+#define CPU_SET(cpu, set) ((set)->__bits |= (1UL << (cpu)))
+#define CPU_CLR(cpu, set) ((set)->__bits &= ~(1UL << (cpu)))
+#define CPU_ISSET(cpu, set) (((set)->__bits & (1UL << (cpu))) != 0)
+#define CPU_COUNT(set)    __builtin_popcountl((set)->__bits)
+
+int sched_setaffinity(pid_t, size_t, const cpu_set_t *);
+int sched_getaffinity(pid_t, size_t, cpu_set_t *);
+
+__END_DECLS
+
+#endif  // !_SYS_CPUSET_H
@@ -0,0 +1,22 @@
+#ifndef _SYS_FUTEX_H
+#define _SYS_FUTEX_H
+
+#include <sys/cdefs.h>
+#include <sys/types.h>
+
+__BEGIN_DECLS
+
+struct timespec;
+
+/** Sleep if the futex contains the given value */
+#define FUTEX_WAIT      0
+/** Wake up to the given number of tasks */
+#define FUTEX_WAKE      1
+/** Wake up some tasks and move up to val2 others to the futex at uaddr2 */
+#define FUTEX_REQUEUE   3
+
+int futex(int *, int, int, const struct timespec *, int *, int);
+
+__END_DECLS
+
+#endif  // !_SYS_FUTEX_H
@@ -67,6 +67,14 @@
 #define __SYS_SYMLINK       71
 #define __SYS_IPC_SEND      72
 #define __SYS_IPC_SENDV     73
+#define __SYS_SCHED_SETSCHEDULER  74
+#define __SYS_SCHED_GETPARAM      75
+#define __SYS_NICE          76
+#define __SYS_SCHED_SETAFFINITY   77
+#define __SYS_SCHED_GETAFFINITY   78
+#define __SYS_FUTEX         79
+#define __SYS_CLONE         80
+#define __SYS_THREAD_EXIT   81
 
 #ifndef __ASSEMBLER__
 
@@ -0,0 +1,45 @@
+#ifndef _SYS_TRACE_H
+#define _SYS_TRACE_H
+
+#include <stdint.h>
+
+/*
+ * Kernel tracepoints.
+ *
+ * Trace records are read from the /dev/trace device as an array of
+ * struct TraceRecord. Records from each CPU are in chronological order, but
+ * records from different CPUs are interleaved and must be sorted by time.
+ */
+
+enum {
+  TRACE_SCHED_SWITCH_IN,    // A task starts running
+  TRACE_SCHED_SWITCH_OUT,   // A task stops running; arg0: new task state
+  TRACE_IRQ_ENTER,          // arg0: IRQ number
+  TRACE_IRQ_EXIT,           // arg0: IRQ number
+  TRACE_IPC_SEND_BEGIN,     // arg0: request ID, arg1: endpoint
+  TRACE_IPC_SEND_END,       // arg0: request ID, arg1: result
+  TRACE_IPC_RECEIVE,        // arg0: request ID, arg1: endpoint
+  TRACE_IPC_REPLY,          // arg0: request ID, arg1: result
+  TRACE_BUF_REQUEST_BEGIN,  // arg0: block number, arg1: request type
+  TRACE_BUF_REQUEST_END,    // arg0: block number, arg1: request type
+  TRACE_PAGE_ALLOC,         // arg0: allocation order
+  TRACE_EVENT_MAX
+};
+
+#define TRACE_EVENTS_ALL  ((1UL << TRACE_EVENT_MAX) - 1)
+
+struct TraceRecord {
+  uint64_t time;            // Monotonic time, in nanoseconds
+  uint16_t event;           // Event type
+  uint16_t cpu;             // CPU that recorded the event
+  int32_t  pid;             // Process ID (0 for kernel tasks)
+  uint32_t task;            // Kernel task ID
+  uint32_t arg[2];          // Event-specific arguments
+};
+
+// ioctl() requests for /dev/trace
+#define TRACE_IOC_ENABLE    (('T' << 8) | 1)  // Enable events given by a mask
+#define TRACE_IOC_DISABLE   (('T' << 8) | 2)  // Disable events given by a mask
+#define TRACE_IOC_DROPPED   (('T' << 8) | 3)  // Get the number of lost records
+
+#endif  // !_SYS_TRACE_H
@@ -0,0 +1,196 @@
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <sys/clone.h>
+#include <sys/futex.h>
+#include <sys/mman.h>
+
+#define PTHREAD_STACK_DEFAULT   (64 * 1024)
+
+struct pthread {
+  struct pthread  *next;
+  void          *(*start)(void *);
+  void            *arg;
+  void            *result;
+  void            *stack;
+  size_t           stack_size;
+  // Set by the kernel before the thread starts, cleared when it exits
+  volatile pid_t   tid;
+};
+
+// Descriptor of the initial thread of the process
+static struct pthread main_thread;
+
+// Threads started by pthread_create()
+static struct pthread *threads;
+static pthread_mutex_t threads_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void
+pthread_unlink(struct pthread *thread)
+{
+  struct pthread **tp;
+
+  pthread_mutex_lock(&threads_lock);
+
+  for (tp = &threads; *tp != NULL; tp = &(*tp)->next) {
+    if (*tp == thread) {
+      *tp = thread->next;
+      break;
+    }
+  }
+
+  pthread_mutex_unlock(&threads_lock);
+}
+
+// There is no thread-local storage, so look up the descriptor by the stack
+// the calling thread is running on
+static struct pthread *
+pthread_find_self(void)
+{
+  struct pthread *thread;
+  char here;
+
+  pthread_mutex_lock(&threads_lock);
+
+  for (thread = threads; thread != NULL; thread = thread->next)
+    if ((&here >= (char *) thread->stack) &&
+        (&here < (char *) thread->stack + thread->stack_size))
+      break;
+
+  pthread_mutex_unlock(&threads_lock);
+
+  return thread != NULL ? thread : &main_thread;
+}
+
+static void
+pthread_start(void *arg)
+{
+  struct pthread *thread = (struct pthread *) arg;
+
+  pthread_exit(thread->start(thread->arg));
+}
+
+int
+pthread_attr_init(pthread_attr_t *attr)
+{
+  attr->is_initialized = 1;
+  attr->stacksize      = PTHREAD_STACK_DEFAULT;
+  return 0;
+}
+
+int
+pthread_attr_destroy(pthread_attr_t *attr)
+{
+  attr->is_initialized = 0;
+  return 0;
+}
+
+int
+pthread_attr_getstacksize(const pthread_attr_t *attr, size_t *size)
+{
+  *size = attr->stacksize;
+  return 0;
+}
+
+int
+pthread_attr_setstacksize(pthread_attr_t *attr, size_t size)
+{
+  if (size == 0)
+    return EINVAL;
+
+  attr->stacksize = size;
+  return 0;
+}
+
+int
+pthread_create(pthread_t *tp, const pthread_attr_t *attr,
+               void *(*start)(void *), void *arg)
+{
+  struct pthread *thread;
+  size_t stack_size;
+  int r;
+
+  stack_size = (attr != NULL) && attr->is_initialized
+             ? (size_t) attr->stacksize
+             : PTHREAD_STACK_DEFAULT;
+
+  if ((thread = (struct pthread *) malloc(sizeof(*thread))) == NULL)
+    return EAGAIN;
+
+  thread->stack = mmap(NULL, stack_size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (thread->stack == MAP_FAILED) {
+    free(thread);
+    return EAGAIN;
+  }
+
+  thread->stack_size = stack_size;
+  thread->start      = start;
+  thread->arg        = arg;
+  thread->result     = NULL;
+  thread->tid        = 0;
+
+  pthread_mutex_lock(&threads_lock);
+  thread->next = threads;
+  threads = thread;
+  pthread_mutex_unlock(&threads_lock);
+
+  if (clone(CLONE_THREAD, pthread_start, thread,
+            (char *) thread->stack + stack_size, (pid_t *) &thread->tid) < 0) {
+    r = errno;
+
+    pthread_unlink(thread);
+    munmap(thread->stack, stack_size);
+    free(thread);
+
+    return r;
+  }
+
+  *tp = (pthread_t) thread;
+
+  return 0;
+}
+
+int
+pthread_join(pthread_t t, void **result)
+{
+  struct pthread *thread = (struct pthread *) t;
+  pid_t tid;
+
+  if (thread == pthread_find_self())
+    return EDEADLK;
+  if (thread == &main_thread)
+    return EINVAL;
+
+  // The kernel clears the thread ID and wakes us up when the thread exits
+  while ((tid = thread->tid) != 0)
+    futex((int *) &thread->tid, FUTEX_WAIT, tid, NULL, NULL, 0);
+
+  if (result != NULL)
+    *result = thread->result;
+
+  pthread_unlink(thread);
+  munmap(thread->stack, thread->stack_size);
+  free(thread);
+
+  return 0;
+}
+
+void
+pthread_exit(void *result)
+{
+  pthread_find_self()->result = result;
+  __thread_exit();
+}
+
+pthread_t
+pthread_self(void)
+{
+  return (pthread_t) pthread_find_self();
+}
+
+int
+pthread_equal(pthread_t t1, pthread_t t2)
+{
+  return t1 == t2;
+}
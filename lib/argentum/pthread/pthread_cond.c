@@ -0,0 +1,51 @@
+#include <limits.h>
+#include <pthread.h>
+#include <sys/futex.h>
+
+// The condition variable is a sequence counter incremented on each
+// notification, so a waiter does not sleep if it missed one after unlocking
+// the mutex
+
+int
+pthread_cond_init(pthread_cond_t *cond, const pthread_condattr_t *attr)
+{
+  (void) attr;
+
+  *cond = 0;
+  return 0;
+}
+
+int
+pthread_cond_destroy(pthread_cond_t *cond)
+{
+  (void) cond;
+  return 0;
+}
+
+int
+pthread_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex)
+{
+  int seq = (int) __atomic_load_n(cond, __ATOMIC_RELAXED);
+
+  pthread_mutex_unlock(mutex);
+  futex((int *) cond, FUTEX_WAIT, seq, NULL, NULL, 0);
+  pthread_mutex_lock(mutex);
+
+  return 0;
+}
+
+int
+pthread_cond_signal(pthread_cond_t *cond)
+{
+  __atomic_fetch_add(cond, 1, __ATOMIC_SEQ_CST);
+  futex((int *) cond, FUTEX_WAKE, 1, NULL, NULL, 0);
+  return 0;
+}
+
+int
+pthread_cond_broadcast(pthread_cond_t *cond)
+{
+  __atomic_fetch_add(cond, 1, __ATOMIC_SEQ_CST);
+  futex((int *) cond, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+  return 0;
+}
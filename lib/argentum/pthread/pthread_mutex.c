@@ -0,0 +1,85 @@
+#include <errno.h>
+#include <pthread.h>
+#include <sys/futex.h>
+
+// Mutex states
+#define MUTEX_UNLOCKED    0
+#define MUTEX_LOCKED      1
+#define MUTEX_CONTENDED   2   // Locked, and other threads may be waiting
+
+// Statically initialized mutexes hold a special value
+static void
+mutex_init_static(pthread_mutex_t *mutex)
+{
+  pthread_mutex_t expected = _PTHREAD_MUTEX_INITIALIZER;
+
+  if (*mutex == expected)
+    __atomic_compare_exchange_n(mutex, &expected, MUTEX_UNLOCKED, 0,
+                                __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
+int
+pthread_mutex_init(pthread_mutex_t *mutex, const pthread_mutexattr_t *attr)
+{
+  (void) attr;
+
+  *mutex = MUTEX_UNLOCKED;
+  return 0;
+}
+
+int
+pthread_mutex_destroy(pthread_mutex_t *mutex)
+{
+  if ((*mutex != MUTEX_UNLOCKED) && (*mutex != _PTHREAD_MUTEX_INITIALIZER))
+    return EBUSY;
+  return 0;
+}
+
+int
+pthread_mutex_trylock(pthread_mutex_t *mutex)
+{
+  pthread_mutex_t state = MUTEX_UNLOCKED;
+
+  mutex_init_static(mutex);
+
+  if (!__atomic_compare_exchange_n(mutex, &state, MUTEX_LOCKED, 0,
+                                   __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+    return EBUSY;
+
+  return 0;
+}
+
+int
+pthread_mutex_lock(pthread_mutex_t *mutex)
+{
+  pthread_mutex_t state = MUTEX_UNLOCKED;
+
+  mutex_init_static(mutex);
+
+  // Fast path: no system calls if the mutex is free
+  if (__atomic_compare_exchange_n(mutex, &state, MUTEX_LOCKED, 0,
+                                  __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+    return 0;
+
+  // Mark the mutex as contended, so the owner wakes us up on unlock
+  if (state != MUTEX_CONTENDED)
+    state = __atomic_exchange_n(mutex, MUTEX_CONTENDED, __ATOMIC_ACQUIRE);
+
+  while (state != MUTEX_UNLOCKED) {
+    futex((int *) mutex, FUTEX_WAIT, MUTEX_CONTENDED, NULL, NULL, 0);
+    state = __atomic_exchange_n(mutex, MUTEX_CONTENDED, __ATOMIC_ACQUIRE);
+  }
+
+  return 0;
+}
+
+int
+pthread_mutex_unlock(pthread_mutex_t *mutex)
+{
+  if (__atomic_fetch_sub(mutex, 1, __ATOMIC_RELEASE) != MUTEX_LOCKED) {
+    __atomic_store_n(mutex, MUTEX_UNLOCKED, __ATOMIC_RELEASE);
+    futex((int *) mutex, FUTEX_WAKE, 1, NULL, NULL, 0);
+  }
+
+  return 0;
+}
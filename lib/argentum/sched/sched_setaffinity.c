@@ -0,0 +1,8 @@
+#include <sys/cpuset.h>
+#include <sys/syscall.h>
+
+int
+sched_setaffinity(pid_t pid, size_t size, const cpu_set_t *set)
+{
+  return __syscall3(__SYS_SCHED_SETAFFINITY, pid, size, set);
+}
@@ -0,0 +1,8 @@
+#include <sched.h>
+#include <sys/syscall.h>
+
+int
+sched_setscheduler(pid_t pid, int policy, const struct sched_param *param)
+{
+  return __syscall3(__SYS_SCHED_SETSCHEDULER, pid, policy, param);
+}
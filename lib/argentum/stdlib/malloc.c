@@ -579,6 +579,11 @@ MAX_RELEASE_CHECK_RATE   default: 4095 unless not HAVE_MMAP
 #if defined(__ARGENTUM__)
 #define HAVE_MORECORE 0
 #define HAVE_MMAP 1
+/* Processes may have multiple threads, use the futex-based pthread mutexes
+   (see the user-defined locks below) so that contending threads sleep */
+#define USE_LOCKS 2
+#define USE_SPIN_LOCKS 0
+#define LACKS_SCHED_H
 #endif  /* __ARGENTUM__ */
 
 #if defined(DARWIN) || defined(_DARWIN)
@@ -1833,6 +1838,17 @@ static FORCEINLINE int win32munmap(void* ptr, size_t size) {
 /* #define TRY_LOCK(lk) ... */
 /* static MLOCK_T malloc_global_mutex = ... */
 
+#if defined(__ARGENTUM__)
+#define MLOCK_T               pthread_mutex_t
+#define ACQUIRE_LOCK(lk)      pthread_mutex_lock(lk)
+#define RELEASE_LOCK(lk)      pthread_mutex_unlock(lk)
+#define TRY_LOCK(lk)          (!pthread_mutex_trylock(lk))
+#define INITIAL_LOCK(lk)      pthread_mutex_init(lk, NULL)
+#define DESTROY_LOCK(lk)      pthread_mutex_destroy(lk)
+
+static MLOCK_T malloc_global_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif  /* __ARGENTUM__ */
+
 #elif USE_SPIN_LOCKS
 
 /* First, define CAS_LOCK and CLEAR_LOCK on ints */
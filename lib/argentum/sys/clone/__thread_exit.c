@@ -0,0 +1,12 @@
+#include <sys/clone.h>
+#include <sys/syscall.h>
+
+void
+__thread_exit(void)
+{
+  __syscall0(__SYS_THREAD_EXIT);
+
+  // Not reached
+  for (;;)
+    ;
+}
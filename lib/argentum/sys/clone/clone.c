@@ -0,0 +1,13 @@
+#include <sys/clone.h>
+#include <sys/syscall.h>
+
+/*
+ * Start a new thread executing fn(arg) on the given stack. The thread ID is
+ * stored at ctid before the thread starts, and cleared when it exits.
+ * The fn function must not return, but call __thread_exit() instead.
+ */
+int
+clone(int flags, void (*fn)(void *), void *arg, void *stack, pid_t *ctid)
+{
+  return __syscall5(__SYS_CLONE, flags, fn, arg, stack, ctid);
+}
@@ -0,0 +1,14 @@
+#include <sys/futex.h>
+#include <sys/syscall.h>
+
+int
+futex(int *uaddr, int op, int val, const struct timespec *timeout,
+      int *uaddr2, int val2)
+{
+  // Only five arguments can be passed on all architectures, so val2 goes into
+  // the timeout slot, which FUTEX_REQUEUE does not use
+  if (op == FUTEX_REQUEUE)
+    return __syscall5(__SYS_FUTEX, uaddr, op, val, (intptr_t) val2, uaddr2);
+
+  return __syscall5(__SYS_FUTEX, uaddr, op, val, timeout, uaddr2);
+}
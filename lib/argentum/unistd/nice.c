@@ -0,0 +1,16 @@
+#include <limits.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+int
+nice(int incr)
+{
+  int r;
+
+  // The kernel returns the new nice value offset by NZERO, so that it is never
+  // negative
+  if ((r = __syscall1(__SYS_NICE, incr)) < 0)
+    return -1;
+
+  return r - NZERO;
+}
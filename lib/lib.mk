@@ -25,7 +25,10 @@ LIB_SRCFILES := \
 	lib/argentum/include/netinet/in_systm.h \
 	lib/argentum/include/netinet/in.h \
 	lib/argentum/include/netinet/ip.h \
+	lib/argentum/include/sys/clone.h \
+	lib/argentum/include/sys/cpuset.h \
 	lib/argentum/include/sys/dirent.h \
+	lib/argentum/include/sys/futex.h \
 	lib/argentum/include/sys/ioctl.h \
 	lib/argentum/include/sys/ipc.h \
 	lib/argentum/include/sys/mman.h \
@@ -35,6 +38,7 @@ LIB_SRCFILES := \
 	lib/argentum/include/sys/socket.h \
 	lib/argentum/include/sys/syscall.h \
 	lib/argentum/include/sys/termios.h \
+	lib/argentum/include/sys/trace.h \
 	lib/argentum/include/sys/uio.h \
 	lib/argentum/include/sys/un.h \
 	lib/argentum/include/sys/utime.h \
@@ -45,6 +49,7 @@ LIB_SRCFILES := \
 	lib/argentum/include/mntent.h \
 	lib/argentum/include/netdb.h \
 	lib/argentum/include/poll.h \
+	lib/argentum/include/pthread.h \
 	lib/argentum/include/ucontext.h \
 	lib/argentum/machine/arm/sigstub.S \
 	lib/argentum/mntent/getmntent.c \
@@ -56,6 +61,15 @@ LIB_SRCFILES := \
 	lib/argentum/netdb/netdb.c \
 	lib/argentum/netdb/setservent.c \
 	lib/argentum/poll/poll.c \
+	lib/argentum/pthread/pthread.c \
+	lib/argentum/pthread/pthread_cond.c \
+	lib/argentum/pthread/pthread_mutex.c \
+	lib/argentum/sched/sched_get_priority_max.c \
+	lib/argentum/sched/sched_get_priority_min.c \
+	lib/argentum/sched/sched_getaffinity.c \
+	lib/argentum/sched/sched_getparam.c \
+	lib/argentum/sched/sched_setaffinity.c \
+	lib/argentum/sched/sched_setscheduler.c \
 	lib/argentum/signal/kill.c \
 	lib/argentum/signal/killpg.c \
 	lib/argentum/signal/sigaction.c \
@@ -74,6 +88,9 @@ LIB_SRCFILES := \
 	lib/argentum/stdlib/reallocr.c \
 	lib/argentum/stdlib/realpath.c \
 	lib/argentum/stdlib/unlockpt.c \
+	lib/argentum/sys/clone/__thread_exit.c \
+	lib/argentum/sys/clone/clone.c \
+	lib/argentum/sys/futex/futex.c \
 	lib/argentum/sys/ioctl/ioctl.c \
 	lib/argentum/sys/ipc/ipc_send.c \
 	lib/argentum/sys/ipc/ipc_sendv.c \
@@ -157,6 +174,7 @@ LIB_SRCFILES := \
 	lib/argentum/unistd/lchown.c \
 	lib/argentum/unistd/link.c \
 	lib/argentum/unistd/lseek.c \
+	lib/argentum/unistd/nice.c \
 	lib/argentum/unistd/pathconf.c \
 	lib/argentum/unistd/pipe.c \
 	lib/argentum/unistd/read.c \
@@ -0,0 +1,309 @@
+/*
+ * Run a command with kernel tracepoints enabled and write the collected
+ * records in the Chrome trace event format, which can be loaded into
+ * chrome://tracing or https://ui.perfetto.dev.
+ *
+ * Usage: trace [-o file] [-e mask] command [args...]
+ *
+ * Scheduler and interrupt events are shown on per-CPU tracks, while IPC,
+ * buffer cache and page allocation events are shown on per-task tracks.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/trace.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TRACE_DEVICE    "/dev/trace"
+#define RECORDS_MAX     64
+#define TASKS_MAX       256
+
+// Track groups in the output
+#define PID_CPUS        0
+#define PID_TASKS       1
+
+static struct TraceRecord records[RECORDS_MAX];
+
+// Tasks and CPUs that already have a named track
+static uint32_t tasks[TASKS_MAX];
+static int ntasks;
+static unsigned long cpus;
+
+static FILE *out;
+static int first_event = 1;
+
+static void
+event_begin(const char *ph, const char *name, int pid, uint32_t tid,
+            uint64_t time)
+{
+  fprintf(out, "%s\n{\"ph\":\"%s\",\"name\":\"%s\",\"pid\":%d,\"tid\":%lu,"
+               "\"ts\":%llu.%03llu",
+          first_event ? "" : ",", ph, name, pid, (unsigned long) tid,
+          (unsigned long long) (time / 1000),
+          (unsigned long long) (time % 1000));
+  first_event = 0;
+}
+
+static void
+event_end(void)
+{
+  fprintf(out, "}");
+}
+
+static void
+name_track(int pid, uint32_t tid, const char *fmt, unsigned long arg)
+{
+  fprintf(out, "%s\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%d,"
+               "\"tid\":%lu,\"args\":{\"name\":\"",
+          first_event ? "" : ",", pid, (unsigned long) tid);
+  fprintf(out, fmt, arg);
+  fprintf(out, "\"}}");
+  first_event = 0;
+}
+
+static void
+name_task(struct TraceRecord *r)
+{
+  int i;
+
+  for (i = 0; i < ntasks; i++)
+    if (tasks[i] == r->task)
+      return;
+
+  if (ntasks < TASKS_MAX)
+    tasks[ntasks++] = r->task;
+
+  if (r->pid != 0)
+    name_track(PID_TASKS, r->task, "pid %lu", r->pid);
+  else
+    name_track(PID_TASKS, r->task, "kernel task %lx", r->task);
+}
+
+static void
+name_cpu(struct TraceRecord *r)
+{
+  if (cpus & (1UL << r->cpu))
+    return;
+
+  cpus |= 1UL << r->cpu;
+  name_track(PID_CPUS, r->cpu, "CPU %lu", r->cpu);
+}
+
+static void
+write_record(struct TraceRecord *r)
+{
+  char name[32];
+
+  name_cpu(r);
+
+  switch (r->event) {
+  case TRACE_SCHED_SWITCH_IN:
+    if (r->pid != 0)
+      snprintf(name, sizeof(name), "pid %ld", (long) r->pid);
+    else
+      snprintf(name, sizeof(name), "task %lx", (unsigned long) r->task);
+    event_begin("B", name, PID_CPUS, r->cpu, r->time);
+    event_end();
+    break;
+
+  case TRACE_SCHED_SWITCH_OUT:
+    event_begin("E", "", PID_CPUS, r->cpu, r->time);
+    fprintf(out, ",\"args\":{\"state\":%lu}", (unsigned long) r->arg[0]);
+    event_end();
+    break;
+
+  case TRACE_IRQ_ENTER:
+    snprintf(name, sizeof(name), "irq %lu", (unsigned long) r->arg[0]);
+    event_begin("B", name, PID_CPUS, r->cpu, r->time);
+    event_end();
+    break;
+
+  case TRACE_IRQ_EXIT:
+    event_begin("E", "", PID_CPUS, r->cpu, r->time);
+    event_end();
+    break;
+
+  case TRACE_IPC_SEND_BEGIN:
+    name_task(r);
+    event_begin("B", "send", PID_TASKS, r->task, r->time);
+    fprintf(out, ",\"args\":{\"req\":\"%lx\",\"endpoint\":\"%lx\"}",
+            (unsigned long) r->arg[0], (unsigned long) r->arg[1]);
+    event_end();
+
+    // Connect the request to the task that handles it
+    event_begin("s", "ipc", PID_TASKS, r->task, r->time);
+    fprintf(out, ",\"cat\":\"ipc\",\"id\":\"%lx\"", (unsigned long) r->arg[0]);
+    event_end();
+    break;
+
+  case TRACE_IPC_SEND_END:
+    event_begin("E", "", PID_TASKS, r->task, r->time);
+    fprintf(out, ",\"args\":{\"result\":%ld}", (long) (int32_t) r->arg[1]);
+    event_end();
+    break;
+
+  case TRACE_IPC_RECEIVE:
+    name_task(r);
+    event_begin("f", "ipc", PID_TASKS, r->task, r->time);
+    fprintf(out, ",\"cat\":\"ipc\",\"id\":\"%lx\",\"bp\":\"e\"",
+            (unsigned long) r->arg[0]);
+    event_end();
+
+    // The reply may be sent by another task, so use an async event
+    event_begin("b", "request", PID_TASKS, r->task, r->time);
+    fprintf(out, ",\"cat\":\"ipc\",\"id\":\"%lx\"", (unsigned long) r->arg[0]);
+    event_end();
+    break;
+
+  case TRACE_IPC_REPLY:
+    name_task(r);
+    event_begin("e", "request", PID_TASKS, r->task, r->time);
+    fprintf(out, ",\"cat\":\"ipc\",\"id\":\"%lx\",\"args\":{\"result\":%ld}",
+            (unsigned long) r->arg[0], (long) (int32_t) r->arg[1]);
+    event_end();
+    break;
+
+  case TRACE_BUF_REQUEST_BEGIN:
+    name_task(r);
+    event_begin("B", "buf_request", PID_TASKS, r->task, r->time);
+    fprintf(out, ",\"args\":{\"block\":%lu,\"type\":%lu}",
+            (unsigned long) r->arg[0], (unsigned long) r->arg[1]);
+    event_end();
+    break;
+
+  case TRACE_BUF_REQUEST_END:
+    event_begin("E", "", PID_TASKS, r->task, r->time);
+    event_end();
+    break;
+
+  case TRACE_PAGE_ALLOC:
+    name_task(r);
+    event_begin("i", "page_alloc", PID_TASKS, r->task, r->time);
+    fprintf(out, ",\"s\":\"t\",\"args\":{\"order\":%lu}",
+            (unsigned long) r->arg[0]);
+    event_end();
+    break;
+
+  default:
+    break;
+  }
+}
+
+// Read all records currently available in the kernel buffers
+static int
+drain(int fd)
+{
+  ssize_t nread;
+  int i;
+
+  while ((nread = read(fd, records, sizeof(records))) > 0)
+    for (i = 0; i < nread / (ssize_t) sizeof(records[0]); i++)
+      write_record(&records[i]);
+
+  return nread < 0 ? -1 : 0;
+}
+
+static void
+usage(const char *prog)
+{
+  fprintf(stderr, "usage: %s [-o file] [-e mask] command [args...]\n", prog);
+  exit(EXIT_FAILURE);
+}
+
+int
+main(int argc, char **argv)
+{
+  struct timespec delay = { 0, 10000000 };
+  unsigned long mask = TRACE_EVENTS_ALL;
+  const char *path = NULL;
+  int fd, opt, status;
+  pid_t pid;
+
+  while ((opt = getopt(argc, argv, "o:e:")) != -1) {
+    switch (opt) {
+    case 'o':
+      path = optarg;
+      break;
+    case 'e':
+      mask = strtoul(optarg, NULL, 0);
+      break;
+    default:
+      usage(argv[0]);
+    }
+  }
+
+  if (optind >= argc)
+    usage(argv[0]);
+
+  if ((fd = open(TRACE_DEVICE, O_RDONLY)) < 0) {
+    perror(TRACE_DEVICE);
+    exit(EXIT_FAILURE);
+  }
+
+  if (path == NULL) {
+    out = stdout;
+  } else if ((out = fopen(path, "w")) == NULL) {
+    perror(path);
+    exit(EXIT_FAILURE);
+  }
+
+  fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+  fprintf(out, "\n{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":%d,"
+               "\"args\":{\"name\":\"CPUs\"}}", PID_CPUS);
+  fprintf(out, ",\n{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":%d,"
+               "\"args\":{\"name\":\"Tasks\"}}", PID_TASKS);
+  first_event = 0;
+
+  // Discard the records left from a previous run
+  ioctl(fd, TRACE_IOC_DISABLE, TRACE_EVENTS_ALL);
+  while (read(fd, records, sizeof(records)) > 0)
+    ;
+
+  ioctl(fd, TRACE_IOC_ENABLE, mask);
+
+  if ((pid = fork()) < 0) {
+    perror("fork");
+    exit(EXIT_FAILURE);
+  }
+
+  if (pid == 0) {
+    close(fd);
+    execvp(argv[optind], &argv[optind]);
+    perror(argv[optind]);
+    _exit(127);
+  }
+
+  // Keep draining the buffers while the command is running, so that they do
+  // not overflow
+  while (waitpid(pid, &status, WNOHANG) != pid) {
+    if (drain(fd) < 0) {
+      perror(TRACE_DEVICE);
+      waitpid(pid, &status, 0);
+      break;
+    }
+
+    nanosleep(&delay, NULL);
+  }
+
+  ioctl(fd, TRACE_IOC_DISABLE, TRACE_EVENTS_ALL);
+  drain(fd);
+
+  fprintf(out, "\n]}\n");
+
+  if (out != stdout)
+    fclose(out);
+
+  fprintf(stderr, "%s: %d records dropped\n", argv[0],
+          ioctl(fd, TRACE_IOC_DROPPED, 0));
+
+  close(fd);
+
+  return WIFEXITED(status) ? WEXITSTATUS(status) : EXIT_FAILURE;
+}
@@ -22,7 +22,8 @@ USER_SRCFILES += \
 	user/bin/pwd.c \
 	user/bin/rm.c \
 	user/bin/server.c \
-	user/bin/client.c
+	user/bin/client.c \
+	user/bin/trace.c
 
 USER_APPS := $(patsubst user/%.c, $(SYSROOT)/%, $(USER_SRCFILES))
 USER_APPS := $(patsubst user/%.cc, $(SYSROOT)/%, $(USER_APPS))